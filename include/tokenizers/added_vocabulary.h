@@ -3,11 +3,16 @@
 
 #include <unicode/unistr.h>
 
+#include <bitset>
+#include <cstddef>
+#include <functional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "tokenizers/common.h"
 #include "tokenizers/normalizer.h"
 
 using tokenizers::normalizers::NormalizerResult;
@@ -33,15 +38,37 @@ class AddedVocabulary {
  public:
   AddedVocabulary();
   explicit AddedVocabulary(const std::vector<AddedToken> &tokens);
-  bool IsSpecialToken(const std::string &token);
+  bool IsSpecialToken(std::string_view token) const;
+  // False when input has none of the first code units of the added tokens,
+  // so that FindSplits would return it whole and can be skipped.
+  bool MayMatch(const icu::UnicodeString &input) const;
   std::vector<NormalizerResult> FindSplits(const NormalizerResult &input);
+  // The added token that a split of FindSplits holds, without the
+  // whitespace that lstrip and rstrip took along, or null.
+  const AddedToken *FindToken(const icu::UnicodeString &split) const;
+  // The added token with the id, or null.
+  const AddedToken *FindToken(int id) const;
+  // True when an added token contains whitespace or takes the whitespace
+  // after it, so that input split at whitespace can split differently.
+  bool CrossesWhitespace() const { return crosses_whitespace_; }
+  size_t MemoryUsage() const;
+  // Heap bytes of each structure, the special tokens nothing until the
+  // first IsSpecialToken.
+  MemoryUsageMap MemoryUsageByStructure() const;
+  // The number of structures built on first use so far.
+  int BuiltTables() const { return special_tokens_.built(); }
 
  private:
   std::unordered_map<std::string, int> added_tokens_map_;
-  std::unordered_map<int, std::string> added_tokens_map_r_;
-  std::set<std::string> special_tokens_;
+  // Only decoding looks up special tokens.
+  Lazy<std::set<std::string, std::less<>>> special_tokens_;
   std::unordered_map<int, AddedToken> tokens_;
   std::vector<icu::UnicodeString> patterns_;
+  // First code units of the patterns, those below 256 as a set and the
+  // others sorted.
+  std::bitset<256> first_units_;
+  std::vector<char16_t> wide_first_units_;
+  bool crosses_whitespace_ = false;
 };
 
 } // namespace tokenizers
@@ -3,19 +3,74 @@
 
 #include <simdjson.h>
 
+#include <atomic>
 #include <codecvt>
+#include <cstddef>
 #include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace tokenizers {
 
+// Fields of an Encoding to produce when encoding, ids are always produced.
+// Offsets are only tracked through normalization and pre-tokenization when
+// kOffsets is set. kOverflowing keeps the tokens cut by truncation as
+// overflowing encodings. kAllFields is kAll without it, so that only the
+// part of a long input that truncation keeps is encoded.
+enum class EncodeOptions : uint32_t {
+  kIds = 0,
+  kTypeIds = 1 << 0,
+  kTokens = 1 << 1,
+  kOffsets = 1 << 2,
+  kWordIds = 1 << 3,
+  kSpecialTokensMask = 1 << 4,
+  kAttentionMask = 1 << 5,
+  kOverflowing = 1 << 6,
+  kIdsOnly = kTypeIds | kAttentionMask,
+  kAllFields = kTypeIds | kTokens | kOffsets | kWordIds | kSpecialTokensMask |
+               kAttentionMask,
+  kAll = kAllFields | kOverflowing,
+};
+
+inline EncodeOptions operator|(EncodeOptions a, EncodeOptions b) {
+  return static_cast<EncodeOptions>(static_cast<uint32_t>(a) |
+                                    static_cast<uint32_t>(b));
+}
+
+inline bool hasOption(EncodeOptions options, EncodeOptions option) {
+  return (static_cast<uint32_t>(options) & static_cast<uint32_t>(option)) ==
+         static_cast<uint32_t>(option);
+}
+
+// Unit of the offsets of an Encoding into its input. The original offsets
+// of every character are seeded in this unit before normalization, so the
+// pipeline carries them through as is and no conversion pass is needed.
+enum class OffsetType { kUtf16, kUtf8, kCodePoints };
+
+// All vectors of an Encoding, overflowing included, allocate from the
+// memory resource it was constructed with, so a request can be served from
+// a single arena (e.g. a std::pmr::monotonic_buffer_resource) and released
+// at once. A copy allocates from the resource of the original. The fields
+// are std::pmr containers, so callers holding them as std::vector convert.
 class Encoding {
  public:
   Encoding();
+  explicit Encoding(std::pmr::memory_resource* resource);
+  Encoding(const Encoding &other);
+  Encoding(const Encoding &other, std::pmr::memory_resource *resource);
+  Encoding(Encoding &&other) = default;
+  // Assignment keeps the resource of this encoding.
+  Encoding &operator=(const Encoding &other) = default;
+  Encoding &operator=(Encoding &&other) = default;
   Encoding(const std::vector<int> &ids, const std::vector<int> &type_ids,
            const std::vector<std::string> &tokens,
            const std::vector<std::pair<int, int>> &offsets,
@@ -23,14 +78,94 @@ class Encoding {
            const std::vector<int> &special_tokens_mask,
            const std::vector<int> &attention_mask);
 
-  std::vector<int> ids;
-  std::vector<int> type_ids;
-  std::vector<std::string> tokens;
-  std::vector<std::pair<int, int>> offsets;
-  std::vector<std::optional<int>> word_ids;
-  std::vector<int> special_tokens_mask;
-  std::vector<int> attention_mask;
-  std::vector<Encoding> overflowing;
+  // Reserves room for `length` tokens in the fields selected by `options`.
+  void Reserve(int length, EncodeOptions options);
+  // Moves the fields of `other` selected by `options` to the end of this
+  // encoding, fields that `other` did not produce append nothing.
+  void Append(Encoding &&other, EncodeOptions options);
+  // Approximate heap bytes held by the fields, overflowing included.
+  size_t MemoryUsage() const;
+  std::pmr::memory_resource *resource() const {
+    return ids.get_allocator().resource();
+  }
+
+  std::pmr::vector<int> ids;
+  std::pmr::vector<int> type_ids;
+  std::pmr::vector<std::pmr::string> tokens;
+  std::pmr::vector<std::pair<int, int>> offsets;
+  std::pmr::vector<std::optional<int>> word_ids;
+  std::pmr::vector<int> special_tokens_mask;
+  std::pmr::vector<int> attention_mask;
+  std::pmr::vector<Encoding> overflowing;
+};
+
+// Concatenates the encodings into one allocated from `resource`.
+Encoding ConcatEncodings(std::vector<Encoding> encodings, EncodeOptions options,
+                         std::pmr::memory_resource *resource);
+
+// A read-only Encoding in narrow storage, for holding many encodings in
+// memory. Ids take 16 bits when all of them fit, type ids 8 bits, the masks
+// one bit per token and word ids 32 bits with kNoWord outside any word.
+// Tokens share one buffer. Accessors widen values back to the Encoding
+// types, fields the Encoding did not produce are left out of fields().
+class CompactEncoding {
+ public:
+  static constexpr int32_t kNoWord = -1;
+
+  CompactEncoding();
+  explicit CompactEncoding(const Encoding &encoding);
+
+  int size() const { return size_; }
+  EncodeOptions fields() const { return fields_; }
+  bool narrow_ids() const { return wide_ids_.empty(); }
+  int id(int i) const { return narrow_ids() ? narrow_ids_[i] : wide_ids_[i]; }
+  int type_id(int i) const { return type_ids_[i]; }
+  std::string_view token(int i) const;
+  std::pair<int, int> offset(int i) const { return offsets_[i]; }
+  std::optional<int> word_id(int i) const;
+  int special_tokens_mask(int i) const { return bit(special_tokens_mask_, i); }
+  int attention_mask(int i) const { return bit(attention_mask_, i); }
+  const std::vector<CompactEncoding> &overflowing() const {
+    return overflowing_;
+  }
+
+  // Write size() values of a field to `out`, e.g. a tensor row.
+  template <typename T>
+  void CopyIds(T *out) const {
+    for (int i = 0; i < size_; i++) out[i] = id(i);
+  }
+  template <typename T>
+  void CopyTypeIds(T *out) const {
+    for (int i = 0; i < size_; i++) out[i] = type_ids_[i];
+  }
+  template <typename T>
+  void CopyAttentionMask(T *out) const {
+    for (int i = 0; i < size_; i++) out[i] = attention_mask(i);
+  }
+
+  Encoding ToEncoding(std::pmr::memory_resource *resource =
+                          std::pmr::get_default_resource()) const;
+  // Approximate heap bytes held, overflowing included.
+  size_t MemoryUsage() const;
+
+ private:
+  static int bit(const std::vector<uint64_t> &bits, int i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+  }
+
+  int size_ = 0;
+  EncodeOptions fields_ = EncodeOptions::kIds;
+  std::vector<uint16_t> narrow_ids_;
+  std::vector<int32_t> wide_ids_;
+  std::vector<uint8_t> type_ids_;
+  std::string token_data_;
+  // End of each token in token_data_.
+  std::vector<uint32_t> token_ends_;
+  std::vector<std::pair<int32_t, int32_t>> offsets_;
+  std::vector<int32_t> word_ids_;
+  std::vector<uint64_t> special_tokens_mask_;
+  std::vector<uint64_t> attention_mask_;
+  std::vector<CompactEncoding> overflowing_;
 };
 
 class Token {
@@ -44,6 +179,102 @@ class Token {
   bool is_continuing_subword;
 };
 
+// Approximate heap bytes owned by a value, used for memory reporting. Node
+// based containers are charged their value plus two pointers per node.
+template <typename T>
+std::enable_if_t<std::is_arithmetic_v<T>, size_t> HeapUsage(const T &value);
+size_t HeapUsage(const std::string &value);
+template <typename A, typename B>
+size_t HeapUsage(const std::pair<A, B> &value);
+template <typename T>
+size_t HeapUsage(const std::vector<T> &value);
+template <typename T, typename Compare>
+size_t HeapUsage(const std::set<T, Compare> &value);
+template <typename K, typename V>
+size_t HeapUsage(const std::unordered_map<K, V> &value);
+
+template <typename T>
+std::enable_if_t<std::is_arithmetic_v<T>, size_t> HeapUsage(const T &value) {
+  return 0;
+}
+
+inline size_t HeapUsage(const std::string &value) {
+  // Short strings are stored inline, up to the capacity of an empty string.
+  static const size_t kInlineCapacity = std::string().capacity();
+  return value.capacity() > kInlineCapacity ? value.capacity() + 1 : 0;
+}
+
+template <typename A, typename B>
+size_t HeapUsage(const std::pair<A, B> &value) {
+  return HeapUsage(value.first) + HeapUsage(value.second);
+}
+
+template <typename T>
+size_t HeapUsage(const std::vector<T> &value) {
+  size_t usage = value.capacity() * sizeof(T);
+  for (const T &item : value) usage += HeapUsage(item);
+  return usage;
+}
+
+template <typename T, typename Compare>
+size_t HeapUsage(const std::set<T, Compare> &value) {
+  size_t usage = value.size() * (sizeof(T) + 4 * sizeof(void *));
+  for (const T &item : value) usage += HeapUsage(item);
+  return usage;
+}
+
+template <typename K, typename V>
+size_t HeapUsage(const std::unordered_map<K, V> &value) {
+  size_t usage = value.bucket_count() * sizeof(void *) +
+                 value.size() * (sizeof(std::pair<const K, V>) +
+                                 2 * sizeof(void *));
+  for (const auto &[key, item] : value) {
+    usage += HeapUsage(key) + HeapUsage(item);
+  }
+  return usage;
+}
+
+// Approximate heap bytes of each named structure of a component.
+using MemoryUsageMap = std::map<std::string, size_t>;
+
+// An auxiliary structure built by the first Get, once even when several
+// threads call it together, so that callers which never need it do not pay
+// for it. A copy starts out unbuilt.
+template <typename T>
+class Lazy {
+ public:
+  Lazy() = default;
+  Lazy(const Lazy &) {}
+  // Resets the value without taking the mutex, so it must not race with
+  // Get, as when assigning the object that owns it.
+  Lazy &operator=(const Lazy &) {
+    value_ = T();
+    built_.store(false, std::memory_order_relaxed);
+    return *this;
+  }
+
+  // `build` fills in the value the first time.
+  template <typename Build>
+  const T &Get(Build build) const {
+    if (!built_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!built_.load(std::memory_order_relaxed)) {
+        build(&value_);
+        built_.store(true, std::memory_order_release);
+      }
+    }
+    return value_;
+  }
+  bool built() const { return built_.load(std::memory_order_acquire); }
+  // Heap bytes of the value, nothing until it is built.
+  size_t MemoryUsage() const { return built() ? HeapUsage(value_) : 0; }
+
+ private:
+  mutable std::mutex mutex_;
+  mutable T value_;
+  mutable std::atomic<bool> built_{false};
+};
+
 inline std::string get_string_or_default(simdjson::ondemand::value &&val,
                                          std::string_view key,
                                          std::string_view def = "") {
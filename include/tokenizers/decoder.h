@@ -2,6 +2,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tokenizers {
@@ -12,6 +13,10 @@ class Decoder {
  public:
   Decoder();
   virtual std::vector<std::string> DecodeChain(std::vector<std::string> tokens);
+  // Appends the concatenation of what DecodeChain returns for the tokens to
+  // *out. Decoders that override it do so without copying every token.
+  virtual void Decode(const std::vector<std::string_view>& tokens,
+                      std::string* out);
 };
 
 // WordPieceDecoder
@@ -21,12 +26,39 @@ class WordPieceDecoder : public Decoder {
                             bool cleanup = true);
   std::vector<std::string> DecodeChain(
       std::vector<std::string> tokens) override;
+  void Decode(const std::vector<std::string_view>& tokens,
+              std::string* out) override;
 
  private:
   std::string prefix_;
   bool cleanup_;
 };
 
+// Metaspace
+class Metaspace : public Decoder {
+ public:
+  explicit Metaspace(const std::string& replacement = "\u2581",
+                     bool add_prefix_space = true);
+  std::vector<std::string> DecodeChain(
+      std::vector<std::string> tokens) override;
+  void Decode(const std::vector<std::string_view>& tokens,
+              std::string* out) override;
+
+ private:
+  std::string replacement_;
+  bool add_prefix_space_;
+};
+
+// ByteLevel
+class ByteLevel : public Decoder {
+ public:
+  ByteLevel();
+  std::vector<std::string> DecodeChain(
+      std::vector<std::string> tokens) override;
+  void Decode(const std::vector<std::string_view>& tokens,
+              std::string* out) override;
+};
+
 void doCleanup(std::string* input);
 
 } // namespace decoders
@@ -0,0 +1,62 @@
+// Copyright 2025 Omkar Prabhu
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tokenizers {
+
+// A fixed pool of workers, each with its own task deque. A worker takes its
+// own tasks in order and, once it runs dry, steals the last task of the
+// others, so one long task does not leave the rest of the pool idle.
+class WorkStealingExecutor {
+ public:
+  explicit WorkStealingExecutor(int num_threads = 0);
+  ~WorkStealingExecutor();
+  WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+  WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+
+  // Runs all tasks and returns once they have finished, the calling thread
+  // works too. Tasks are dealt round-robin in order, so callers should put
+  // the most expensive first. The first exception thrown is rethrown.
+  //
+  // One run uses the whole pool: Run calls from several threads wait for
+  // each other, so they get no more parallelism than a single call. A task
+  // calling Run on the executor running it runs the new tasks itself, one
+  // after the other.
+  void Run(std::vector<std::function<void()>> tasks);
+  int num_threads() const { return queues_.size(); }
+
+  // Shared executor with one worker per hardware thread.
+  static WorkStealingExecutor &Default();
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+  bool PopOrSteal(int worker, std::function<void()> *task);
+  void Work(int worker);
+  void WorkerLoop(int worker);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  std::mutex run_mutex_;
+  std::mutex state_mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+  std::atomic<int> pending_{0};
+  std::exception_ptr error_;
+};
+
+} // namespace tokenizers
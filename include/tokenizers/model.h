@@ -3,7 +3,12 @@
 
 #include <unicode/unistr.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -21,8 +26,22 @@ class Model {
                                       const std::pair<int, int>& offset);
   virtual std::vector<Token> Tokenize(const icu::UnicodeString& input);
   virtual std::vector<Token> TokenizeString(const std::string& input);
+  // The number of tokens Tokenize produces for the input, without building
+  // them.
+  virtual size_t CountTokens(const icu::UnicodeString& input);
   virtual std::optional<std::string> IdToToken(int id);
+  // Same as IdToToken, viewing the token held by the model.
+  virtual std::optional<std::string_view> IdToTokenView(int id);
   virtual std::optional<int> TokenToId(const std::string& token);
+  virtual std::optional<int> UnkTokenId();
+  // Approximate bytes held by the model, including its vocabulary.
+  virtual size_t MemoryUsage();
+  // Heap bytes of each structure of the model. Those built on first use
+  // report nothing until then.
+  virtual MemoryUsageMap MemoryUsageByStructure();
+  // The number of structures built on first use so far, MemoryUsage only
+  // changes with it.
+  virtual int BuiltTables();
 };
 
 // WordPiece
@@ -36,15 +55,122 @@ class WordPiece : public Model {
                               const std::pair<int, int>& offset) override;
   std::vector<Token> Tokenize(const icu::UnicodeString& input) override;
   std::vector<Token> TokenizeString(const std::string& input) override;
+  size_t CountTokens(const icu::UnicodeString& input) override;
   std::optional<std::string> IdToToken(int id) override;
+  std::optional<std::string_view> IdToTokenView(int id) override;
   std::optional<int> TokenToId(const std::string& token) override;
+  std::optional<int> UnkTokenId() override;
+  size_t MemoryUsage() override;
+  MemoryUsageMap MemoryUsageByStructure() override;
+  int BuiltTables() override;
 
  private:
+  // The end of the longest piece of the vocabulary that starts at `start`,
+  // or -1 when there is none. The piece, with the continuing subword prefix
+  // past the start of the input, is left in *piece and its id in *id.
+  int LongestMatch(const icu::UnicodeString& input, int start,
+                   std::string* piece, int* id) const;
+  // id -> token, built on the first decode.
+  const std::unordered_map<int, std::string>& ReverseVocab() const;
   std::unordered_map<std::string, int> vocab_;
-  std::unordered_map<int, std::string> rvocab_;
+  Lazy<std::unordered_map<int, std::string>> rvocab_;
   std::string unk_token_;
   std::string continuing_subword_prefix_;
   int max_input_chars_per_word_;
+  // UTF-16 length of the longest piece, which bounds the matches tried.
+  int max_piece_length_ = 0;
+};
+
+// BPE
+class BPE : public Model {
+ public:
+  explicit BPE(const std::unordered_map<std::string, int>& vocab,
+               const std::vector<std::pair<std::string, std::string>>& merges,
+               const std::string& unk_token = "",
+               const std::string& continuing_subword_prefix = "",
+               const std::string& end_of_word_suffix = "",
+               bool fuse_unk = false, bool byte_fallback = false,
+               bool ignore_merges = false, int cache_capacity = 10000);
+  std::vector<Token> Tokenize(const icu::UnicodeString& input,
+                              const std::pair<int, int>& offset) override;
+  std::vector<Token> Tokenize(const icu::UnicodeString& input) override;
+  std::vector<Token> TokenizeString(const std::string& input) override;
+  size_t CountTokens(const icu::UnicodeString& input) override;
+  std::optional<std::string> IdToToken(int id) override;
+  std::optional<std::string_view> IdToTokenView(int id) override;
+  std::optional<int> TokenToId(const std::string& token) override;
+  std::optional<int> UnkTokenId() override;
+  size_t MemoryUsage() override;
+  MemoryUsageMap MemoryUsageByStructure() override;
+
+ private:
+  // A symbol of a word being merged, linked to its neighbours by index.
+  // [start, end) are the UTF-16 code units of the word covered by the
+  // symbol.
+  struct Symbol {
+    int id;
+    int prev;
+    int next;
+    int start;
+    int end;
+  };
+  // (id, (start, end)) of a merged symbol.
+  using MergedSymbol = std::pair<int, std::pair<int, int>>;
+  std::vector<MergedSymbol> MergeWord(const icu::UnicodeString& input);
+  std::unordered_map<std::string, int> vocab_;
+  std::unordered_map<int, std::string> rvocab_;
+  // (left id << 32 | right id) -> (rank, merged id)
+  std::unordered_map<uint64_t, std::pair<int, int>> merges_;
+  std::string unk_token_;
+  std::string continuing_subword_prefix_;
+  std::string end_of_word_suffix_;
+  bool fuse_unk_;
+  bool byte_fallback_;
+  bool ignore_merges_;
+  int cache_capacity_;
+  std::unordered_map<std::string, std::vector<MergedSymbol>> cache_;
+  std::shared_mutex cache_mutex_;
+};
+
+// Unigram
+class Unigram : public Model {
+ public:
+  explicit Unigram(const std::vector<std::pair<std::string, double>>& vocab,
+                   int unk_id = -1, bool byte_fallback = false);
+  std::vector<Token> Tokenize(const icu::UnicodeString& input,
+                              const std::pair<int, int>& offset) override;
+  std::vector<Token> Tokenize(const icu::UnicodeString& input) override;
+  std::vector<Token> TokenizeString(const std::string& input) override;
+  std::optional<std::string> IdToToken(int id) override;
+  std::optional<std::string_view> IdToTokenView(int id) override;
+  std::optional<int> TokenToId(const std::string& token) override;
+  std::optional<int> UnkTokenId() override;
+  size_t MemoryUsage() override;
+  MemoryUsageMap MemoryUsageByStructure() override;
+
+ private:
+  // Trie over the UTF-8 bytes of the pieces, flattened so that the edges of
+  // a node are the sorted range [edges_begin, edges_end) of trie_edges_.
+  struct TrieNode {
+    int id;
+    int edges_begin;
+    int edges_end;
+  };
+  struct TrieEdge {
+    unsigned char byte;
+    int child;
+  };
+  void BuildTrie();
+  int FindChild(int node, unsigned char byte) const;
+  // The id of the piece, looked up in the trie, or -1.
+  int FindPiece(std::string_view piece) const;
+  std::vector<std::pair<std::string, double>> vocab_;
+  std::vector<TrieNode> trie_nodes_;
+  std::vector<TrieEdge> trie_edges_;
+  std::vector<int> byte_ids_;
+  int unk_id_;
+  bool byte_fallback_;
+  double unk_score_;
 };
 
 } // namespace models
@@ -1,21 +1,36 @@
 // Copyright 2025 Omkar Prabhu
 #pragma once
 
+#include <unicode/normalizer2.h>
 #include <unicode/uchar.h>
 #include <unicode/unistr.h>
+#include <unicode/utf16.h>
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "tokenizers/common.h"
+#include "tokenizers/unicode.h"
+
 namespace tokenizers {
 
 namespace normalizers {
 
+// offsets holds the offsets in the original input of every code point of
+// normalized, in offset_type units, it is left empty when offsets are not
+// tracked.
 class NormalizerResult {
  public:
   explicit NormalizerResult(const icu::UnicodeString& normalized,
-                            bool pre_normalized = false);
+                            bool pre_normalized = false,
+                            bool track_offsets = true,
+                            OffsetType offset_type = OffsetType::kUtf16);
   NormalizerResult(const icu::UnicodeString& normalized,
                    const std::vector<std::pair<int, int>>& offsets,
                    bool pre_normalized = false);
@@ -50,6 +65,311 @@ class BertNormalizer : public Normalizer {
   bool lowercase_;
 };
 
+// Unicode normalization forms. Only the parts of the input that fail the
+// quick check are normalized, segment by segment between normalization
+// boundaries, and input that is already normalized is returned as is.
+NormalizerResult normalizeUnicode(NormalizerResult input,
+                                  const icu::Normalizer2* normalizer);
+
+// NFC
+class NFC : public Normalizer {
+ public:
+  NFC();
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+ private:
+  const icu::Normalizer2* normalizer_;
+};
+
+// NFD
+class NFD : public Normalizer {
+ public:
+  NFD();
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+ private:
+  const icu::Normalizer2* normalizer_;
+};
+
+// NFKC
+class NFKC : public Normalizer {
+ public:
+  NFKC();
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+ private:
+  const icu::Normalizer2* normalizer_;
+};
+
+// NFKD
+class NFKD : public Normalizer {
+ public:
+  NFKD();
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+ private:
+  const icu::Normalizer2* normalizer_;
+};
+
+// Char-level normalizers map every code point on its own to zero or more code
+// points (Apply) and may emit code points ahead of the input (Begin). This is
+// what lets a chain of them run as a single pass, see FusedNormalizer.
+
+// Runs a char-level pipeline over input in one pass. Output code points take
+// the offsets of the input code point they came from, and the ones emitted
+// by Begin take those of the first input code point.
+template <typename Pipeline>
+NormalizerResult normalizeChars(const NormalizerResult& input,
+                                const Pipeline& pipeline) {
+  if (input.normalized.isEmpty())
+    return input;
+  NormalizerResult result(icu::UnicodeString(), {}, input.pre_normalized);
+  result.normalized = icu::UnicodeString(input.normalized.length(), 0, 0);
+  result.offsets.reserve(input.offsets.size());
+  size_t char_idx = 0;
+  auto emit = [&](UChar32 c) {
+    result.normalized.append(c);
+    if (char_idx < input.offsets.size()) {
+      result.offsets.emplace_back(input.offsets[char_idx]);
+    } else if (!input.offsets.empty()) {
+      result.offsets.emplace_back(input.offsets.back());
+    }
+  };
+  pipeline.Begin(emit);
+  const UChar* buffer = input.normalized.getBuffer();
+  int length = input.normalized.length();
+  for (int pos = 0; pos < length; char_idx++) {
+    UChar32 c;
+    U16_NEXT(buffer, pos, length, c);
+    pipeline.Apply(c, emit);
+  }
+  return result;
+}
+
+// Lowercase applies the full case mapping. Apply maps each code point on
+// its own, which only differs from it for U+0130, lowercased to two code
+// points, and for a final U+03A3, lowercased to U+03C2, so pipelines with a
+// Lowercase step run their steps one by one on input containing either.
+class Lowercase : public Normalizer {
+ public:
+  Lowercase();
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+  static bool NeedsFullMapping(const icu::UnicodeString& input);
+
+  template <typename Emit>
+  void Begin(Emit&& emit) const {}
+  template <typename Emit>
+  void Apply(UChar32 c, Emit&& emit) const {
+    emit(unicode::ToLower(c));
+  }
+};
+
+// StripAccents
+class StripAccents : public Normalizer {
+ public:
+  StripAccents();
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+  template <typename Emit>
+  void Begin(Emit&& emit) const {}
+  template <typename Emit>
+  void Apply(UChar32 c, Emit&& emit) const {
+    if (unicode::CharType(c) != U_NON_SPACING_MARK)
+      emit(c);
+  }
+};
+
+// Replace
+class Replace : public Normalizer {
+ public:
+  Replace(const std::string& pattern, const std::string& content);
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+  // Only a single code point pattern can be replaced char by char.
+  bool IsCharLevel() const { return pattern_char_ >= 0; }
+
+  template <typename Emit>
+  void Begin(Emit&& emit) const {}
+  template <typename Emit>
+  void Apply(UChar32 c, Emit&& emit) const {
+    if (c != pattern_char_) {
+      emit(c);
+      return;
+    }
+    for (UChar32 content_char : content_chars_) {
+      emit(content_char);
+    }
+  }
+
+ private:
+  icu::UnicodeString pattern_;
+  icu::UnicodeString content_;
+  UChar32 pattern_char_;
+  std::vector<UChar32> content_chars_;
+};
+
+// Prepend
+class Prepend : public Normalizer {
+ public:
+  explicit Prepend(const std::string& prepend);
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+  template <typename Emit>
+  void Begin(Emit&& emit) const {
+    for (UChar32 c : prepend_chars_) {
+      emit(c);
+    }
+  }
+  template <typename Emit>
+  void Apply(UChar32 c, Emit&& emit) const {
+    emit(c);
+  }
+
+ private:
+  std::vector<UChar32> prepend_chars_;
+};
+
+// FusedNormalizer runs a chain of char-level normalizers known at compile
+// time: each code point is pushed through all of them before the next one
+// is read, without intermediate results or virtual calls between steps.
+template <typename... Steps>
+class FusedNormalizer : public Normalizer {
+ public:
+  explicit FusedNormalizer(const Steps&... steps) : steps_(steps...) {}
+
+  NormalizerResult Normalize(NormalizerResult input) override {
+    if ((std::is_same_v<Steps, Lowercase> || ...) &&
+        Lowercase::NeedsFullMapping(input.normalized)) {
+      std::apply(
+          [&](Steps&... steps) {
+            ((input = steps.Normalize(std::move(input))), ...);
+          },
+          steps_);
+      return input;
+    }
+    return normalizeChars(input, *this);
+  }
+
+  std::string NormalizeString(std::string input) override {
+    NormalizerResult normalized =
+        Normalize(NormalizerResult(icu::UnicodeString::fromUTF8(input)));
+    std::string result;
+    normalized.normalized.toUTF8String(result);
+    return result;
+  }
+
+  // Later steps prepend in front of what earlier steps prepended, and what
+  // a step prepends still goes through the steps after it.
+  template <typename Emit>
+  void Begin(Emit&& emit) const {
+    BeginAt<0>(emit);
+  }
+
+  template <typename Emit>
+  void Apply(UChar32 c, Emit&& emit) const {
+    ApplyAt<0>(c, emit);
+  }
+
+ private:
+  template <size_t I, typename Emit>
+  void BeginAt(Emit& emit) const {
+    if constexpr (I < sizeof...(Steps)) {
+      BeginAt<I + 1>(emit);
+      std::get<I>(steps_).Begin(
+          [&](UChar32 out) { ApplyAt<I + 1>(out, emit); });
+    }
+  }
+
+  template <size_t I, typename Emit>
+  void ApplyAt(UChar32 c, Emit& emit) const {
+    if constexpr (I == sizeof...(Steps)) {
+      emit(c);
+    } else {
+      std::get<I>(steps_).Apply(
+          c, [&](UChar32 out) { ApplyAt<I + 1>(out, emit); });
+    }
+  }
+
+  std::tuple<Steps...> steps_;
+};
+
+// Common chains, instantiated once in normalizer.cc.
+extern template class FusedNormalizer<Prepend, Replace>;
+extern template class FusedNormalizer<Lowercase, StripAccents>;
+extern template class FusedNormalizer<StripAccents, Lowercase>;
+
+using CharNormalizer = std::variant<Lowercase, StripAccents, Replace, Prepend>;
+
+// DynamicFusedNormalizer runs any other chain of char-level normalizers in
+// one pass, dispatching on the step type per code point.
+class DynamicFusedNormalizer : public Normalizer {
+ public:
+  explicit DynamicFusedNormalizer(const std::vector<CharNormalizer>& steps);
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+  template <typename Emit>
+  void Begin(Emit&& emit) const {
+    for (size_t i = steps_.size(); i-- > 0;) {
+      std::visit(
+          [&](const auto& step) {
+            step.Begin([&](UChar32 out) { ApplyAt(i + 1, out, emit); });
+          },
+          steps_[i]);
+    }
+  }
+
+  template <typename Emit>
+  void Apply(UChar32 c, Emit&& emit) const {
+    ApplyAt(0, c, emit);
+  }
+
+ private:
+  template <typename Emit>
+  void ApplyAt(size_t i, UChar32 c, Emit& emit) const {
+    if (i == steps_.size()) {
+      emit(c);
+      return;
+    }
+    std::visit(
+        [&](const auto& step) {
+          step.Apply(c, [&](UChar32 out) { ApplyAt(i + 1, out, emit); });
+        },
+        steps_[i]);
+  }
+
+  std::vector<CharNormalizer> steps_;
+};
+
+// Sequence
+class Sequence : public Normalizer {
+ public:
+  explicit Sequence(
+      const std::vector<std::shared_ptr<Normalizer>>& normalizers);
+  NormalizerResult Normalize(NormalizerResult input) override;
+  std::string NormalizeString(std::string input) override;
+
+ private:
+  std::vector<std::shared_ptr<Normalizer>> normalizers_;
+};
+
+// Builds the pipeline for a sequence of normalizers: consecutive char-level
+// steps are fused into a single pass, preferring the instantiated chains,
+// and only what is left runs step by step. Throws std::invalid_argument when
+// a step is null, which is what parsing returns for an unsupported
+// normalizer.
+std::shared_ptr<Normalizer> fuseNormalizers(
+    const std::vector<std::shared_ptr<Normalizer>>& normalizers);
+
 void doCleanText(NormalizerResult* input);
 
 void doHandleChineseChars(NormalizerResult* input);
@@ -1,6 +1,7 @@
 // Copyright 2025 Omkar Prabhu
 #pragma once
 
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -16,7 +17,14 @@ class PostProcessor {
  public:
   PostProcessor();
   virtual std::vector<Encoding> ProcessEncodings(
-      const std::vector<Encoding>& encodings);
+      std::vector<Encoding> encodings);
+  // Processes the encodings straight into a single Encoding allocated from
+  // `resource`, filling only the fields selected by `options`.
+  virtual Encoding Process(std::vector<Encoding> encodings,
+                           EncodeOptions options,
+                           std::pmr::memory_resource* resource);
+  // Number of special tokens added to one or a pair of sequences.
+  virtual int AddedTokens(bool is_pair);
 };
 
 class TemplateProcessor {
@@ -39,7 +47,12 @@ class TemplateProcessing : public PostProcessor {
       const std::vector<TemplateProcessor>& pair,
       const std::unordered_map<std::string, int>& special_tokens);
   std::vector<Encoding> ProcessEncodings(
-      const std::vector<Encoding>& encodings) override;
+      std::vector<Encoding> encodings) override;
+  // Sizes the output from the template, then writes the special tokens and
+  // moves the sequences into it.
+  Encoding Process(std::vector<Encoding> encodings, EncodeOptions options,
+                   std::pmr::memory_resource* resource) override;
+  int AddedTokens(bool is_pair) override;
 
  private:
   std::vector<TemplateProcessor> single_;
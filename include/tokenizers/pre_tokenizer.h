@@ -1,18 +1,27 @@
 // Copyright 2025 Omkar Prabhu
 #pragma once
 
+#include <unicode/regex.h>
 #include <unicode/uchar.h>
 #include <unicode/unistr.h>
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "tokenizers/unicode.h"
+
 namespace tokenizers {
 
 namespace pre_tokenizers {
 
+// char_offsets holds the offsets in the original input of every code point
+// of every piece and offsets those of every piece, both are left empty when
+// offsets are not tracked.
 class PreTokenizerResult {
  public:
   PreTokenizerResult();
@@ -26,13 +35,17 @@ class PreTokenizerResult {
   std::vector<std::vector<std::pair<int, int>>> char_offsets;
   std::vector<std::pair<int, int>> offsets;
   bool pre_pre_tokenized;
+  // Without offsets, whether the first piece starts the input of the
+  // tokenizer, which is what PrependScheme::kFirst looks at.
+  bool at_start = true;
 };
 
 enum class SplitDelimiterBehavior {
   kRemoved,
   kIsolated,
   kMergedWithPrevious,
-  kMergedWithNext
+  kMergedWithNext,
+  kContiguous
 };
 
 PreTokenizerResult split(const PreTokenizerResult& input,
@@ -56,6 +69,174 @@ class BertPreTokenizer : public PreTokenizer {
       const std::string& input) override;
 };
 
+// ByteLevel
+class ByteLevel : public PreTokenizer {
+ public:
+  explicit ByteLevel(bool add_prefix_space = true, bool use_regex = true);
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+ private:
+  bool add_prefix_space_;
+  bool use_regex_;
+};
+
+enum class PrependScheme { kAlways, kFirst, kNever };
+
+// Metaspace
+class Metaspace : public PreTokenizer {
+ public:
+  explicit Metaspace(const std::string& replacement = "\u2581",
+                     PrependScheme prepend_scheme = PrependScheme::kAlways,
+                     bool split = true);
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+ private:
+  UChar32 replacement_;
+  PrependScheme prepend_scheme_;
+  bool split_;
+};
+
+// What a char-level pre-tokenizer does with a single code point.
+enum class CharAction {
+  kKeep,
+  kRemove,
+  kIsolate,
+  kMergeWithPrevious,
+  kMergeWithNext,
+  kContiguous
+};
+
+// Char-level pre-tokenizers decide on each code point on its own (Classify),
+// so a chain of them can be run as a single pass, see FusedSplit.
+
+// WhitespaceSplit
+class WhitespaceSplit : public PreTokenizer {
+ public:
+  WhitespaceSplit();
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+  CharAction Classify(UChar32 c) const {
+    return unicode::IsUWhiteSpace(c) ? CharAction::kRemove : CharAction::kKeep;
+  }
+};
+
+// Punctuation
+class Punctuation : public PreTokenizer {
+ public:
+  explicit Punctuation(
+      SplitDelimiterBehavior behavior = SplitDelimiterBehavior::kIsolated);
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+  CharAction Classify(UChar32 c) const {
+    bool punctuation = c < 0x80 ? (c > ' ' && c < 0x7F && !unicode::IsAlnum(c))
+                                : unicode::IsPunct(c);
+    return punctuation ? action_ : CharAction::kKeep;
+  }
+
+ private:
+  CharAction action_;
+};
+
+// Digits
+class Digits : public PreTokenizer {
+ public:
+  explicit Digits(bool individual_digits = false);
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+  CharAction Classify(UChar32 c) const {
+    if (!(unicode::CategoryMask(c) & U_GC_N_MASK))
+      return CharAction::kKeep;
+    return individual_digits_ ? CharAction::kIsolate : CharAction::kContiguous;
+  }
+
+ private:
+  bool individual_digits_;
+};
+
+using CharPreTokenizer = std::variant<WhitespaceSplit, Punctuation, Digits>;
+
+// FusedSplit runs a chain of char-level pre-tokenizers in one pass. Only
+// Removed, Isolated and Contiguous steps fuse, at most one of them
+// Contiguous: a code point removed by any step is removed, otherwise
+// isolated by any step is isolated, which is what running them one after the
+// other gives.
+class FusedSplit : public PreTokenizer {
+ public:
+  explicit FusedSplit(const std::vector<CharPreTokenizer>& steps);
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+  CharAction Classify(UChar32 c) const;
+
+ private:
+  std::vector<CharPreTokenizer> steps_;
+};
+
+// Split
+class Split : public PreTokenizer {
+ public:
+  // The GPT-2 and Llama-3 patterns run on the hand-written splitters, other
+  // regexes on ICU.
+  Split(const std::string& pattern, bool is_regex,
+        SplitDelimiterBehavior behavior, bool invert = false);
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+ private:
+  std::vector<std::pair<int, int>> Matches(
+      const icu::UnicodeString& input) const;
+
+  icu::UnicodeString pattern_;
+  SplitDelimiterBehavior behavior_;
+  bool invert_;
+  std::vector<std::pair<int, int>> (*splitter_)(const icu::UnicodeString&);
+  std::unique_ptr<icu::RegexPattern> regex_;
+};
+
+// Sequence
+class Sequence : public PreTokenizer {
+ public:
+  explicit Sequence(
+      const std::vector<std::shared_ptr<PreTokenizer>>& pre_tokenizers);
+  PreTokenizerResult PreTokenize(const PreTokenizerResult& input) override;
+  std::vector<std::pair<std::string, std::pair<int, int>>> PreTokenizeString(
+      const std::string& input) override;
+
+ private:
+  std::vector<std::shared_ptr<PreTokenizer>> pre_tokenizers_;
+};
+
+// Builds the pipeline for a sequence of pre-tokenizers: consecutive
+// char-level steps are fused into a FusedSplit and only what is left runs
+// step by step. Throws std::invalid_argument when a step is null, which is
+// what parsing returns for an unsupported pre-tokenizer.
+std::shared_ptr<PreTokenizer> fusePreTokenizers(
+    const std::vector<std::shared_ptr<PreTokenizer>>& pre_tokenizers);
+
+// Maps a byte to the printable code point used for it by byte-level BPE.
+UChar32 byteToUnicode(uint8_t byte);
+
+// Code unit ranges matched by the GPT-2 pattern
+// 's|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+|\s+(?!\S)|\s+
+std::vector<std::pair<int, int>> splitGPT2(const icu::UnicodeString& input);
+
+// Code unit ranges matched by the Llama-3 pattern
+// (?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,3}
+// | ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+
+std::vector<std::pair<int, int>> splitLlama3(const icu::UnicodeString& input);
+
 } // namespace pre_tokenizers
 
 } // namespace tokenizers
@@ -0,0 +1,96 @@
+// Copyright 2025 Omkar Prabhu
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tokenizers/tokenizer.h"
+
+namespace tokenizers {
+
+struct TokenizerRegistryEntry {
+  // SHA-256 of the json config, in hex.
+  std::string digest;
+  size_t memory_usage;
+  // False once evicted while a caller still holds the tokenizer.
+  bool resident;
+  std::vector<std::string> names;
+};
+
+// Shares tokenizers between their users. Tokenizers are keyed by the
+// SHA-256 of their json config, so identical configs registered under
+// different names are loaded once. Loaded tokenizers are kept in least
+// recently used order and evicted once their total memory usage exceeds the
+// budget; an evicted tokenizer still held by a caller is handed out again
+// instead of being reloaded. Returned tokenizers are shared, hence const.
+class TokenizerRegistry {
+ public:
+  // A memory budget of 0 never evicts.
+  explicit TokenizerRegistry(size_t memory_budget = 0);
+  TokenizerRegistry(const TokenizerRegistry &) = delete;
+  TokenizerRegistry &operator=(const TokenizerRegistry &) = delete;
+
+  // Registers a name whose json config is produced by load_config, which is
+  // called on first use and again after the tokenizer has been evicted.
+  void Register(const std::string &name,
+                std::function<std::string()> load_config);
+  void RegisterFile(const std::string &name, const std::string &path);
+  // Throws std::out_of_range for names that were never registered.
+  std::shared_ptr<const Tokenizer> Get(const std::string &name);
+  std::shared_ptr<const Tokenizer> Load(const std::string &json_config);
+
+  size_t memory_budget() const { return memory_budget_; }
+  // Tokenizers grow as they build their decode tables on first use, so the
+  // usage of those that built one is measured again whenever a load checks
+  // the budget, and is as of the last such check.
+  size_t memory_usage() const;
+  // Entries in most recently used order, resident ones first.
+  std::vector<TokenizerRegistryEntry> Entries() const;
+
+ private:
+  // SHA-256 of the json config.
+  using Key = std::array<uint8_t, 32>;
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      size_t hash;
+      std::memcpy(&hash, key.data(), sizeof(hash));
+      return hash;
+    }
+  };
+  struct Entry {
+    std::shared_ptr<const Tokenizer> tokenizer;
+    std::weak_ptr<const Tokenizer> shared;
+    size_t memory_usage = 0;
+    // Tokenizer::BuiltTables when memory_usage was measured.
+    int built_tables = 0;
+    std::list<Key>::iterator lru;
+  };
+  struct Name {
+    std::function<std::string()> load_config;
+    std::optional<Key> key;
+  };
+  std::shared_ptr<const Tokenizer> Find(const Key &key);
+  std::shared_ptr<const Tokenizer> Load(const std::string &json_config,
+                                        const Key &key);
+  void Evict();
+
+  size_t memory_budget_;
+  size_t memory_usage_ = 0;
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  std::unordered_map<std::string, Name> names_;
+  // Keys of the resident entries, most recently used first.
+  std::list<Key> lru_;
+};
+
+} // namespace tokenizers
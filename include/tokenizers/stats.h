@@ -0,0 +1,89 @@
+// Copyright 2025 Omkar Prabhu
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace tokenizers {
+
+// Stats are only collected when the library is built with
+// TOKENIZERS_ENABLE_STATS (cmake -DENABLE_STATS=ON) and enabled at runtime
+// with Tokenizer::EnableStats. Otherwise all instrumentation compiles away.
+#ifdef TOKENIZERS_ENABLE_STATS
+inline constexpr bool kStatsCompiled = true;
+#else
+inline constexpr bool kStatsCompiled = false;
+#endif
+
+enum class Stage {
+  kAddedVocabulary,
+  kNormalizer,
+  kPreTokenizer,
+  kModel,
+  kTruncation,
+  kPostProcessor,
+  kPadding,
+  kCount,
+};
+
+// Bytes are UTF-16 text entering and leaving the text stages, tokens are
+// the tokens produced by the stage (or left after it for token stages).
+struct StageStats {
+  uint64_t calls = 0;
+  uint64_t nanoseconds = 0;
+  uint64_t bytes_in = 0;
+  uint64_t bytes_out = 0;
+  uint64_t tokens_out = 0;
+};
+
+struct TokenizerStats {
+  uint64_t encode_calls = 0;
+  // UTF-8 bytes passed to Encode.
+  uint64_t bytes_in = 0;
+  uint64_t tokens_out = 0;
+  uint64_t unk_tokens = 0;
+  std::array<StageStats, static_cast<int>(Stage::kCount)> stages;
+
+  const StageStats &stage(Stage stage) const {
+    return stages[static_cast<int>(stage)];
+  }
+};
+
+// Relaxed atomic counters shared by the threads encoding with a tokenizer.
+class StatsCollector {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  bool enabled() const {
+    return kStatsCompiled && enabled_.load(std::memory_order_relaxed);
+  }
+  void set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+  void RecordEncode(uint64_t bytes_in, uint64_t tokens_out);
+  void RecordUnkTokens(uint64_t unk_tokens);
+  // Adds the time since `start` to `stage` and restarts `start`.
+  void RecordStage(Stage stage, Clock::time_point *start, uint64_t bytes_in,
+                   uint64_t bytes_out, uint64_t tokens_out);
+  TokenizerStats Snapshot() const;
+  void Reset();
+
+ private:
+  struct AtomicStageStats {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> nanoseconds{0};
+    std::atomic<uint64_t> bytes_in{0};
+    std::atomic<uint64_t> bytes_out{0};
+    std::atomic<uint64_t> tokens_out{0};
+  };
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> encode_calls_{0};
+  std::atomic<uint64_t> bytes_in_{0};
+  std::atomic<uint64_t> tokens_out_{0};
+  std::atomic<uint64_t> unk_tokens_{0};
+  std::array<AtomicStageStats, static_cast<int>(Stage::kCount)> stages_;
+};
+
+} // namespace tokenizers
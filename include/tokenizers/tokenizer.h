@@ -3,9 +3,12 @@
 
 #include <simdjson.h>
 
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -13,10 +16,12 @@
 #include "tokenizers/added_vocabulary.h"
 #include "tokenizers/common.h"
 #include "tokenizers/decoder.h"
+#include "tokenizers/executor.h"
 #include "tokenizers/model.h"
 #include "tokenizers/normalizer.h"
 #include "tokenizers/post_processor.h"
 #include "tokenizers/pre_tokenizer.h"
+#include "tokenizers/stats.h"
 #include "tokenizers/utils.h"
 
 namespace tokenizers {
@@ -35,16 +40,111 @@ std::shared_ptr<tokenizers::post_processors::PostProcessor> parsePostProcessor(
 std::shared_ptr<tokenizers::decoders::Decoder> parseDecoder(
     simdjson::ondemand::value &config);
 
+// A padded batch of encodings and the position of each in the input.
+struct EncodedBatch {
+  std::vector<Encoding> encodings;
+  std::vector<int> indices;
+};
+
+// Decoded sequences back to back in one buffer, sequence i is
+// text[offsets[i], offsets[i + 1]).
+struct DecodedBatch {
+  std::string text;
+  std::vector<size_t> offsets;
+
+  size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+  std::string_view operator[](size_t i) const {
+    return std::string_view(text).substr(offsets[i],
+                                         offsets[i + 1] - offsets[i]);
+  }
+};
+
 class Tokenizer {
  public:
   Tokenizer();
   explicit Tokenizer(const std::string &json_config);
 
-  Encoding Encode(const std::string &input, bool add_special_tokens = true);
+  // The Encoding, its overflowing encodings and the encodings passed between
+  // truncation, post-processing and padding allocate from `resource`. The
+  // normalizer, pre-tokenizer and model keep their intermediates on the
+  // global heap: ICU strings, as ICU only has a process-wide allocator, and
+  // the offsets and splits of NormalizerResult and PreTokenizerResult and
+  // the tokens of Model::Tokenize, which are std containers in the
+  // interfaces every component implements. Those make up most of the heap
+  // allocations of an Encode, so `resource` does not remove the contention
+  // on the global allocator between threads.
+  // With an executor, an input longer than kBatchChunkLength UTF-16 code
+  // units is split into chunks at whitespace that are encoded in parallel
+  // on it, under the same conditions as in EncodeBatch. The result is the
+  // same as without one. Runs on one executor are serialized, so callers
+  // encoding concurrently on a shared executor take turns; give each its
+  // own executor for the chunks to overlap.
+  // Without kOverflowing in `options` (e.g. with kAllFields), an input that
+  // truncation cuts short is only encoded up to the tokens it keeps.
+  Encoding Encode(const std::string &input, bool add_special_tokens = true,
+                  EncodeOptions options = EncodeOptions::kAll,
+                  std::pmr::memory_resource *resource =
+                      std::pmr::get_default_resource(),
+                  WorkStealingExecutor *executor = nullptr) const;
   Encoding Encode(const std::pair<std::string, std::string> &input,
-                  bool add_special_tokens = true);
+                  bool add_special_tokens = true,
+                  EncodeOptions options = EncodeOptions::kAll,
+                  std::pmr::memory_resource *resource =
+                      std::pmr::get_default_resource()) const;
+  // Encodes the inputs in parallel on `executor`, the default executor when
+  // null. When the normalizer and pre-tokenizer never look across
+  // whitespace, documents longer than kBatchChunkLength UTF-16 code units
+  // are also split at whitespace into chunks that are encoded in parallel
+  // and stitched back together. Padding applies across the batch.
+  std::vector<Encoding> EncodeBatch(
+      const std::vector<std::string> &inputs, bool add_special_tokens = true,
+      EncodeOptions options = EncodeOptions::kAll,
+      WorkStealingExecutor *executor = nullptr) const;
+  // In UTF-16 code units, as counted after converting the UTF-8 input.
+  static constexpr int kBatchChunkLength = 4096;
+  // Encodes the inputs and groups them by token length into batches of at
+  // most max_batch_size, each padded to its longest encoding with at most
+  // max_padding_ratio of padding tokens. Uses the tokenizer's padding
+  // settings, or the defaults when it has none.
+  std::vector<EncodedBatch> EncodeBucketed(
+      const std::vector<std::string> &inputs, int max_batch_size,
+      double max_padding_ratio = 0.1, bool add_special_tokens = true,
+      EncodeOptions options = EncodeOptions::kAll,
+      WorkStealingExecutor *executor = nullptr) const;
+  // The number of tokens Encode produces for the input before truncation
+  // and padding. Runs the pipeline without tracking offsets or building an
+  // Encoding, and counts the model's tokens without building them.
+  size_t CountTokens(std::string_view input,
+                     bool add_special_tokens = true) const;
   std::string Decode(const std::vector<int> &ids,
-                     bool skip_special_tokens = true);
+                     bool skip_special_tokens = true) const;
+  // Decodes the sequences in parallel on `executor`, the default executor
+  // when null. The decoded length is only known after decoding, so each
+  // worker decodes a range of sequences into its own buffer, and the
+  // buffers are then copied into `text`, costing one extra copy of it.
+  DecodedBatch DecodeBatch(const std::vector<std::vector<int>> &ids,
+                           bool skip_special_tokens = true,
+                           WorkStealingExecutor *executor = nullptr) const;
+  // Same as DecodeBatch, into a string per sequence.
+  std::vector<std::string> DecodeBatchStrings(
+      const std::vector<std::vector<int>> &ids,
+      bool skip_special_tokens = true,
+      WorkStealingExecutor *executor = nullptr) const;
+
+  // Per-stage timing and counters of Encode, a no-op unless the library is
+  // built with TOKENIZERS_ENABLE_STATS.
+  void EnableStats(bool enabled = true);
+  TokenizerStats Stats() const;
+  void ResetStats();
+  // Approximate bytes held by the tokenizer, dominated by the vocabularies.
+  size_t MemoryUsage() const;
+  // The number of structures built on first use so far, such as the
+  // reverse vocab of the first decode. MemoryUsage only grows with it.
+  int BuiltTables() const;
+  // Heap bytes of each structure of the model and the added vocabulary,
+  // named "model.<structure>" and "added_vocabulary.<structure>". Decode
+  // tables are built on the first decode and report nothing until then.
+  MemoryUsageMap MemoryUsageByStructure() const;
 
   std::shared_ptr<tokenizers::normalizers::Normalizer> normalizer;
   std::shared_ptr<tokenizers::pre_tokenizers::PreTokenizer> pre_tokenizer;
@@ -54,10 +154,43 @@ class Tokenizer {
   std::shared_ptr<Truncation> truncation;
   std::shared_ptr<AddedVocabulary> added_vocabulary;
   std::shared_ptr<Padding> padding;
+  OffsetType offset_type = OffsetType::kUtf16;
   std::string version;
 
  private:
-  Encoding EncodeSingleSequence(icu::UnicodeString *unicode_input, int type_id);
+  Encoding EncodeSingleSequence(icu::UnicodeString *unicode_input, int type_id,
+                                EncodeOptions options,
+                                std::pmr::memory_resource *resource,
+                                bool collect_stats) const;
+  // The number of leading (or, truncating from the left, trailing) tokens
+  // of sequence `index` that truncation can keep, given that the other
+  // sequence has `other_tokens` tokens, or -1 when all of it is needed.
+  int TokenLimit(int num_sequences, int index, int other_tokens,
+                 bool add_special_tokens, EncodeOptions options) const;
+  // Encodes the sequence chunk by chunk from the end truncation keeps until
+  // token_limit tokens are produced, all of it when token_limit is -1.
+  Encoding EncodeSequence(const std::string &input, int type_id,
+                          int token_limit, EncodeOptions options,
+                          std::pmr::memory_resource *resource,
+                          bool collect_stats) const;
+  // Encodes the chunks of the input between whitespace in parallel.
+  Encoding EncodeChunked(const std::string &input, int type_id,
+                         EncodeOptions options,
+                         std::pmr::memory_resource *resource,
+                         bool collect_stats,
+                         WorkStealingExecutor *executor) const;
+  std::vector<Encoding> EncodeBatchUnpadded(
+      const std::vector<std::string> &inputs, bool add_special_tokens,
+      EncodeOptions options, WorkStealingExecutor *executor) const;
+  // Appends the decoded ids to *out, `tokens` is scratch space.
+  void DecodeTo(const std::vector<int> &ids, bool skip_special_tokens,
+                std::vector<std::string_view> *tokens, std::string *out) const;
+  Encoding PostProcessEncodings(std::vector<Encoding> encodings,
+                                bool add_special_tokens, EncodeOptions options,
+                                std::pmr::memory_resource *resource,
+                                bool collect_stats, bool pad = true) const;
+
+  std::shared_ptr<StatsCollector> stats_;
 };
 
 } // namespace tokenizers
@@ -0,0 +1,76 @@
+// Copyright 2025 Omkar Prabhu
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tokenizers/executor.h"
+#include "tokenizers/model.h"
+#include "tokenizers/normalizer.h"
+#include "tokenizers/pre_tokenizer.h"
+
+namespace tokenizers {
+
+namespace trainers {
+
+// Learns a WordPiece vocabulary the way the WordPiece trainer of Hugging
+// Face tokenizers does. Words are split into characters, every one but the
+// first with continuing_subword_prefix, and the most frequent adjacent pair
+// of tokens is merged into a new token until the vocabulary has vocab_size
+// tokens or no pair occurs min_frequency times. The vocabulary starts with
+// the special tokens and then the limit_alphabet most frequent characters,
+// all of them when it is -1.
+class WordPieceTrainer {
+ public:
+  explicit WordPieceTrainer(
+      int vocab_size = 30000, int min_frequency = 0,
+      const std::vector<std::string> &special_tokens = {"[PAD]", "[UNK]",
+                                                        "[CLS]", "[SEP]",
+                                                        "[MASK]"},
+      int limit_alphabet = -1,
+      const std::string &continuing_subword_prefix = "##",
+      const std::string &unk_token = "[UNK]");
+
+  // Normalizes and pre-tokenizes the inputs as BERT does and counts their
+  // words, in parallel on `executor`, the default executor when null. Each
+  // worker counts into its own shards, which are then merged shard by shard.
+  void Feed(const std::vector<std::string> &inputs,
+            WorkStealingExecutor *executor = nullptr);
+  // Feeds the lines of a file, a block of lines at a time.
+  void FeedFile(const std::string &path,
+                WorkStealingExecutor *executor = nullptr);
+  // Learns the vocabulary from the words fed so far, tokens in id order.
+  std::vector<std::string> Train(WorkStealingExecutor *executor = nullptr);
+
+  std::shared_ptr<models::WordPiece> MakeModel(
+      const std::vector<std::string> &vocab) const;
+  // tokenizer.json of a BERT tokenizer with the vocabulary, which
+  // Tokenizer(json_config) loads.
+  std::string ToJson(const std::vector<std::string> &vocab) const;
+
+  // Distinct words counted so far.
+  size_t NumWords() const;
+
+  static constexpr int kNumShards = 64;
+
+ private:
+  using WordCounts = std::unordered_map<std::string, uint64_t>;
+  void CountWords(const std::string &input, std::vector<WordCounts> *shards);
+
+  int vocab_size_;
+  int min_frequency_;
+  std::vector<std::string> special_tokens_;
+  int limit_alphabet_;
+  std::string continuing_subword_prefix_;
+  std::string unk_token_;
+  normalizers::BertNormalizer normalizer_;
+  pre_tokenizers::BertPreTokenizer pre_tokenizer_;
+  std::vector<WordCounts> word_counts_;
+};
+
+} // namespace trainers
+
+} // namespace tokenizers
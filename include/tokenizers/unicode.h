@@ -0,0 +1,142 @@
+// Copyright 2025 Omkar Prabhu
+#pragma once
+
+#include <unicode/uchar.h>
+#include <unicode/umachine.h>
+
+#include <cstdint>
+
+namespace tokenizers {
+
+namespace unicode {
+
+// Character properties looked up for every character of the input. Built
+// with TOKENIZERS_UNICODE_TABLES they come from two-level tables generated
+// from the Unicode Character Database by scripts/generate_unicode_tables.py
+// instead of ICU, which saves ICU's per-call overhead. Results are the same
+// as ICU's for every code point the tables' Unicode version assigns. The
+// tables only replace these lookups: strings stay icu::UnicodeString, and
+// regex splitting, normalization forms and full case mapping still call
+// ICU, so the library includes and links ICU either way.
+
+namespace tables {
+
+constexpr int kTableShift = 7;
+constexpr UChar32 kTableMask = (1 << kTableShift) - 1;
+constexpr uint8_t kCategoryMask = 0x1F;
+constexpr uint8_t kWhiteSpaceFlag = 0x20;
+
+template <typename T>
+struct Table {
+  UChar32 limit;
+  const uint16_t *index;
+  const T *blocks;
+
+  T Get(UChar32 c) const {
+    if (c < 0 || c >= limit)
+      return 0;
+    return blocks[(index[c >> kTableShift] << kTableShift) | (c & kTableMask)];
+  }
+};
+
+extern const char kUnicodeVersion[];
+// General category in the low bits, as a UCharCategory, and White_Space.
+extern const Table<uint8_t> kCategories;
+extern const Table<uint8_t> kCombiningClasses;
+// Index into kLowercaseDeltas.
+extern const Table<uint8_t> kLowercase;
+extern const int32_t kLowercaseDeltas[];
+// Index into kDecompositions, which holds the length of the full canonical
+// decomposition followed by its code points. Hangul syllables are left out.
+extern const Table<uint16_t> kDecomposition;
+extern const UChar32 kDecompositions[];
+
+inline int8_t CharType(UChar32 c) {
+  return kCategories.Get(c) & kCategoryMask;
+}
+
+inline bool IsUWhiteSpace(UChar32 c) {
+  return kCategories.Get(c) & kWhiteSpaceFlag;
+}
+
+inline UChar32 ToLower(UChar32 c) {
+  return c + kLowercaseDeltas[kLowercase.Get(c)];
+}
+
+inline uint8_t CombiningClass(UChar32 c) { return kCombiningClasses.Get(c); }
+
+// Writes the full canonical decomposition of c to out, which must hold
+// kMaxDecomposition code points, and returns its length, 0 when c does not
+// decompose.
+constexpr int kMaxDecomposition = 4;
+inline int Decompose(UChar32 c, UChar32 *out) {
+  constexpr UChar32 kHangulFirst = 0xAC00;
+  constexpr UChar32 kHangulLast = 0xD7A3;
+  if (c >= kHangulFirst && c <= kHangulLast) {
+    constexpr int kVowels = 21;
+    constexpr int kTrailing = 28;
+    int s = c - kHangulFirst;
+    out[0] = 0x1100 + s / (kVowels * kTrailing);
+    out[1] = 0x1161 + s % (kVowels * kTrailing) / kTrailing;
+    if (s % kTrailing == 0)
+      return 2;
+    out[2] = 0x11A7 + s % kTrailing;
+    return 3;
+  }
+  const UChar32 *decomposition = kDecompositions + kDecomposition.Get(c);
+  for (int i = 0; i < decomposition[0]; i++) {
+    out[i] = decomposition[i + 1];
+  }
+  return decomposition[0];
+}
+
+} // namespace tables
+
+#ifdef TOKENIZERS_UNICODE_TABLES
+
+inline int8_t CharType(UChar32 c) { return tables::CharType(c); }
+
+inline bool IsUWhiteSpace(UChar32 c) { return tables::IsUWhiteSpace(c); }
+
+inline UChar32 ToLower(UChar32 c) { return tables::ToLower(c); }
+
+#else
+
+inline int8_t CharType(UChar32 c) { return u_charType(c); }
+
+inline bool IsUWhiteSpace(UChar32 c) { return u_isUWhiteSpace(c); }
+
+inline UChar32 ToLower(UChar32 c) { return u_tolower(c); }
+
+#endif
+
+inline uint32_t CategoryMask(UChar32 c) { return U_MASK(CharType(c)); }
+
+// Same as u_isWhitespace: space separators other than no-break spaces, line
+// and paragraph separators, and the ASCII and information separator
+// controls.
+inline bool IsWhitespace(UChar32 c) {
+  if (c < 0x80)
+    return (c >= 0x09 && c <= 0x0D) || (c >= 0x1C && c <= 0x20);
+  if (c == 0xA0 || c == 0x2007 || c == 0x202F)
+    return false;
+  return CategoryMask(c) & U_GC_Z_MASK;
+}
+
+inline bool IsPunct(UChar32 c) { return CategoryMask(c) & U_GC_P_MASK; }
+
+inline bool IsAlnum(UChar32 c) {
+  return CategoryMask(c) & (U_GC_L_MASK | U_GC_ND_MASK);
+}
+
+// Code points of the CJK Unified Ideographs blocks up to Extension G, the
+// blocks BERT treats as Chinese characters.
+inline bool IsChineseChar(UChar32 c) {
+  return (c >= 0x4E00 && c <= 0x9FFF) || (c >= 0x3400 && c <= 0x4DBF) ||
+         (c >= 0x20000 && c <= 0x2A6DF) || (c >= 0x2A700 && c <= 0x2EBEF) ||
+         (c >= 0x30000 && c <= 0x3134F);
+}
+
+} // namespace unicode
+
+} // namespace tokenizers
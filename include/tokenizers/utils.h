@@ -24,8 +24,14 @@ class Truncation {
   Truncation();
   Truncation(const TruncationDirection &direction,
              const TruncationStrategy &strategy, int max_length, int stride);
+  // Truncates so that the encodings and the `added_tokens` special tokens
+  // of the post-processor fit max_length together.
   std::vector<Encoding> TruncateEncodings(
-      const std::vector<Encoding> &encodings);
+      const std::vector<Encoding> &encodings, int added_tokens = 0);
+  TruncationDirection direction() const { return direction_; }
+  TruncationStrategy strategy() const { return strategy_; }
+  int max_length() const { return max_length_; }
+  int stride() const { return stride_; }
 
  private:
   TruncationDirection direction_;
@@ -63,6 +69,14 @@ void PadEncoding(Encoding *encoding, int target_length, int pad_id,
                  int pad_type_id, const std::string &pad_token,
                  PaddingDirection direction);
 
+// Groups the indices of sequences into batches of at most max_batch_size,
+// in order of length, so that padding a batch to its longest sequence makes
+// at most max_padding_ratio of its tokens padding. A single sequence always
+// makes a batch.
+std::vector<std::vector<int>> BucketByLength(const std::vector<int> &lengths,
+                                             int max_batch_size,
+                                             double max_padding_ratio);
+
 std::vector<std::pair<int, int>> FindMatches(
     const icu::UnicodeString &input,
     const std::vector<icu::UnicodeString> &patterns);
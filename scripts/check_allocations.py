@@ -0,0 +1,83 @@
+"""Checks the allocation benchmarks against a checked-in baseline.
+
+Reads the json output of the allocation benchmarks and fails when the
+allocs or alloc_bytes counter of a benchmark exceeds its baseline by more
+than the tolerance:
+
+    ./tokenizers_benchmarks --benchmark_filter=Allocations \\
+        --benchmark_out=allocations.json --benchmark_out_format=json
+    python3 scripts/check_allocations.py tests/allocation_baseline.json \\
+        allocations.json
+
+After an intended change, --update rewrites the baseline from the results.
+The baseline comes from a Release build on Linux with glibc, where malloc
+itself is counted, so ICU's allocations are included.
+"""
+import argparse
+import json
+import sys
+
+COUNTERS = ["allocs", "alloc_bytes"]
+# Absolute slack on top of the relative tolerance, so that counters of a few
+# allocations per call do not fail on a single extra one.
+SLACK = {"allocs": 1, "alloc_bytes": 64}
+
+
+def read_results(path):
+    with open(path) as f:
+        benchmarks = json.load(f)["benchmarks"]
+    return {
+        b["name"]: {c: b[c] for c in COUNTERS if c in b}
+        for b in benchmarks
+        if b.get("run_type", "iteration") == "iteration"
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("results")
+    parser.add_argument("--tolerance", type=float, default=0.1,
+                        help="allowed relative increase, 0.1 by default")
+    parser.add_argument("--update", action="store_true",
+                        help="rewrite the baseline from the results")
+    args = parser.parse_args()
+
+    results = read_results(args.results)
+    if args.update:
+        baseline = {
+            name: {c: round(v, 2) for c, v in counters.items()}
+            for name, counters in sorted(results.items())
+        }
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2)
+            f.write("\n")
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    failures = []
+    for name, expected in sorted(baseline.items()):
+        if name not in results:
+            failures.append(f"{name}: missing from the results")
+            continue
+        for counter, limit in expected.items():
+            got = results[name].get(counter)
+            allowed = limit * (1 + args.tolerance) + SLACK[counter]
+            if got is None:
+                failures.append(f"{name}: no {counter} counter")
+            elif got > allowed:
+                failures.append(f"{name}: {counter} {got:.2f} exceeds the "
+                                f"baseline {limit:.2f} by more than "
+                                f"{args.tolerance:.0%}")
+            else:
+                print(f"{name}: {counter} {got:.2f} (baseline {limit:.2f})")
+    for name in sorted(results.keys() - baseline.keys()):
+        print(f"{name}: not in the baseline")
+    for failure in failures:
+        print(failure, file=sys.stderr)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,134 @@
+"""Generates src/unicode_tables.cc from the Unicode Character Database.
+
+The properties come from Python's unicodedata module, so the tables follow
+the Unicode version of the Python that runs this script:
+
+    python3 scripts/generate_unicode_tables.py > src/unicode_tables.cc
+
+Every table is a two-level lookup: the code point shifted right by
+kTableShift picks a block in the index, and the low bits the entry in the
+block. Identical blocks are stored once.
+"""
+import sys
+import unicodedata
+
+# Must match kTableShift in include/tokenizers/unicode.h.
+TABLE_SHIFT = 7
+NUM_CODE_POINTS = 0x110000
+
+# In the order of ICU's UCharCategory, so values compare equal to u_charType.
+CATEGORIES = [
+    "Cn", "Lu", "Ll", "Lt", "Lm", "Lo", "Mn", "Me", "Mc", "Nd",
+    "Nl", "No", "Zs", "Zl", "Zp", "Cc", "Cf", "Co", "Cs", "Pd",
+    "Ps", "Pe", "Pc", "Po", "Sm", "Sc", "Sk", "So", "Pi", "Pf",
+]
+WHITE_SPACE_FLAG = 0x20
+
+# White_Space from PropList.txt, which unicodedata does not expose.
+WHITE_SPACE = [
+    (0x0009, 0x000D), (0x0020, 0x0020), (0x0085, 0x0085), (0x00A0, 0x00A0),
+    (0x1680, 0x1680), (0x2000, 0x200A), (0x2028, 0x2029), (0x202F, 0x202F),
+    (0x205F, 0x205F), (0x3000, 0x3000),
+]
+
+# Hangul syllables decompose algorithmically and are left out of the table.
+HANGUL_FIRST = 0xAC00
+HANGUL_LAST = 0xD7A3
+
+
+def two_level(name, ctype, values):
+    size = 1 << TABLE_SHIFT
+    last = max((i for i, v in enumerate(values) if v), default=0)
+    limit = (last // size + 1) * size
+    blocks = {}
+    index = []
+    data = []
+    for start in range(0, limit, size):
+        block = tuple(values[start:start + size])
+        if block not in blocks:
+            blocks[block] = len(blocks)
+            data.extend(block)
+        index.append(blocks[block])
+    assert len(blocks) < 1 << 16
+    lines = [
+        emit_array(f"k{name}Index", "uint16_t", index),
+        emit_array(f"k{name}Blocks", ctype, data),
+        f"const Table<{ctype}> k{name} = {{\n"
+        f"    0x{limit:X}, k{name}Index, k{name}Blocks}};\n",
+    ]
+    return "\n".join(lines)
+
+
+def emit_array(name, ctype, values):
+    lines = [f"const {ctype} {name}[] = {{"]
+    line = " "
+    for value in values:
+        item = f" {value},"
+        if len(line) + len(item) > 80:
+            lines.append(line)
+            line = " "
+        line += item
+    if line.strip():
+        lines.append(line)
+    lines.append("};\n")
+    return "\n".join(lines)
+
+
+def main():
+    categories = []
+    combining_classes = []
+    lowercase = []
+    deltas = [0]
+    decomposition_index = []
+    decompositions = [0]
+    for c in range(NUM_CODE_POINTS):
+        char = chr(c)
+        category = CATEGORIES.index(unicodedata.category(char))
+        if any(first <= c <= last for first, last in WHITE_SPACE):
+            category |= WHITE_SPACE_FLAG
+        categories.append(category)
+        combining_classes.append(unicodedata.combining(char))
+
+        # The simple mapping is the first code point of the full one, the
+        # only lowercase mapping longer than one is U+0130.
+        delta = ord(char.lower()[0]) - c
+        if delta not in deltas:
+            deltas.append(delta)
+        lowercase.append(deltas.index(delta))
+
+        decomposed = unicodedata.normalize("NFD", char)
+        if decomposed == char or HANGUL_FIRST <= c <= HANGUL_LAST:
+            decomposition_index.append(0)
+            continue
+        decomposition_index.append(len(decompositions))
+        decompositions.append(len(decomposed))
+        decompositions.extend(ord(d) for d in decomposed)
+    assert len(deltas) < 1 << 8 and len(decompositions) < 1 << 16
+
+    out = sys.stdout
+    out.write("// Copyright 2025 Omkar Prabhu\n")
+    out.write("// Generated by scripts/generate_unicode_tables.py, do not "
+              "edit.\n")
+    out.write('#include "tokenizers/unicode.h"\n\n')
+    out.write("#include <cstdint>\n\n")
+    out.write("namespace tokenizers {\n\nnamespace unicode {\n\n")
+    out.write("namespace tables {\n\n")
+    out.write(f'const char kUnicodeVersion[] = '
+              f'"{unicodedata.unidata_version}";\n\n')
+    out.write(two_level("Categories", "uint8_t", categories))
+    out.write("\n")
+    out.write(two_level("CombiningClasses", "uint8_t", combining_classes))
+    out.write("\n")
+    out.write(two_level("Lowercase", "uint8_t", lowercase))
+    out.write("\n")
+    out.write(emit_array("kLowercaseDeltas", "int32_t", deltas))
+    out.write("\n")
+    out.write(two_level("Decomposition", "uint16_t", decomposition_index))
+    out.write("\n")
+    out.write(emit_array("kDecompositions", "UChar32", decompositions))
+    out.write("\n} // namespace tables\n\n} // namespace unicode\n\n"
+              "} // namespace tokenizers\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,12 +1,16 @@
 // Copyright 2025 Omkar Prabhu
 #include "tokenizers/added_vocabulary.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "tokenizers/normalizer.h"
+#include "tokenizers/unicode.h"
 #include "tokenizers/utils.h"
 
 using tokenizers::normalizers::NormalizerResult;
@@ -39,28 +43,140 @@ AddedVocabulary::AddedVocabulary(const std::vector<AddedToken>& tokens) {
   for (const auto& token : tokens) {
     tokens_[token.id] = token;
     added_tokens_map_[token.content] = token.id;
-    added_tokens_map_r_[token.id] = token.content;
-    if (token.special_token) {
-      special_tokens_.insert(token.content);
-    }
     patterns_.emplace_back(icu::UnicodeString::fromUTF8(token.content));
+    const icu::UnicodeString& pattern = patterns_.back();
+    for (int i = 0; i < pattern.length() && !crosses_whitespace_; i++) {
+      crosses_whitespace_ = unicode::IsUWhiteSpace(pattern.charAt(i));
+    }
+    crosses_whitespace_ = crosses_whitespace_ || token.rstrip;
+    if (pattern.isEmpty())
+      continue;
+    char16_t unit = pattern.charAt(0);
+    if (unit < first_units_.size()) {
+      first_units_.set(unit);
+    } else {
+      wide_first_units_.emplace_back(unit);
+    }
+  }
+  std::sort(wide_first_units_.begin(), wide_first_units_.end());
+  wide_first_units_.erase(
+      std::unique(wide_first_units_.begin(), wide_first_units_.end()),
+      wide_first_units_.end());
+}
+
+bool AddedVocabulary::IsSpecialToken(std::string_view token) const {
+  const std::set<std::string, std::less<>>& special_tokens =
+      special_tokens_.Get([this](std::set<std::string, std::less<>>* tokens) {
+        for (const auto& [id, added_token] : tokens_) {
+          if (added_token.special_token)
+            tokens->insert(added_token.content);
+        }
+      });
+  return special_tokens.find(token) != special_tokens.end();
+}
+
+const AddedToken* AddedVocabulary::FindToken(
+    const icu::UnicodeString& split) const {
+  int start = 0;
+  int stop = split.length();
+  for (int strip = 0; strip < 2; strip++) {
+    std::string content;
+    split.tempSubStringBetween(start, stop).toUTF8String(content);
+    auto it = added_tokens_map_.find(content);
+    if (it != added_tokens_map_.end())
+      return &tokens_.at(it->second);
+    while (start < stop && unicode::IsUWhiteSpace(split.charAt(start))) {
+      ++start;
+    }
+    while (stop > start && unicode::IsUWhiteSpace(split.charAt(stop - 1))) {
+      --stop;
+    }
   }
+  return nullptr;
 }
 
-bool AddedVocabulary::IsSpecialToken(const std::string& token) {
-  return special_tokens_.find(token) != special_tokens_.end();
+const AddedToken* AddedVocabulary::FindToken(int id) const {
+  auto it = tokens_.find(id);
+  return it != tokens_.end() ? &it->second : nullptr;
+}
+
+bool AddedVocabulary::MayMatch(const icu::UnicodeString& input) const {
+  const char16_t* buffer = input.getBuffer();
+  int length = input.length();
+  for (int i = 0; i < length; i++) {
+    char16_t unit = buffer[i];
+    if (unit < first_units_.size()) {
+      if (first_units_.test(unit))
+        return true;
+    } else if (!wide_first_units_.empty() &&
+               std::binary_search(wide_first_units_.begin(),
+                                  wide_first_units_.end(), unit)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t AddedVocabulary::MemoryUsage() const {
+  size_t usage = sizeof(AddedVocabulary);
+  for (const auto& [name, bytes] : MemoryUsageByStructure()) usage += bytes;
+  return usage;
+}
+
+MemoryUsageMap AddedVocabulary::MemoryUsageByStructure() const {
+  size_t tokens = tokens_.bucket_count() * sizeof(void*);
+  for (const auto& [id, token] : tokens_) {
+    tokens += sizeof(std::pair<const int, AddedToken>) + 2 * sizeof(void*) +
+              HeapUsage(token.content);
+  }
+  size_t patterns = patterns_.capacity() * sizeof(icu::UnicodeString) +
+                    HeapUsage(wide_first_units_);
+  for (const icu::UnicodeString& pattern : patterns_) {
+    patterns += pattern.getCapacity() * sizeof(char16_t);
+  }
+  return {{"tokens", tokens},
+          {"token_ids", HeapUsage(added_tokens_map_)},
+          {"special_tokens", special_tokens_.MemoryUsage()},
+          {"patterns", patterns}};
 }
 
 std::vector<NormalizerResult> AddedVocabulary::FindSplits(
     const NormalizerResult& input) {
   std::vector<NormalizerResult> splits;
+  if (!MayMatch(input.normalized)) {
+    if (!input.normalized.isEmpty())
+      splits.emplace_back(input);
+    return splits;
+  }
   const icu::UnicodeString& input_normalized = input.normalized;
   const std::vector<std::pair<int, int>>& input_offsets = input.offsets;
+  // Matches are in code units while offsets hold one entry per code point.
+  // Slices move forward, so code points are counted from the last one.
+  int unit_cursor = 0;
+  int char_cursor = 0;
+  auto char_index = [&](int unit) {
+    if (unit < unit_cursor) {
+      return char_cursor - input_normalized.countChar32(unit,
+                                                        unit_cursor - unit);
+    }
+    char_cursor += input_normalized.countChar32(unit_cursor,
+                                                unit - unit_cursor);
+    unit_cursor = unit;
+    return char_cursor;
+  };
+  auto slice_offsets = [&](int start, int stop) {
+    if (input_offsets.empty())
+      return std::vector<std::pair<int, int>>();
+    int char_start = char_index(start);
+    int char_stop = char_index(stop);
+    return std::vector<std::pair<int, int>>(input_offsets.begin() + char_start,
+                                            input_offsets.begin() + char_stop);
+  };
 
   std::vector<std::pair<int, int>> matches =
       FindMatches(input_normalized, patterns_);
 
-  int total_len = input_normalized.countChar32();
+  int total_len = input_normalized.length();
   int start_offset = 0;
   for (const std::pair<int, int>& match : matches) {
     int start = match.first;
@@ -87,14 +203,15 @@ std::vector<NormalizerResult> AddedVocabulary::FindSplits(
     }
 
     if (token.lstrip) {
-      while (start > 0 && u_isUWhiteSpace(input_normalized.charAt(start - 1))) {
+      while (start > 0 &&
+             unicode::IsUWhiteSpace(input_normalized.charAt(start - 1))) {
         --start;
       }
     }
 
     if (token.rstrip) {
       while (stop < total_len &&
-             u_isUWhiteSpace(input_normalized.charAt(stop))) {
+             unicode::IsUWhiteSpace(input_normalized.charAt(stop))) {
         ++stop;
       }
     }
@@ -102,22 +219,18 @@ std::vector<NormalizerResult> AddedVocabulary::FindSplits(
     if (start_offset < start) {
       splits.emplace_back(NormalizerResult(
           input_normalized.tempSubStringBetween(start_offset, start),
-          std::vector<std::pair<int, int>>(input_offsets.begin() + start_offset,
-                                           input_offsets.begin() + start)));
+          slice_offsets(start_offset, start)));
     }
     splits.emplace_back(NormalizerResult(
         input_normalized.tempSubStringBetween(start, stop),
-        std::vector<std::pair<int, int>>(input_offsets.begin() + start,
-                                         input_offsets.begin() + stop),
-        token.special_token));
+        slice_offsets(start, stop), token.special_token));
     start_offset = stop;
   }
 
   if (start_offset < total_len) {
     splits.emplace_back(NormalizerResult(
         input_normalized.tempSubStringBetween(start_offset, total_len),
-        std::vector<std::pair<int, int>>(input_offsets.begin() + start_offset,
-                                         input_offsets.end())));
+        slice_offsets(start_offset, total_len)));
   }
 
   return splits;
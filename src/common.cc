@@ -1,7 +1,13 @@
 // Copyright 2025 Omkar Prabhu
 #include "tokenizers/common.h"
 
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -16,6 +22,34 @@ Encoding::Encoding()
       special_tokens_mask({}),
       attention_mask({}) {}
 
+Encoding::Encoding(std::pmr::memory_resource* resource)
+    : ids(resource),
+      type_ids(resource),
+      tokens(resource),
+      offsets(resource),
+      word_ids(resource),
+      special_tokens_mask(resource),
+      attention_mask(resource),
+      overflowing(resource) {}
+
+Encoding::Encoding(const Encoding& other)
+    : Encoding(other, other.resource()) {}
+
+Encoding::Encoding(const Encoding& other, std::pmr::memory_resource* resource)
+    : ids(other.ids, resource),
+      type_ids(other.type_ids, resource),
+      tokens(other.tokens, resource),
+      offsets(other.offsets, resource),
+      word_ids(other.word_ids, resource),
+      special_tokens_mask(other.special_tokens_mask, resource),
+      attention_mask(other.attention_mask, resource),
+      overflowing(resource) {
+  overflowing.reserve(other.overflowing.size());
+  for (const Encoding& encoding : other.overflowing) {
+    overflowing.emplace_back(encoding, resource);
+  }
+}
+
 Encoding::Encoding(const std::vector<int>& ids,
                    const std::vector<int>& type_ids,
                    const std::vector<std::string>& tokens,
@@ -23,13 +57,217 @@ Encoding::Encoding(const std::vector<int>& ids,
                    const std::vector<std::optional<int>>& word_ids,
                    const std::vector<int>& special_tokens_mask,
                    const std::vector<int>& attention_mask)
-    : ids(std::move(ids)),
-      type_ids(std::move(type_ids)),
-      tokens(std::move(tokens)),
-      offsets(std::move(offsets)),
-      word_ids(std::move(word_ids)),
-      special_tokens_mask(std::move(special_tokens_mask)),
-      attention_mask(std::move(attention_mask)) {}
+    : ids(ids.begin(), ids.end()),
+      type_ids(type_ids.begin(), type_ids.end()),
+      tokens(tokens.begin(), tokens.end()),
+      offsets(offsets.begin(), offsets.end()),
+      word_ids(word_ids.begin(), word_ids.end()),
+      special_tokens_mask(special_tokens_mask.begin(),
+                          special_tokens_mask.end()),
+      attention_mask(attention_mask.begin(), attention_mask.end()) {}
+
+void Encoding::Reserve(int length, EncodeOptions options) {
+  ids.reserve(length);
+  if (hasOption(options, EncodeOptions::kTypeIds))
+    type_ids.reserve(length);
+  if (hasOption(options, EncodeOptions::kTokens))
+    tokens.reserve(length);
+  if (hasOption(options, EncodeOptions::kOffsets))
+    offsets.reserve(length);
+  if (hasOption(options, EncodeOptions::kWordIds))
+    word_ids.reserve(length);
+  if (hasOption(options, EncodeOptions::kSpecialTokensMask))
+    special_tokens_mask.reserve(length);
+  if (hasOption(options, EncodeOptions::kAttentionMask))
+    attention_mask.reserve(length);
+}
+
+namespace {
+
+template <typename Vector>
+void appendField(Vector* output, Vector* input) {
+  output->insert(output->end(), std::make_move_iterator(input->begin()),
+                 std::make_move_iterator(input->end()));
+}
+
+} // namespace
+
+void Encoding::Append(Encoding&& other, EncodeOptions options) {
+  appendField(&ids, &other.ids);
+  if (hasOption(options, EncodeOptions::kTypeIds))
+    appendField(&type_ids, &other.type_ids);
+  if (hasOption(options, EncodeOptions::kTokens))
+    appendField(&tokens, &other.tokens);
+  if (hasOption(options, EncodeOptions::kOffsets))
+    appendField(&offsets, &other.offsets);
+  if (hasOption(options, EncodeOptions::kWordIds))
+    appendField(&word_ids, &other.word_ids);
+  if (hasOption(options, EncodeOptions::kSpecialTokensMask))
+    appendField(&special_tokens_mask, &other.special_tokens_mask);
+  if (hasOption(options, EncodeOptions::kAttentionMask))
+    appendField(&attention_mask, &other.attention_mask);
+}
+
+size_t Encoding::MemoryUsage() const {
+  size_t usage = ids.capacity() * sizeof(int) +
+                 type_ids.capacity() * sizeof(int) +
+                 tokens.capacity() * sizeof(std::pmr::string) +
+                 offsets.capacity() * sizeof(std::pair<int, int>) +
+                 word_ids.capacity() * sizeof(std::optional<int>) +
+                 special_tokens_mask.capacity() * sizeof(int) +
+                 attention_mask.capacity() * sizeof(int) +
+                 overflowing.capacity() * sizeof(Encoding);
+  // Short strings are stored inline, up to the capacity of an empty string.
+  static const size_t kInlineCapacity = std::pmr::string().capacity();
+  for (const std::pmr::string& token : tokens) {
+    if (token.capacity() > kInlineCapacity) {
+      usage += token.capacity() + 1;
+    }
+  }
+  for (const Encoding& encoding : overflowing) {
+    usage += encoding.MemoryUsage();
+  }
+  return usage;
+}
+
+Encoding ConcatEncodings(std::vector<Encoding> encodings, EncodeOptions options,
+                         std::pmr::memory_resource* resource) {
+  int length = 0;
+  for (const Encoding& encoding : encodings) {
+    length += encoding.ids.size();
+  }
+  Encoding result(resource);
+  result.Reserve(length, options);
+  for (Encoding& encoding : encodings) {
+    result.Append(std::move(encoding), options);
+  }
+  return result;
+}
+
+namespace {
+
+template <typename Vector>
+std::vector<uint64_t> packBits(const Vector& values) {
+  std::vector<uint64_t> bits((values.size() + 63) / 64, 0);
+  for (int i = 0; i < values.size(); i++) {
+    if (values[i]) bits[i >> 6] |= uint64_t{1} << (i & 63);
+  }
+  return bits;
+}
+
+} // namespace
+
+CompactEncoding::CompactEncoding() {}
+
+CompactEncoding::CompactEncoding(const Encoding& encoding)
+    : size_(encoding.ids.size()) {
+  // A field counts as produced when it has a value per token.
+  auto produced = [&](size_t field_size, EncodeOptions option) {
+    bool result = size_ > 0 && field_size == size_;
+    if (result) fields_ = fields_ | option;
+    return result;
+  };
+  bool narrow = true;
+  for (int id : encoding.ids) {
+    narrow = narrow && id >= 0 && id <= std::numeric_limits<uint16_t>::max();
+  }
+  if (narrow) {
+    narrow_ids_.assign(encoding.ids.begin(), encoding.ids.end());
+  } else {
+    wide_ids_.assign(encoding.ids.begin(), encoding.ids.end());
+  }
+  if (produced(encoding.type_ids.size(), EncodeOptions::kTypeIds)) {
+    type_ids_.reserve(size_);
+    for (int type_id : encoding.type_ids) {
+      if (type_id < 0 || type_id > std::numeric_limits<uint8_t>::max()) {
+        throw std::invalid_argument("type id " + std::to_string(type_id) +
+                                    " does not fit a compact encoding");
+      }
+      type_ids_.emplace_back(type_id);
+    }
+  }
+  if (produced(encoding.tokens.size(), EncodeOptions::kTokens)) {
+    size_t length = 0;
+    for (const std::pmr::string& token : encoding.tokens) {
+      length += token.size();
+    }
+    token_data_.reserve(length);
+    token_ends_.reserve(size_);
+    for (const std::pmr::string& token : encoding.tokens) {
+      token_data_.append(token);
+      token_ends_.emplace_back(token_data_.size());
+    }
+  }
+  if (produced(encoding.offsets.size(), EncodeOptions::kOffsets)) {
+    offsets_.assign(encoding.offsets.begin(), encoding.offsets.end());
+  }
+  if (produced(encoding.word_ids.size(), EncodeOptions::kWordIds)) {
+    word_ids_.reserve(size_);
+    for (const std::optional<int>& word_id : encoding.word_ids) {
+      word_ids_.emplace_back(word_id.value_or(kNoWord));
+    }
+  }
+  if (produced(encoding.special_tokens_mask.size(),
+               EncodeOptions::kSpecialTokensMask)) {
+    special_tokens_mask_ = packBits(encoding.special_tokens_mask);
+  }
+  if (produced(encoding.attention_mask.size(),
+               EncodeOptions::kAttentionMask)) {
+    attention_mask_ = packBits(encoding.attention_mask);
+  }
+  overflowing_.reserve(encoding.overflowing.size());
+  for (const Encoding& overflowing : encoding.overflowing) {
+    overflowing_.emplace_back(overflowing);
+  }
+}
+
+std::string_view CompactEncoding::token(int i) const {
+  uint32_t begin = i == 0 ? 0 : token_ends_[i - 1];
+  return std::string_view(token_data_).substr(begin, token_ends_[i] - begin);
+}
+
+std::optional<int> CompactEncoding::word_id(int i) const {
+  if (word_ids_[i] == kNoWord) return std::nullopt;
+  return word_ids_[i];
+}
+
+Encoding CompactEncoding::ToEncoding(
+    std::pmr::memory_resource* resource) const {
+  Encoding encoding(resource);
+  encoding.Reserve(size_, fields_);
+  for (int i = 0; i < size_; i++) {
+    encoding.ids.emplace_back(id(i));
+    if (hasOption(fields_, EncodeOptions::kTypeIds))
+      encoding.type_ids.emplace_back(type_ids_[i]);
+    if (hasOption(fields_, EncodeOptions::kTokens))
+      encoding.tokens.emplace_back(token(i));
+    if (hasOption(fields_, EncodeOptions::kOffsets))
+      encoding.offsets.emplace_back(offsets_[i]);
+    if (hasOption(fields_, EncodeOptions::kWordIds))
+      encoding.word_ids.emplace_back(word_id(i));
+    if (hasOption(fields_, EncodeOptions::kSpecialTokensMask))
+      encoding.special_tokens_mask.emplace_back(special_tokens_mask(i));
+    if (hasOption(fields_, EncodeOptions::kAttentionMask))
+      encoding.attention_mask.emplace_back(attention_mask(i));
+  }
+  for (const CompactEncoding& overflowing : overflowing_) {
+    encoding.overflowing.emplace_back(overflowing.ToEncoding(resource));
+  }
+  return encoding;
+}
+
+size_t CompactEncoding::MemoryUsage() const {
+  size_t usage = HeapUsage(narrow_ids_) + HeapUsage(wide_ids_) +
+                 HeapUsage(type_ids_) + HeapUsage(token_data_) +
+                 HeapUsage(token_ends_) + HeapUsage(offsets_) +
+                 HeapUsage(word_ids_) + HeapUsage(special_tokens_mask_) +
+                 HeapUsage(attention_mask_) +
+                 overflowing_.capacity() * sizeof(CompactEncoding);
+  for (const CompactEncoding& overflowing : overflowing_) {
+    usage += overflowing.MemoryUsage();
+  }
+  return usage;
+}
 
 Token::Token()
     : value(""), id(0), offsets({0, 0}), is_continuing_subword(false) {}
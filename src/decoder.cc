@@ -1,9 +1,18 @@
 // Copyright 2025 Omkar Prabhu
 #include "tokenizers/decoder.h"
 
+#include <unicode/utf8.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "tokenizers/pre_tokenizer.h"
+
 namespace tokenizers {
 
 namespace decoders {
@@ -15,6 +24,14 @@ std::vector<std::string> Decoder::DecodeChain(
   return {};
 }
 
+void Decoder::Decode(const std::vector<std::string_view>& tokens,
+                     std::string* out) {
+  for (const std::string& token :
+       DecodeChain(std::vector<std::string>(tokens.begin(), tokens.end()))) {
+    out->append(token);
+  }
+}
+
 WordPieceDecoder::WordPieceDecoder(const std::string& prefix, bool cleanup)
     : prefix_(prefix), cleanup_(cleanup) {}
 
@@ -29,18 +46,39 @@ void replace(std::string& input, const std::string& from,
   }
 }
 
+namespace {
+
+// Replacements of doCleanup, in the order they are applied.
+const std::pair<const char*, const char*> kCleanupPatterns[] = {
+    {" .", "."},     {" ?", "?"},     {" !", "!"},
+    {" ,", ","},     {" ' ", "'"},    {" n't", "n't"},
+    {" 'm", "'m"},   {" do not", "don't"},
+    {" 's", "'s"},   {" 've", "'ve"}, {" 're", "'re"},
+};
+
+// The characters that follow the leading space of the cleanup patterns, or
+// nullopt when a pattern does not start with a space.
+const std::optional<std::string>& cleanupFirstChars() {
+  static const std::optional<std::string> chars =
+      []() -> std::optional<std::string> {
+    std::string result;
+    for (const auto& [from, to] : kCleanupPatterns) {
+      std::string_view pattern(from);
+      if (pattern.size() < 2 || pattern[0] != ' ')
+        return std::nullopt;
+      result.push_back(pattern[1]);
+    }
+    return result;
+  }();
+  return chars;
+}
+
+} // namespace
+
 void doCleanup(std::string* input) {
-  replace(*input, " .", ".");
-  replace(*input, " ?", "?");
-  replace(*input, " !", "!");
-  replace(*input, " ,", ",");
-  replace(*input, " ' ", "'");
-  replace(*input, " n't", "n't");
-  replace(*input, " 'm", "'m");
-  replace(*input, " do not", "don't");
-  replace(*input, " 's", "'s");
-  replace(*input, " 've", "'ve");
-  replace(*input, " 're", "'re");
+  for (const auto& [from, to] : kCleanupPatterns) {
+    replace(*input, from, to);
+  }
 }
 
 std::vector<std::string> WordPieceDecoder::DecodeChain(
@@ -61,6 +99,132 @@ std::vector<std::string> WordPieceDecoder::DecodeChain(
   return tokens;
 }
 
+void WordPieceDecoder::Decode(const std::vector<std::string_view>& tokens,
+                              std::string* out) {
+  std::string piece;
+  for (int i = 0; i < tokens.size(); i++) {
+    std::string_view token = tokens[i];
+    bool space = false;
+    if (i != 0) {
+      if (token.substr(0, prefix_.size()) == prefix_) {
+        token.remove_prefix(prefix_.size());
+      } else {
+        space = true;
+      }
+    }
+    // When every cleanup pattern starts with a space, a token without
+    // spaces only goes through doCleanup when the space put before it is
+    // followed by the second character of a pattern.
+    const std::optional<std::string>& first_chars = cleanupFirstChars();
+    bool may_clean =
+        !first_chars || token.find(' ') != std::string_view::npos ||
+        (space && !token.empty() &&
+         first_chars->find(token[0]) != std::string::npos);
+    if (!cleanup_ || !may_clean) {
+      if (space)
+        out->push_back(' ');
+      out->append(token);
+      continue;
+    }
+    piece.assign(space ? " " : "");
+    piece.append(token);
+    doCleanup(&piece);
+    out->append(piece);
+  }
+}
+
+Metaspace::Metaspace(const std::string& replacement, bool add_prefix_space)
+    : replacement_(replacement), add_prefix_space_(add_prefix_space) {}
+
+std::vector<std::string> Metaspace::DecodeChain(
+    std::vector<std::string> tokens) {
+  for (int i = 0; i < tokens.size(); i++) {
+    const std::string& token = tokens[i];
+    std::string decoded;
+    decoded.reserve(token.size());
+    size_t pos = 0;
+    while (pos < token.size()) {
+      if (!replacement_.empty() &&
+          token.compare(pos, replacement_.size(), replacement_) == 0) {
+        // The prefix added when encoding is dropped from the first token.
+        if (!(i == 0 && pos == 0 && add_prefix_space_)) {
+          decoded.push_back(' ');
+        }
+        pos += replacement_.size();
+      } else {
+        decoded.push_back(token[pos]);
+        pos++;
+      }
+    }
+    tokens[i] = std::move(decoded);
+  }
+  return tokens;
+}
+
+void Metaspace::Decode(const std::vector<std::string_view>& tokens,
+                       std::string* out) {
+  for (int i = 0; i < tokens.size(); i++) {
+    std::string_view token = tokens[i];
+    size_t pos = 0;
+    while (pos < token.size()) {
+      if (!replacement_.empty() &&
+          token.compare(pos, replacement_.size(), replacement_) == 0) {
+        if (!(i == 0 && pos == 0 && add_prefix_space_)) {
+          out->push_back(' ');
+        }
+        pos += replacement_.size();
+      } else {
+        out->push_back(token[pos]);
+        pos++;
+      }
+    }
+  }
+}
+
+ByteLevel::ByteLevel() {}
+
+// The byte each code point of the ByteLevel pre-tokenizer alphabet stands
+// for, -1 for the others.
+static int unicodeToByte(UChar32 c) {
+  static const std::array<int16_t, 512> table = [] {
+    std::array<int16_t, 512> bytes;
+    bytes.fill(-1);
+    for (int b = 0; b < 256; b++) {
+      bytes[pre_tokenizers::byteToUnicode(b)] = b;
+    }
+    return bytes;
+  }();
+  return c >= 0 && c < table.size() ? table[c] : -1;
+}
+
+std::vector<std::string> ByteLevel::DecodeChain(
+    std::vector<std::string> tokens) {
+  std::string decoded;
+  Decode(std::vector<std::string_view>(tokens.begin(), tokens.end()),
+         &decoded);
+  return {decoded};
+}
+
+void ByteLevel::Decode(const std::vector<std::string_view>& tokens,
+                       std::string* out) {
+  for (std::string_view token : tokens) {
+    int pos = 0;
+    int length = token.size();
+    while (pos < length) {
+      int start = pos;
+      UChar32 c;
+      U8_NEXT(token.data(), pos, length, c);
+      int byte = unicodeToByte(c);
+      // Characters outside the alphabet, such as added tokens, are kept.
+      if (byte < 0) {
+        out->append(token.substr(start, pos - start));
+      } else {
+        out->push_back(static_cast<char>(byte));
+      }
+    }
+  }
+}
+
 } // namespace decoders
 
 } // namespace tokenizers
@@ -0,0 +1,149 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/executor.h"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tokenizers {
+
+namespace {
+
+// The executor whose tasks the current thread is running, if any.
+thread_local const WorkStealingExecutor* running_executor = nullptr;
+
+} // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (int i = 0; i < num_threads; i++) {
+    queues_.emplace_back(std::make_unique<Queue>());
+  }
+  // Worker 0 is the thread calling Run.
+  for (int i = 1; i < num_threads; i++) {
+    threads_.emplace_back([this, i]() { WorkerLoop(i); });
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+WorkStealingExecutor& WorkStealingExecutor::Default() {
+  static WorkStealingExecutor executor;
+  return executor;
+}
+
+void WorkStealingExecutor::Run(std::vector<std::function<void()>> tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  // A task running Run on its own executor would wait on run_mutex_ held
+  // by the run it belongs to, so nested tasks run in place instead.
+  if (threads_.empty() || running_executor == this) {
+    for (std::function<void()>& task : tasks) {
+      task();
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+  // Workers still leaving the previous run may pick up these tasks, so the
+  // count and the error have to be reset before they are dealt.
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    error_ = nullptr;
+  }
+  pending_.store(tasks.size());
+  for (int i = 0; i < tasks.size(); i++) {
+    Queue& queue = *queues_[i % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.emplace_back(std::move(tasks[i]));
+  }
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    generation_++;
+  }
+  wake_.notify_all();
+  running_executor = this;
+  Work(0);
+  running_executor = nullptr;
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  done_.wait(lock, [this]() { return pending_.load() == 0; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+bool WorkStealingExecutor::PopOrSteal(int worker,
+                                      std::function<void()>* task) {
+  for (int i = 0; i < queues_.size(); i++) {
+    Queue& queue = *queues_[(worker + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+    // The owner takes from the front and thieves from the back, so they
+    // only meet on the last task.
+    if (i == 0) {
+      *task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    } else {
+      *task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingExecutor::Work(int worker) {
+  // All tasks are dealt before the workers wake, so once every queue is
+  // empty there is nothing left to steal.
+  std::function<void()> task;
+  while (PopOrSteal(worker, &task)) {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+    task = nullptr;
+    if (pending_.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      done_.notify_all();
+    }
+  }
+}
+
+void WorkStealingExecutor::WorkerLoop(int worker) {
+  running_executor = this;
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(state_mutex_);
+      wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+    }
+    Work(worker);
+  }
+}
+
+} // namespace tokenizers
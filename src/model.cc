@@ -1,10 +1,25 @@
 // Copyright 2025 Omkar Prabhu
 #include "tokenizers/model.h"
 
+#include <unicode/schriter.h>
 #include <unicode/unistr.h>
+#include <unicode/utf16.h>
+#include <unicode/utf8.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -28,12 +43,28 @@ std::vector<Token> Model::TokenizeString(const std::string& input) {
   return {};
 }
 
+size_t Model::CountTokens(const icu::UnicodeString& input) {
+  return Tokenize(input).size();
+}
+
 std::optional<std::string> Model::IdToToken(int id) { return std::nullopt; }
 
+std::optional<std::string_view> Model::IdToTokenView(int id) {
+  return std::nullopt;
+}
+
 std::optional<int> Model::TokenToId(const std::string& token) {
   return std::nullopt;
 }
 
+std::optional<int> Model::UnkTokenId() { return std::nullopt; }
+
+size_t Model::MemoryUsage() { return sizeof(Model); }
+
+MemoryUsageMap Model::MemoryUsageByStructure() { return {}; }
+
+int Model::BuiltTables() { return 0; }
+
 WordPiece::WordPiece(const std::unordered_map<std::string, int>& vocab,
                      const std::string& unk_token,
                      const std::string& continuing_subword_prefix,
@@ -43,70 +74,381 @@ WordPiece::WordPiece(const std::unordered_map<std::string, int>& vocab,
       continuing_subword_prefix_(continuing_subword_prefix),
       max_input_chars_per_word_(max_input_chars_per_word) {
   for (const auto& pair : vocab_) {
-    rvocab_[pair.second] = pair.first;
+    max_piece_length_ =
+        std::max(max_piece_length_,
+                 icu::UnicodeString::fromUTF8(pair.first).length());
+  }
+}
+
+int WordPiece::LongestMatch(const icu::UnicodeString& input, int start,
+                            std::string* piece, int* id) const {
+  // Positions are in code units, like the offsets of the other models.
+  int end = input.length();
+  if (end - start > max_piece_length_) {
+    end = input.getChar32Start(start + max_piece_length_);
   }
+  for (; end > start; end = input.moveIndex32(end, -1)) {
+    piece->clear();
+    if (start > 0) {
+      piece->append(continuing_subword_prefix_);
+    }
+    input.tempSubStringBetween(start, end).toUTF8String(*piece);
+    auto it = vocab_.find(*piece);
+    if (it != vocab_.end()) {
+      *id = it->second;
+      return end;
+    }
+  }
+  return -1;
 }
 
 std::vector<Token> WordPiece::Tokenize(const icu::UnicodeString& input,
                                        const std::pair<int, int>& offset) {
-  int input_len = input.countChar32();
-  if (input_len > max_input_chars_per_word_) {
+  if (input.countChar32() > max_input_chars_per_word_) {
     return {Token(unk_token_, vocab_.at(unk_token_), offset, false)};
   }
 
+  int input_len = input.length();
   std::vector<Token> tokens;
+  std::string piece;
   int start = 0;
-  bool is_bad = false;
-
   while (start < input_len) {
-    int end = input_len;
-    bool found = false;
+    int id;
+    int end = LongestMatch(input, start, &piece, &id);
+    if (end < 0) {
+      tokens.emplace_back(
+          Token(unk_token_, vocab_.at(unk_token_),
+                {offset.first + start, offset.first + input_len}, false));
+      break;
+    }
+    tokens.emplace_back(Token(piece, id,
+                              {offset.first + start, offset.first + end},
+                              start > 0));
+    start = end;
+  }
+  return tokens;
+}
+
+size_t WordPiece::CountTokens(const icu::UnicodeString& input) {
+  if (input.countChar32() > max_input_chars_per_word_)
+    return 1;
+  size_t count = 0;
+  std::string piece;
+  for (int start = 0; start < input.length(); count++) {
+    int id;
+    start = LongestMatch(input, start, &piece, &id);
+    if (start < 0)
+      return count + 1;
+  }
+  return count;
+}
+
+std::vector<Token> WordPiece::Tokenize(const icu::UnicodeString& input) {
+  return Tokenize(input, {0, input.length()});
+}
+
+std::vector<Token> WordPiece::TokenizeString(const std::string& input) {
+  icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+  return Tokenize(unicode_input);
+}
+
+const std::unordered_map<int, std::string>& WordPiece::ReverseVocab() const {
+  return rvocab_.Get([this](std::unordered_map<int, std::string>* rvocab) {
+    rvocab->reserve(vocab_.size());
+    for (const auto& pair : vocab_) {
+      (*rvocab)[pair.second] = pair.first;
+    }
+  });
+}
+
+std::optional<std::string> WordPiece::IdToToken(int id) {
+  const std::unordered_map<int, std::string>& rvocab = ReverseVocab();
+  auto it = rvocab.find(id);
+  if (it != rvocab.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> WordPiece::IdToTokenView(int id) {
+  const std::unordered_map<int, std::string>& rvocab = ReverseVocab();
+  auto it = rvocab.find(id);
+  if (it != rvocab.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<int> WordPiece::TokenToId(const std::string& token) {
+  auto it = vocab_.find(token);
+  if (it != vocab_.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<int> WordPiece::UnkTokenId() { return TokenToId(unk_token_); }
+
+size_t WordPiece::MemoryUsage() {
+  size_t usage = sizeof(WordPiece) + HeapUsage(unk_token_) +
+                 HeapUsage(continuing_subword_prefix_);
+  for (const auto& [name, bytes] : MemoryUsageByStructure()) usage += bytes;
+  return usage;
+}
+
+MemoryUsageMap WordPiece::MemoryUsageByStructure() {
+  return {{"vocab", HeapUsage(vocab_)},
+          {"reverse_vocab", rvocab_.MemoryUsage()}};
+}
+
+int WordPiece::BuiltTables() { return rvocab_.built(); }
+
+BPE::BPE(const std::unordered_map<std::string, int>& vocab,
+         const std::vector<std::pair<std::string, std::string>>& merges,
+         const std::string& unk_token,
+         const std::string& continuing_subword_prefix,
+         const std::string& end_of_word_suffix, bool fuse_unk,
+         bool byte_fallback, bool ignore_merges, int cache_capacity)
+    : vocab_(vocab),
+      unk_token_(unk_token),
+      continuing_subword_prefix_(continuing_subword_prefix),
+      end_of_word_suffix_(end_of_word_suffix),
+      fuse_unk_(fuse_unk),
+      byte_fallback_(byte_fallback),
+      ignore_merges_(ignore_merges),
+      cache_capacity_(cache_capacity) {
+  for (const auto& pair : vocab_) {
+    rvocab_[pair.second] = pair.first;
+  }
+  merges_.reserve(merges.size());
+  int prefix_len = continuing_subword_prefix_.size();
+  for (int rank = 0; rank < merges.size(); rank++) {
+    const std::string& left = merges[rank].first;
+    const std::string& right = merges[rank].second;
+    auto left_it = vocab_.find(left);
+    auto right_it = vocab_.find(right);
+    if (left_it == vocab_.end() || right_it == vocab_.end()) {
+      throw std::invalid_argument("merge token out of vocabulary: " + left +
+                                  " " + right);
+    }
+    std::string merged =
+        prefix_len > 0 && right.rfind(continuing_subword_prefix_, 0) == 0
+            ? left + right.substr(prefix_len)
+            : left + right;
+    auto merged_it = vocab_.find(merged);
+    if (merged_it == vocab_.end()) {
+      throw std::invalid_argument("merged token out of vocabulary: " + merged);
+    }
+    uint64_t key = static_cast<uint64_t>(left_it->second) << 32 |
+                   static_cast<uint32_t>(right_it->second);
+    merges_.emplace(key, std::make_pair(rank, merged_it->second));
+  }
+}
+
+// Applies the merges of lowest rank first using a min-heap over the pairs
+// of a doubly linked list of symbols, which keeps a word at O(n log n).
+// Returns the id and range of every resulting symbol. Characters without a
+// token are dropped, leaving a gap in the ranges.
+std::vector<BPE::MergedSymbol> BPE::MergeWord(
+    const icu::UnicodeString& input) {
+  std::vector<Symbol> symbols;
+  symbols.reserve(input.length());
+  auto unk_it = vocab_.find(unk_token_);
+  bool pending_unk = false;
+  icu::StringCharacterIterator it(input);
+  for (it.first(); it.hasNext();) {
+    int start = it.getIndex();
+    bool is_first = start == 0;
+    UChar32 c = it.next32PostInc();
+    bool is_last = !it.hasNext();
+    int len = U16_LENGTH(c);
+    std::string piece;
+    icu::UnicodeString(c).toUTF8String(piece);
+    std::string token = piece;
+    if (!is_first) {
+      token = continuing_subword_prefix_ + token;
+    }
+    if (is_last) {
+      token += end_of_word_suffix_;
+    }
 
-    while (start < end) {
-      icu::UnicodeString input_substr = input.tempSubStringBetween(start, end);
-      std::string input_substr_str;
-      input_substr.toUTF8String(input_substr_str);
+    auto token_it = vocab_.find(token);
+    if (token_it != vocab_.end()) {
+      symbols.push_back({token_it->second, 0, 0, start, start + len});
+      pending_unk = false;
+      continue;
+    }
 
-      if (start > 0) {
-        input_substr_str = continuing_subword_prefix_ + input_substr_str;
+    if (byte_fallback_) {
+      std::vector<int> byte_ids;
+      for (unsigned char byte : piece) {
+        char byte_token[7];
+        std::snprintf(byte_token, sizeof(byte_token), "<0x%02X>", byte);
+        auto byte_it = vocab_.find(byte_token);
+        if (byte_it == vocab_.end()) {
+          byte_ids.clear();
+          break;
+        }
+        byte_ids.emplace_back(byte_it->second);
       }
-      if (vocab_.find(input_substr_str) != vocab_.end()) {
-        tokens.emplace_back(Token(input_substr_str, vocab_.at(input_substr_str),
-                                  {offset.first + start, offset.first + end},
-                                  start > 0 ? true : false));
-        found = true;
-        break;
+      if (!byte_ids.empty()) {
+        // Every byte covers the whole character, as in Unigram.
+        for (int byte_id : byte_ids) {
+          symbols.push_back({byte_id, 0, 0, start, start + len});
+        }
+        pending_unk = false;
+        continue;
       }
+    }
 
-      end -= 1;
+    if (unk_it == vocab_.end()) {
+      continue;
+    }
+    if (fuse_unk_ && pending_unk) {
+      symbols.back().end = start + len;
+    } else {
+      symbols.push_back({unk_it->second, 0, 0, start, start + len});
     }
+    pending_unk = true;
+  }
 
-    if (!found) {
-      is_bad = true;
-      break;
+  int num_symbols = symbols.size();
+  for (int i = 0; i < num_symbols; i++) {
+    symbols[i].prev = i - 1;
+    symbols[i].next = i + 1 < num_symbols ? i + 1 : -1;
+  }
+
+  // (rank, position, merged id), smallest rank and then leftmost first
+  using Merge = std::tuple<int, int, int>;
+  std::priority_queue<Merge, std::vector<Merge>, std::greater<Merge>> queue;
+  auto push_pair = [&](int pos) {
+    if (pos < 0 || symbols[pos].next < 0)
+      return;
+    uint64_t key = static_cast<uint64_t>(symbols[pos].id) << 32 |
+                   static_cast<uint32_t>(symbols[symbols[pos].next].id);
+    auto merge_it = merges_.find(key);
+    if (merge_it != merges_.end()) {
+      queue.emplace(merge_it->second.first, pos, merge_it->second.second);
+    }
+  };
+  for (int i = 0; i + 1 < num_symbols; i++) {
+    push_pair(i);
+  }
+
+  std::vector<bool> removed(num_symbols, false);
+  while (!queue.empty()) {
+    auto [rank, pos, merged_id] = queue.top();
+    queue.pop();
+    if (removed[pos] || symbols[pos].next < 0)
+      continue;
+    int next = symbols[pos].next;
+    uint64_t key = static_cast<uint64_t>(symbols[pos].id) << 32 |
+                   static_cast<uint32_t>(symbols[next].id);
+    auto merge_it = merges_.find(key);
+    // Stale entry, one side of the pair has been merged since.
+    if (merge_it == merges_.end() || merge_it->second.first != rank)
+      continue;
+
+    symbols[pos].id = merged_id;
+    symbols[pos].end = symbols[next].end;
+    symbols[pos].next = symbols[next].next;
+    if (symbols[pos].next >= 0) {
+      symbols[symbols[pos].next].prev = pos;
+    }
+    removed[next] = true;
+
+    push_pair(symbols[pos].prev);
+    push_pair(pos);
+  }
+
+  std::vector<MergedSymbol> result;
+  for (int i = 0; i < num_symbols; i++) {
+    if (!removed[i]) {
+      result.emplace_back(symbols[i].id,
+                          std::make_pair(symbols[i].start, symbols[i].end));
     }
-    start = end;
   }
+  return result;
+}
+
+std::vector<Token> BPE::Tokenize(const icu::UnicodeString& input,
+                                 const std::pair<int, int>& offset) {
+  std::string word;
+  input.toUTF8String(word);
 
-  if (is_bad) {
-    tokens.emplace_back(Token(unk_token_, vocab_.at(unk_token_),
-                              {offset.first + start, offset.first + input_len},
-                              false));
+  if (ignore_merges_) {
+    auto it = vocab_.find(word);
+    if (it != vocab_.end()) {
+      return {Token(word, it->second,
+                    {offset.first, offset.first + input.length()}, false)};
+    }
   }
 
+  std::vector<MergedSymbol> symbols;
+  bool cached = false;
+  if (cache_capacity_ > 0) {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    auto it = cache_.find(word);
+    if (it != cache_.end()) {
+      symbols = it->second;
+      cached = true;
+    }
+  }
+  if (!cached) {
+    symbols = MergeWord(input);
+    if (cache_capacity_ > 0) {
+      std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+      if (cache_.size() < cache_capacity_) {
+        cache_.emplace(word, symbols);
+      }
+    }
+  }
+
+  std::vector<Token> tokens;
+  tokens.reserve(symbols.size());
+  for (int i = 0; i < symbols.size(); i++) {
+    auto [id, range] = symbols[i];
+    tokens.emplace_back(Token(
+        rvocab_.at(id), id,
+        {offset.first + range.first, offset.first + range.second}, i > 0));
+  }
   return tokens;
 }
 
-std::vector<Token> WordPiece::Tokenize(const icu::UnicodeString& input) {
-  return Tokenize(input, {0, input.countChar32()});
+// Same as Tokenize, counting the symbols of the cached word when there is
+// one rather than copying them.
+size_t BPE::CountTokens(const icu::UnicodeString& input) {
+  std::string word;
+  input.toUTF8String(word);
+  if (ignore_merges_ && vocab_.find(word) != vocab_.end())
+    return 1;
+  if (cache_capacity_ > 0) {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    auto it = cache_.find(word);
+    if (it != cache_.end())
+      return it->second.size();
+  }
+  std::vector<MergedSymbol> symbols = MergeWord(input);
+  size_t count = symbols.size();
+  if (cache_capacity_ > 0) {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+    if (cache_.size() < cache_capacity_) {
+      cache_.emplace(word, std::move(symbols));
+    }
+  }
+  return count;
 }
 
-std::vector<Token> WordPiece::TokenizeString(const std::string& input) {
+std::vector<Token> BPE::Tokenize(const icu::UnicodeString& input) {
+  return Tokenize(input, {0, input.length()});
+}
+
+std::vector<Token> BPE::TokenizeString(const std::string& input) {
   icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
   return Tokenize(unicode_input);
 }
 
-std::optional<std::string> WordPiece::IdToToken(int id) {
+std::optional<std::string> BPE::IdToToken(int id) {
   auto it = rvocab_.find(id);
   if (it != rvocab_.end()) {
     return it->second;
@@ -114,7 +456,15 @@ std::optional<std::string> WordPiece::IdToToken(int id) {
   return std::nullopt;
 }
 
-std::optional<int> WordPiece::TokenToId(const std::string& token) {
+std::optional<std::string_view> BPE::IdToTokenView(int id) {
+  auto it = rvocab_.find(id);
+  if (it != rvocab_.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<int> BPE::TokenToId(const std::string& token) {
   auto it = vocab_.find(token);
   if (it != vocab_.end()) {
     return it->second;
@@ -122,6 +472,299 @@ std::optional<int> WordPiece::TokenToId(const std::string& token) {
   return std::nullopt;
 }
 
+std::optional<int> BPE::UnkTokenId() {
+  if (unk_token_.empty()) {
+    return std::nullopt;
+  }
+  return TokenToId(unk_token_);
+}
+
+size_t BPE::MemoryUsage() {
+  size_t usage = sizeof(BPE) + HeapUsage(unk_token_) +
+                 HeapUsage(continuing_subword_prefix_) +
+                 HeapUsage(end_of_word_suffix_);
+  for (const auto& [name, bytes] : MemoryUsageByStructure()) usage += bytes;
+  return usage;
+}
+
+MemoryUsageMap BPE::MemoryUsageByStructure() {
+  MemoryUsageMap usage = {{"vocab", HeapUsage(vocab_)},
+                          {"reverse_vocab", HeapUsage(rvocab_)},
+                          {"merges", HeapUsage(merges_)}};
+  std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+  usage["cache"] = HeapUsage(cache_);
+  return usage;
+}
+
+Unigram::Unigram(const std::vector<std::pair<std::string, double>>& vocab,
+                 int unk_id, bool byte_fallback)
+    : vocab_(vocab),
+      unk_id_(unk_id),
+      byte_fallback_(byte_fallback),
+      unk_score_(0.0) {
+  if (unk_id_ >= static_cast<int>(vocab_.size())) {
+    throw std::invalid_argument("unk_id is out of vocabulary");
+  }
+  double min_score = std::numeric_limits<double>::max();
+  for (int id = 0; id < vocab_.size(); id++) {
+    min_score = std::min(min_score, vocab_[id].second);
+  }
+  // Same penalty as sentencepiece for falling back to the unknown piece.
+  unk_score_ = vocab_.empty() ? 0.0 : min_score - 10.0;
+
+  BuildTrie();
+  byte_ids_.assign(256, -1);
+  if (byte_fallback_) {
+    for (int byte = 0; byte < 256; byte++) {
+      char byte_token[7];
+      std::snprintf(byte_token, sizeof(byte_token), "<0x%02X>", byte);
+      byte_ids_[byte] = FindPiece(byte_token);
+    }
+  }
+}
+
+void Unigram::BuildTrie() {
+  std::vector<std::map<unsigned char, int>> children(1);
+  std::vector<int> ids(1, -1);
+  for (int id = 0; id < vocab_.size(); id++) {
+    int node = 0;
+    for (unsigned char byte : vocab_[id].first) {
+      auto it = children[node].find(byte);
+      if (it == children[node].end()) {
+        children[node][byte] = children.size();
+        node = children.size();
+        children.emplace_back();
+        ids.emplace_back(-1);
+      } else {
+        node = it->second;
+      }
+    }
+    if (node != 0 && ids[node] == -1) {
+      ids[node] = id;
+    }
+  }
+
+  trie_nodes_.reserve(children.size());
+  trie_edges_.reserve(children.size() - 1);
+  for (int node = 0; node < children.size(); node++) {
+    int edges_begin = trie_edges_.size();
+    for (const auto& [byte, child] : children[node]) {
+      trie_edges_.push_back({byte, child});
+    }
+    trie_nodes_.push_back(
+        {ids[node], edges_begin, static_cast<int>(trie_edges_.size())});
+  }
+}
+
+int Unigram::FindChild(int node, unsigned char byte) const {
+  auto begin = trie_edges_.begin() + trie_nodes_[node].edges_begin;
+  auto end = trie_edges_.begin() + trie_nodes_[node].edges_end;
+  auto it = std::lower_bound(
+      begin, end, byte,
+      [](const TrieEdge& edge, unsigned char b) { return edge.byte < b; });
+  return it != end && it->byte == byte ? it->child : -1;
+}
+
+int Unigram::FindPiece(std::string_view piece) const {
+  if (piece.empty())
+    return -1;
+  int node = 0;
+  for (unsigned char byte : piece) {
+    node = FindChild(node, byte);
+    if (node < 0)
+      return -1;
+  }
+  return trie_nodes_[node].id;
+}
+
+namespace {
+
+// Viterbi lattice indexed by character position. Kept per thread and only
+// ever grown, so steady-state tokenization does not allocate for it.
+struct Lattice {
+  std::vector<int> char_at_byte;
+  std::vector<int> byte_starts;
+  std::vector<int> unit_starts;
+  std::vector<double> best_score;
+  std::vector<int> best_prev;
+  std::vector<int> best_id;
+  std::vector<int> path;
+};
+
+thread_local Lattice lattice;
+
+} // namespace
+
+std::vector<Token> Unigram::Tokenize(const icu::UnicodeString& input,
+                                     const std::pair<int, int>& offset) {
+  std::string word;
+  input.toUTF8String(word);
+  if (word.empty()) {
+    return {};
+  }
+
+  // Character boundaries in UTF-8 bytes and in UTF-16 code units.
+  lattice.char_at_byte.assign(word.size() + 1, -1);
+  lattice.byte_starts.clear();
+  lattice.unit_starts.clear();
+  int unit = 0;
+  icu::StringCharacterIterator it(input);
+  int byte = 0;
+  for (it.first(); it.hasNext();) {
+    UChar32 c = it.next32PostInc();
+    lattice.char_at_byte[byte] = lattice.byte_starts.size();
+    lattice.byte_starts.emplace_back(byte);
+    lattice.unit_starts.emplace_back(unit);
+    byte += U8_LENGTH(c);
+    unit += U16_LENGTH(c);
+  }
+  int num_chars = lattice.byte_starts.size();
+  lattice.char_at_byte[word.size()] = num_chars;
+  lattice.byte_starts.emplace_back(word.size());
+  lattice.unit_starts.emplace_back(unit);
+
+  lattice.best_score.assign(num_chars + 1,
+                            -std::numeric_limits<double>::infinity());
+  lattice.best_prev.assign(num_chars + 1, -1);
+  lattice.best_id.assign(num_chars + 1, -1);
+  lattice.best_score[0] = 0.0;
+
+  for (int start = 0; start < num_chars; start++) {
+    double start_score = lattice.best_score[start];
+    if (start_score == -std::numeric_limits<double>::infinity())
+      continue;
+    bool has_single_char = false;
+    int node = 0;
+    for (int b = lattice.byte_starts[start]; b < word.size(); b++) {
+      node = FindChild(node, static_cast<unsigned char>(word[b]));
+      if (node < 0)
+        break;
+      int end = lattice.char_at_byte[b + 1];
+      int id = trie_nodes_[node].id;
+      if (end < 0 || id < 0)
+        continue;
+      if (end == start + 1) {
+        has_single_char = true;
+      }
+      double score = start_score + vocab_[id].second;
+      if (score > lattice.best_score[end]) {
+        lattice.best_score[end] = score;
+        lattice.best_prev[end] = start;
+        lattice.best_id[end] = id;
+      }
+    }
+    if (!has_single_char) {
+      double score = start_score + unk_score_;
+      if (score > lattice.best_score[start + 1]) {
+        lattice.best_score[start + 1] = score;
+        lattice.best_prev[start + 1] = start;
+        lattice.best_id[start + 1] = unk_id_;
+      }
+    }
+  }
+
+  lattice.path.clear();
+  for (int end = num_chars; end > 0; end = lattice.best_prev[end]) {
+    lattice.path.emplace_back(end);
+  }
+  std::reverse(lattice.path.begin(), lattice.path.end());
+
+  std::vector<Token> tokens;
+  tokens.reserve(lattice.path.size());
+  int start = 0;
+  for (int i = 0; i < lattice.path.size(); i++) {
+    int end = lattice.path[i];
+    int id = lattice.best_id[end];
+    // Consecutive unknown pieces are fused into one.
+    while (id == unk_id_ && i + 1 < lattice.path.size() &&
+           lattice.best_id[lattice.path[i + 1]] == unk_id_) {
+      end = lattice.path[++i];
+    }
+    std::pair<int, int> token_offset = {
+        offset.first + lattice.unit_starts[start],
+        offset.first + lattice.unit_starts[end]};
+
+    bool emitted_bytes = false;
+    if (id == unk_id_ && byte_fallback_) {
+      int byte_begin = lattice.byte_starts[start];
+      int byte_end = lattice.byte_starts[end];
+      bool all_bytes = true;
+      for (int b = byte_begin; b < byte_end && all_bytes; b++) {
+        all_bytes = byte_ids_[static_cast<unsigned char>(word[b])] >= 0;
+      }
+      if (all_bytes) {
+        for (int b = byte_begin; b < byte_end; b++) {
+          int byte_id = byte_ids_[static_cast<unsigned char>(word[b])];
+          tokens.emplace_back(Token(vocab_[byte_id].first, byte_id,
+                                    token_offset, !tokens.empty()));
+        }
+        emitted_bytes = true;
+      }
+    }
+    if (!emitted_bytes) {
+      if (id < 0) {
+        throw std::runtime_error(
+            "unigram model has no unk_id to encode an unknown piece");
+      }
+      tokens.emplace_back(
+          Token(vocab_[id].first, id, token_offset, !tokens.empty()));
+    }
+    start = end;
+  }
+  return tokens;
+}
+
+std::vector<Token> Unigram::Tokenize(const icu::UnicodeString& input) {
+  return Tokenize(input, {0, input.length()});
+}
+
+std::vector<Token> Unigram::TokenizeString(const std::string& input) {
+  icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+  return Tokenize(unicode_input);
+}
+
+std::optional<std::string> Unigram::IdToToken(int id) {
+  if (id >= 0 && id < vocab_.size()) {
+    return vocab_[id].first;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> Unigram::IdToTokenView(int id) {
+  if (id >= 0 && id < vocab_.size()) {
+    return vocab_[id].first;
+  }
+  return std::nullopt;
+}
+
+std::optional<int> Unigram::TokenToId(const std::string& token) {
+  int id = FindPiece(token);
+  if (id >= 0) {
+    return id;
+  }
+  return std::nullopt;
+}
+
+std::optional<int> Unigram::UnkTokenId() {
+  if (unk_id_ < 0) {
+    return std::nullopt;
+  }
+  return unk_id_;
+}
+
+size_t Unigram::MemoryUsage() {
+  size_t usage = sizeof(Unigram);
+  for (const auto& [name, bytes] : MemoryUsageByStructure()) usage += bytes;
+  return usage;
+}
+
+MemoryUsageMap Unigram::MemoryUsageByStructure() {
+  return {{"vocab", HeapUsage(vocab_)},
+          {"trie", trie_nodes_.capacity() * sizeof(TrieNode) +
+                       trie_edges_.capacity() * sizeof(TrieEdge)},
+          {"byte_ids", HeapUsage(byte_ids_)}};
+}
+
 } // namespace models
 
 } // namespace tokenizers
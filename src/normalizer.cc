@@ -1,16 +1,24 @@
 // Copyright 2025 Omkar Prabhu
 #include "tokenizers/normalizer.h"
 
+#include <unicode/locid.h>
 #include <unicode/normalizer2.h>
 #include <unicode/schriter.h>
 #include <unicode/uchar.h>
 #include <unicode/unistr.h>
 #include <unicode/ustring.h>
+#include <unicode/utf16.h>
+#include <unicode/utf8.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace tokenizers {
@@ -24,44 +32,54 @@ namespace normalizers {
 // 0 -> insert offset of index before itself
 // 1 -> insert offset of index after itself
 // 2 -> insert offset of index before and after itself
+// The ops come in increasing index order. The copies of an offset are all
+// equal, so only their number matters and the offsets are rebuilt in a
+// single pass rather than edited in place.
 void transform_offsets(NormalizerResult* input,
                        const std::vector<std::pair<int, int>>& ops) {
-  int adjusted_idx = 0;
-  for (const std::pair<int, int>& op : ops) {
-    if (op.second == -1) {
-      input->offsets.erase(input->offsets.begin() + op.first + adjusted_idx);
-      adjusted_idx -= 1;
-    } else if (op.second == 0) {
-      std::pair<int, int> cur_offset = input->offsets[op.first + adjusted_idx];
-      input->offsets.insert(input->offsets.begin() + op.first + adjusted_idx,
-                            cur_offset);
-      adjusted_idx += 1;
-    } else if (op.second == 1) {
-      std::pair<int, int> cur_offset = input->offsets[op.first + adjusted_idx];
-      input->offsets.insert(
-          input->offsets.begin() + op.first + 1 + adjusted_idx, cur_offset);
-      adjusted_idx += 1;
-    } else if (op.second == 2) {
-      std::pair<int, int> cur_offset = input->offsets[op.first + adjusted_idx];
-      input->offsets.insert(input->offsets.begin() + op.first + adjusted_idx,
-                            cur_offset);
-      input->offsets.insert(
-          input->offsets.begin() + op.first + 1 + adjusted_idx, cur_offset);
-      adjusted_idx += 2;
+  if (input->offsets.empty() || ops.empty())
+    return;
+  std::vector<std::pair<int, int>> offsets;
+  offsets.reserve(input->offsets.size() + 2 * ops.size());
+  auto op = ops.begin();
+  for (int i = 0; i < input->offsets.size(); i++) {
+    int copies = 1;
+    for (; op != ops.end() && op->first == i; ++op) {
+      copies += op->second == -1 ? -1 : op->second == 2 ? 2 : 1;
     }
+    offsets.insert(offsets.end(), std::max(copies, 0), input->offsets[i]);
   }
+  input->offsets = std::move(offsets);
 }
 
 NormalizerResult::NormalizerResult(const icu::UnicodeString& normalized,
-                                   bool pre_normalized)
+                                   bool pre_normalized, bool track_offsets,
+                                   OffsetType offset_type)
     : normalized(normalized), pre_normalized(pre_normalized) {
-  offsets.reserve(normalized.countChar32());
-  icu::StringCharacterIterator it(normalized);
-  for (it.first(); it.hasNext();) {
-    int start = it.getIndex();
-    it.next32PostInc();
-    int end = it.getIndex();
+  if (!track_offsets)
+    return;
+  offsets.reserve(normalized.length());
+  const UChar* buffer = normalized.getBuffer();
+  int length = normalized.length();
+  int start = 0;
+  for (int pos = 0; pos < length;) {
+    int unit_start = pos;
+    UChar32 c;
+    U16_NEXT(buffer, pos, length, c);
+    int end = start;
+    switch (offset_type) {
+      case OffsetType::kUtf16:
+        end += pos - unit_start;
+        break;
+      case OffsetType::kUtf8:
+        end += U8_LENGTH(c);
+        break;
+      case OffsetType::kCodePoints:
+        end += 1;
+        break;
+    }
     offsets.emplace_back(start, end);
+    start = end;
   }
 }
 
@@ -110,41 +128,503 @@ std::string BertNormalizer::NormalizeString(std::string input) {
   return result;
 }
 
+namespace {
+
+std::string normalizeString(Normalizer* normalizer, const std::string& input) {
+  NormalizerResult normalized = normalizer->Normalize(
+      NormalizerResult(icu::UnicodeString::fromUTF8(input)));
+  std::string result;
+  normalized.normalized.toUTF8String(result);
+  return result;
+}
+
+std::vector<UChar32> toChars(const icu::UnicodeString& input) {
+  std::vector<UChar32> chars;
+  chars.reserve(input.length());
+  for (int i = 0; i < input.length(); i = input.moveIndex32(i, 1)) {
+    chars.push_back(input.char32At(i));
+  }
+  return chars;
+}
+
+} // namespace
+
+namespace {
+
+const icu::Normalizer2* getNormalizer(
+    const icu::Normalizer2* (*get_instance)(UErrorCode&)) {
+  UErrorCode error_code = U_ZERO_ERROR;
+  const icu::Normalizer2* normalizer = get_instance(error_code);
+  if (U_FAILURE(error_code) || !normalizer) {
+    throw std::runtime_error(
+        std::string("failed to get normalizer instance: ") +
+        u_errorName(error_code));
+  }
+  return normalizer;
+}
+
+} // namespace
+
+// Each normalized segment of n code points becoming m code points is
+// aligned proportionally: a decomposed character shares its offsets with
+// all its parts and a composed one spans all the characters it came from.
+NormalizerResult normalizeUnicode(NormalizerResult input,
+                                  const icu::Normalizer2* normalizer) {
+  UErrorCode error_code = U_ZERO_ERROR;
+  const icu::UnicodeString& text = input.normalized;
+  int length = text.length();
+  int yes = normalizer->spanQuickCheckYes(text, error_code);
+  if (U_FAILURE(error_code)) {
+    throw std::runtime_error(std::string("failed to normalize string input: ") +
+                             u_errorName(error_code));
+  }
+  if (yes == length)
+    return input;
+
+  NormalizerResult result(icu::UnicodeString(), {}, input.pre_normalized);
+  result.normalized = icu::UnicodeString(length + 16, 0, 0);
+  result.offsets.reserve(input.offsets.size() + 16);
+  int pos = 0;
+  size_t char_idx = 0;
+  bool track_offsets = !input.offsets.empty();
+  auto offset_at = [&](size_t idx) {
+    return idx < input.offsets.size() ? input.offsets[idx]
+                                      : input.offsets.back();
+  };
+  const UChar* buffer = text.getBuffer();
+  auto copy_until = [&](int end) {
+    result.normalized.append(buffer, pos, end - pos);
+    if (!track_offsets) {
+      pos = end;
+      return;
+    }
+    while (pos < end) {
+      result.offsets.emplace_back(offset_at(char_idx++));
+      U16_FWD_1(buffer, pos, end);
+    }
+  };
+  copy_until(yes);
+
+  icu::UnicodeString segment_normalized;
+  while (pos < length) {
+    int end = text.moveIndex32(pos, 1);
+    while (end < length && !normalizer->hasBoundaryBefore(text.char32At(end))) {
+      end = text.moveIndex32(end, 1);
+    }
+    normalizer->normalize(text.tempSubStringBetween(pos, end),
+                          segment_normalized, error_code);
+    if (U_FAILURE(error_code)) {
+      throw std::runtime_error(
+          std::string("failed to normalize string input: ") +
+          u_errorName(error_code));
+    }
+    size_t n = text.countChar32(pos, end - pos);
+    size_t m = track_offsets ? segment_normalized.countChar32() : 0;
+    for (size_t i = 0; i < m; i++) {
+      size_t first = i * n / m;
+      size_t last = std::max((i + 1) * n / m, first + 1) - 1;
+      result.offsets.emplace_back(offset_at(char_idx + first).first,
+                                  offset_at(char_idx + last).second);
+    }
+    result.normalized.append(segment_normalized);
+    char_idx += n;
+    pos = end;
+
+    // Skip ahead over the next run that passes the quick check.
+    yes = normalizer->spanQuickCheckYes(text.tempSubString(pos), error_code);
+    if (U_FAILURE(error_code)) {
+      throw std::runtime_error(
+          std::string("failed to normalize string input: ") +
+          u_errorName(error_code));
+    }
+    copy_until(pos + yes);
+  }
+  return result;
+}
+
+NFC::NFC() : normalizer_(getNormalizer(icu::Normalizer2::getNFCInstance)) {}
+
+NormalizerResult NFC::Normalize(NormalizerResult input) {
+  return normalizeUnicode(std::move(input), normalizer_);
+}
+
+std::string NFC::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+NFD::NFD() : normalizer_(getNormalizer(icu::Normalizer2::getNFDInstance)) {}
+
+NormalizerResult NFD::Normalize(NormalizerResult input) {
+  return normalizeUnicode(std::move(input), normalizer_);
+}
+
+std::string NFD::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+NFKC::NFKC()
+    : normalizer_(getNormalizer(icu::Normalizer2::getNFKCInstance)) {}
+
+NormalizerResult NFKC::Normalize(NormalizerResult input) {
+  return normalizeUnicode(std::move(input), normalizer_);
+}
+
+std::string NFKC::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+NFKD::NFKD()
+    : normalizer_(getNormalizer(icu::Normalizer2::getNFKDInstance)) {}
+
+NormalizerResult NFKD::Normalize(NormalizerResult input) {
+  return normalizeUnicode(std::move(input), normalizer_);
+}
+
+std::string NFKD::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+Lowercase::Lowercase() {}
+
+bool Lowercase::NeedsFullMapping(const icu::UnicodeString& input) {
+  const UChar* buffer = input.getBuffer();
+  for (int i = 0; i < input.length(); i++) {
+    if (buffer[i] == 0x0130 || buffer[i] == 0x03A3)
+      return true;
+  }
+  return false;
+}
+
+NormalizerResult Lowercase::Normalize(NormalizerResult input) {
+  if (!NeedsFullMapping(input.normalized))
+    return normalizeChars(input, *this);
+  // U+0130 is the only code point lowercased to more than one, both take
+  // its offsets.
+  if (!input.offsets.empty()) {
+    std::vector<std::pair<int, int>> offsets;
+    offsets.reserve(input.offsets.size() + 1);
+    int char_idx = 0;
+    for (int pos = 0; pos < input.normalized.length();
+         pos = input.normalized.moveIndex32(pos, 1), char_idx++) {
+      offsets.push_back(input.offsets[char_idx]);
+      if (input.normalized.charAt(pos) == 0x0130)
+        offsets.push_back(input.offsets[char_idx]);
+    }
+    input.offsets = std::move(offsets);
+  }
+  input.normalized.toLower(icu::Locale::getRoot());
+  return input;
+}
+
+std::string Lowercase::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+StripAccents::StripAccents() {}
+
+NormalizerResult StripAccents::Normalize(NormalizerResult input) {
+  return normalizeChars(input, *this);
+}
+
+std::string StripAccents::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+Replace::Replace(const std::string& pattern, const std::string& content)
+    : pattern_(icu::UnicodeString::fromUTF8(pattern)),
+      content_(icu::UnicodeString::fromUTF8(content)),
+      pattern_char_(-1),
+      content_chars_(toChars(content_)) {
+  if (!pattern_.isEmpty() && pattern_.countChar32() == 1) {
+    pattern_char_ = pattern_.char32At(0);
+  }
+}
+
+// Longer patterns are matched left to right without overlaps, every code
+// point of the content takes the offsets spanning the whole match.
+NormalizerResult Replace::Normalize(NormalizerResult input) {
+  if (pattern_.isEmpty())
+    return input;
+  if (IsCharLevel())
+    return normalizeChars(input, *this);
+  NormalizerResult result(icu::UnicodeString(), {}, input.pre_normalized);
+  bool track_offsets = !input.offsets.empty();
+  int char_idx = 0;
+  int pos = 0;
+  while (pos < input.normalized.length()) {
+    int match = input.normalized.indexOf(pattern_, pos);
+    int end = match < 0 ? input.normalized.length() : match;
+    for (; pos < end; pos = input.normalized.moveIndex32(pos, 1)) {
+      result.normalized.append(input.normalized.char32At(pos));
+      if (track_offsets)
+        result.offsets.emplace_back(input.offsets[char_idx]);
+      char_idx++;
+    }
+    if (match < 0)
+      break;
+    int match_chars = pattern_.countChar32();
+    result.normalized.append(content_);
+    if (track_offsets) {
+      std::pair<int, int> span(
+          input.offsets[char_idx].first,
+          input.offsets[char_idx + match_chars - 1].second);
+      result.offsets.insert(result.offsets.end(), content_chars_.size(), span);
+    }
+    char_idx += match_chars;
+    pos += pattern_.length();
+  }
+  return result;
+}
+
+std::string Replace::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+Prepend::Prepend(const std::string& prepend)
+    : prepend_chars_(toChars(icu::UnicodeString::fromUTF8(prepend))) {}
+
+NormalizerResult Prepend::Normalize(NormalizerResult input) {
+  return normalizeChars(input, *this);
+}
+
+std::string Prepend::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+template class FusedNormalizer<Prepend, Replace>;
+template class FusedNormalizer<Lowercase, StripAccents>;
+template class FusedNormalizer<StripAccents, Lowercase>;
+
+DynamicFusedNormalizer::DynamicFusedNormalizer(
+    const std::vector<CharNormalizer>& steps)
+    : steps_(steps) {}
+
+NormalizerResult DynamicFusedNormalizer::Normalize(NormalizerResult input) {
+  bool has_lowercase =
+      std::any_of(steps_.begin(), steps_.end(), [](const CharNormalizer& step) {
+        return std::holds_alternative<Lowercase>(step);
+      });
+  if (has_lowercase && Lowercase::NeedsFullMapping(input.normalized)) {
+    for (CharNormalizer& step : steps_) {
+      std::visit(
+          [&](auto& s) { input = s.Normalize(std::move(input)); }, step);
+    }
+    return input;
+  }
+  return normalizeChars(input, *this);
+}
+
+std::string DynamicFusedNormalizer::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+Sequence::Sequence(const std::vector<std::shared_ptr<Normalizer>>& normalizers)
+    : normalizers_(normalizers) {}
+
+NormalizerResult Sequence::Normalize(NormalizerResult input) {
+  for (const std::shared_ptr<Normalizer>& normalizer : normalizers_) {
+    input = normalizer->Normalize(std::move(input));
+  }
+  return input;
+}
+
+std::string Sequence::NormalizeString(std::string input) {
+  return normalizeString(this, input);
+}
+
+namespace {
+
+std::optional<CharNormalizer> asCharNormalizer(
+    const std::shared_ptr<Normalizer>& normalizer) {
+  if (auto lowercase = std::dynamic_pointer_cast<Lowercase>(normalizer))
+    return *lowercase;
+  if (auto strip_accents = std::dynamic_pointer_cast<StripAccents>(normalizer))
+    return *strip_accents;
+  if (auto replace = std::dynamic_pointer_cast<Replace>(normalizer)) {
+    if (replace->IsCharLevel())
+      return *replace;
+  }
+  if (auto prepend = std::dynamic_pointer_cast<Prepend>(normalizer))
+    return *prepend;
+  return std::nullopt;
+}
+
+template <typename First, typename Second>
+std::shared_ptr<Normalizer> fusePair(const std::vector<CharNormalizer>& steps) {
+  if (!std::holds_alternative<First>(steps[0]) ||
+      !std::holds_alternative<Second>(steps[1]))
+    return nullptr;
+  return std::make_shared<FusedNormalizer<First, Second>>(
+      std::get<First>(steps[0]), std::get<Second>(steps[1]));
+}
+
+std::shared_ptr<Normalizer> fuseChars(
+    const std::vector<CharNormalizer>& steps) {
+  if (steps.size() == 2) {
+    std::shared_ptr<Normalizer> fused = fusePair<Prepend, Replace>(steps);
+    if (!fused)
+      fused = fusePair<Lowercase, StripAccents>(steps);
+    if (!fused)
+      fused = fusePair<StripAccents, Lowercase>(steps);
+    if (fused)
+      return fused;
+  }
+  return std::make_shared<DynamicFusedNormalizer>(steps);
+}
+
+} // namespace
+
+std::shared_ptr<Normalizer> fuseNormalizers(
+    const std::vector<std::shared_ptr<Normalizer>>& normalizers) {
+  std::vector<std::shared_ptr<Normalizer>> stages;
+  std::vector<std::shared_ptr<Normalizer>> group;
+  std::vector<CharNormalizer> group_steps;
+  auto flush = [&]() {
+    if (group.size() == 1) {
+      stages.push_back(group.front());
+    } else if (group.size() > 1) {
+      stages.push_back(fuseChars(group_steps));
+    }
+    group.clear();
+    group_steps.clear();
+  };
+  for (const std::shared_ptr<Normalizer>& normalizer : normalizers) {
+    if (!normalizer)
+      throw std::invalid_argument("unsupported normalizer in sequence");
+    std::optional<CharNormalizer> step = asCharNormalizer(normalizer);
+    if (step) {
+      group.push_back(normalizer);
+      group_steps.push_back(std::move(*step));
+      continue;
+    }
+    flush();
+    stages.push_back(normalizer);
+  }
+  flush();
+  if (stages.size() == 1)
+    return stages.front();
+  return std::make_shared<Sequence>(stages);
+}
+
+// Both write straight into the buffer of the result, appending to a
+// UnicodeString a character at a time costs more than the checks.
 void doCleanText(NormalizerResult* input) {
+  const UChar* buffer = input->normalized.getBuffer();
+  int length = input->normalized.length();
+  if (length == 0)
+    return;
   icu::UnicodeString result;
-  icu::StringCharacterIterator it(input->normalized);
+  UChar* out = result.getBuffer(length);
+  int out_length = 0;
   std::vector<std::pair<int, int>> ops;
-  for (it.first(); it.hasNext();) {
-    UChar32 c = it.next32PostInc();
+  int char_idx = 0;
+  for (int pos = 0; pos < length; char_idx++) {
+    UChar32 c;
+    U16_NEXT(buffer, pos, length, c);
     if (c == 0x0000 || c == 0xFFFD || isControl(c)) {
-      ops.emplace_back(it.getIndex() - 1, -1);
+      ops.emplace_back(char_idx, -1);
       continue;
     }
-    result.append(isWhitespace(c) ? ' ' : c);
+    U16_APPEND_UNSAFE(out, out_length, isWhitespace(c) ? ' ' : c);
   }
-  input->normalized = result;
+  result.releaseBuffer(out_length);
+  input->normalized = std::move(result);
   transform_offsets(input, ops);
 }
 
 void doHandleChineseChars(NormalizerResult* input) {
+  const UChar* buffer = input->normalized.getBuffer();
+  int length = input->normalized.length();
+  if (length == 0)
+    return;
   icu::UnicodeString result;
-  icu::StringCharacterIterator it(input->normalized);
+  // Every Chinese character takes at least one unit and gains two spaces.
+  UChar* out = result.getBuffer(3 * length);
+  int out_length = 0;
   std::vector<std::pair<int, int>> ops;
-  for (it.first(); it.hasNext();) {
-    UChar32 c = it.next32PostInc();
+  int char_idx = 0;
+  for (int pos = 0; pos < length; char_idx++) {
+    UChar32 c;
+    U16_NEXT(buffer, pos, length, c);
     if (isChineseChar(c)) {
-      result.append(' ');
-      result.append(c);
-      result.append(' ');
-      ops.emplace_back(it.getIndex() - 1, 2);
+      out[out_length++] = ' ';
+      U16_APPEND_UNSAFE(out, out_length, c);
+      out[out_length++] = ' ';
+      ops.emplace_back(char_idx, 2);
     } else {
-      result.append(c);
+      U16_APPEND_UNSAFE(out, out_length, c);
     }
   }
-  input->normalized = result;
+  result.releaseBuffer(out_length);
+  input->normalized = std::move(result);
   transform_offsets(input, ops);
 }
 
+#ifdef TOKENIZERS_UNICODE_TABLES
+
+// NFD from the generated tables: every code point is replaced by its full
+// canonical decomposition and the combining characters left after dropping
+// the marks are put in canonical order.
+void doStripAccents(NormalizerResult* input) {
+  struct Combining {
+    uint8_t combining_class;
+    UChar32 c;
+    std::pair<int, int> offsets;
+  };
+  bool track_offsets = !input->offsets.empty();
+  icu::UnicodeString result(input->normalized.length(), 0, 0);
+  std::vector<std::pair<int, int>> offsets;
+  offsets.reserve(input->offsets.size());
+  std::vector<Combining> run;
+  auto flush = [&]() {
+    std::stable_sort(run.begin(), run.end(),
+                     [](const Combining& a, const Combining& b) {
+                       return a.combining_class < b.combining_class;
+                     });
+    for (const Combining& combining : run) {
+      result.append(combining.c);
+      if (track_offsets)
+        offsets.emplace_back(combining.offsets);
+    }
+    run.clear();
+  };
+  const UChar* buffer = input->normalized.getBuffer();
+  int length = input->normalized.length();
+  UChar32 decomposed[unicode::tables::kMaxDecomposition];
+  for (int pos = 0, char_idx = 0; pos < length; char_idx++) {
+    UChar32 c;
+    U16_NEXT(buffer, pos, length, c);
+    int n = unicode::tables::Decompose(c, decomposed);
+    if (n == 0) {
+      decomposed[0] = c;
+      n = 1;
+    }
+    std::pair<int, int> char_offsets =
+        char_idx < input->offsets.size() ? input->offsets[char_idx]
+                                         : std::make_pair(0, 0);
+    for (int i = 0; i < n; i++) {
+      UChar32 d = decomposed[i];
+      if (unicode::CharType(d) == U_NON_SPACING_MARK)
+        continue;
+      uint8_t combining_class = unicode::tables::CombiningClass(d);
+      if (combining_class != 0) {
+        run.push_back({combining_class, d, char_offsets});
+        continue;
+      }
+      flush();
+      result.append(d);
+      if (track_offsets)
+        offsets.emplace_back(char_offsets);
+    }
+  }
+  flush();
+
+  input->normalized = result;
+  input->offsets = std::move(offsets);
+}
+
+#else
+
 void doStripAccents(NormalizerResult* input) {
   UErrorCode error_code = U_ZERO_ERROR;
   const icu::Normalizer2* normalizer =
@@ -155,50 +635,43 @@ void doStripAccents(NormalizerResult* input) {
         u_errorName(error_code));
   }
 
-  icu::UnicodeString normalized;
-  normalizer->normalize(input->normalized, normalized, error_code);
-  if (U_FAILURE(error_code)) {
-    throw std::runtime_error(std::string("failed to normalize string input: ") +
-                             u_errorName(error_code));
-  }
-
+  // Decomposition can add code points besides the marks dropped here, so it
+  // goes through normalizeUnicode to keep one offset per code point.
+  *input = normalizeUnicode(std::move(*input), normalizer);
   icu::UnicodeString result;
-  icu::StringCharacterIterator it(normalized);
-  for (it.first(); it.hasNext();) {
+  std::vector<std::pair<int, int>> offsets;
+  offsets.reserve(input->offsets.size());
+  icu::StringCharacterIterator it(input->normalized);
+  for (int char_idx = 0; it.hasNext(); char_idx++) {
     UChar32 c = it.next32PostInc();
-    if (u_charType(c) != U_NON_SPACING_MARK) {
+    if (unicode::CharType(c) != U_NON_SPACING_MARK) {
       result.append(c);
+      if (char_idx < input->offsets.size())
+        offsets.emplace_back(input->offsets[char_idx]);
     }
   }
 
   input->normalized = result;
+  input->offsets = std::move(offsets);
 }
 
+#endif
+
 void doLowercase(NormalizerResult* input) { input->normalized.toLower(); }
 
 bool isControl(UChar32 c) {
   if (c == '\t' || c == '\n' || c == '\r')
     return false;
-  int char_type = u_charType(c);
+  int char_type = unicode::CharType(c);
   return char_type == U_CONTROL_CHAR ||   // Cc
          char_type == U_FORMAT_CHAR ||    // Cf
          char_type == U_UNASSIGNED ||     // Cn
          char_type == U_PRIVATE_USE_CHAR; // Co
 }
 
-bool isWhitespace(UChar32 c) { return u_isWhitespace(c); }
+bool isWhitespace(UChar32 c) { return unicode::IsWhitespace(c); }
 
-bool isChineseChar(UChar32 c) {
-  UBlockCode block = ublock_getCode(c);
-  return (block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS ||
-          block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_A ||
-          block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_B ||
-          block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_C ||
-          block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_D ||
-          block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_E ||
-          block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_F ||
-          block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_G);
-}
+bool isChineseChar(UChar32 c) { return unicode::IsChineseChar(c); }
 
 } // namespace normalizers
 
@@ -1,6 +1,8 @@
 // Copyright 2025 Omkar Prabhu
 #include "tokenizers/post_processor.h"
 
+#include <memory_resource>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -15,10 +17,19 @@ namespace post_processors {
 PostProcessor::PostProcessor() {}
 
 std::vector<Encoding> PostProcessor::ProcessEncodings(
-    const std::vector<Encoding>& encodings) {
+    std::vector<Encoding> encodings) {
   return {};
 }
 
+Encoding PostProcessor::Process(std::vector<Encoding> encodings,
+                                EncodeOptions options,
+                                std::pmr::memory_resource* resource) {
+  return ConcatEncodings(ProcessEncodings(std::move(encodings)), options,
+                         resource);
+}
+
+int PostProcessor::AddedTokens(bool is_pair) { return 0; }
+
 TemplateProcessor::TemplateProcessor() : category(""), type_id(0), id("") {}
 
 TemplateProcessor::TemplateProcessor(const std::string& category, int type_id,
@@ -34,7 +45,7 @@ TemplateProcessing::TemplateProcessing(
     : single_(single), pair_(pair), special_tokens_(special_tokens) {}
 
 std::vector<Encoding> TemplateProcessing::ProcessEncodings(
-    const std::vector<Encoding>& encodings) {
+    std::vector<Encoding> encodings) {
   const std::vector<TemplateProcessor>& seq_processor =
       encodings.size() == 1 ? single_ : pair_;
   std::vector<Encoding> result;
@@ -56,6 +67,59 @@ std::vector<Encoding> TemplateProcessing::ProcessEncodings(
   return result;
 }
 
+int TemplateProcessing::AddedTokens(bool is_pair) {
+  int added_tokens = 0;
+  for (const TemplateProcessor& processor : is_pair ? pair_ : single_) {
+    if (processor.category == "SpecialToken")
+      added_tokens += special_tokens_.count(processor.id);
+  }
+  return added_tokens;
+}
+
+Encoding TemplateProcessing::Process(std::vector<Encoding> encodings,
+                                     EncodeOptions options,
+                                     std::pmr::memory_resource* resource) {
+  const std::vector<TemplateProcessor>& seq_processor =
+      encodings.size() == 1 ? single_ : pair_;
+  int length = 0;
+  int seq_id = 0;
+  for (const TemplateProcessor& processor : seq_processor) {
+    if (processor.category == "SpecialToken") {
+      length += special_tokens_.count(processor.id);
+    } else if (processor.category == "Sequence" &&
+               seq_id < encodings.size()) {
+      length += encodings[seq_id++].ids.size();
+    }
+  }
+  Encoding result(resource);
+  result.Reserve(length, options);
+  seq_id = 0;
+  for (const TemplateProcessor& processor : seq_processor) {
+    if (processor.category == "SpecialToken") {
+      auto it = special_tokens_.find(processor.id);
+      if (it == special_tokens_.end())
+        continue;
+      result.ids.emplace_back(it->second);
+      if (hasOption(options, EncodeOptions::kTypeIds))
+        result.type_ids.emplace_back(processor.type_id);
+      if (hasOption(options, EncodeOptions::kTokens))
+        result.tokens.emplace_back(processor.id);
+      if (hasOption(options, EncodeOptions::kOffsets))
+        result.offsets.emplace_back(0, 0);
+      if (hasOption(options, EncodeOptions::kWordIds))
+        result.word_ids.emplace_back(std::nullopt);
+      if (hasOption(options, EncodeOptions::kSpecialTokensMask))
+        result.special_tokens_mask.emplace_back(1);
+      if (hasOption(options, EncodeOptions::kAttentionMask))
+        result.attention_mask.emplace_back(1);
+    } else if (processor.category == "Sequence" &&
+               seq_id < encodings.size()) {
+      result.Append(std::move(encodings[seq_id++]), options);
+    }
+  }
+  return result;
+}
+
 } // namespace post_processors
 
 } // namespace tokenizers
@@ -1,14 +1,23 @@
 // Copyright 2025 Omkar Prabhu
 #include "tokenizers/pre_tokenizer.h"
 
+#include <unicode/regex.h>
 #include <unicode/schriter.h>
 #include <unicode/uchar.h>
 #include <unicode/unistr.h>
+#include <unicode/utf16.h>
+#include <unicode/utf8.h>
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <variant>
 #include <utility>
 #include <vector>
 
@@ -28,7 +37,7 @@ PreTokenizerResult::PreTokenizerResult(const icu::UnicodeString& pre_tokenized)
     int end = it.getIndex();
     char_offsets[0].emplace_back(start, end);
   }
-  offsets.emplace_back(0, pre_tokenized.countChar32());
+  offsets.emplace_back(0, pre_tokenized.length());
 }
 
 PreTokenizerResult::PreTokenizerResult(
@@ -53,24 +62,41 @@ PreTokenizerResult::PreTokenizerResult(
 // Isolated => [ "the", "-", "final", "-", "-", "countdown" ]
 // MergedWithPrevious => [ "the-", "final-", "-", "countdown" ]
 // MergedWithNext => [ "the", "-final", "-", "-countdown" ]
+// Contiguous => [ "the", "-", "final", "--", "countdown" ]
 PreTokenizerResult split(const PreTokenizerResult& input,
                          std::function<bool(UChar32)> should_split,
                          SplitDelimiterBehavior behavior) {
   PreTokenizerResult result;
   result.pre_tokenized.reserve(input.pre_tokenized.size() * 2);
   result.offsets.reserve(input.offsets.size() * 2);
+  bool track_offsets = !input.char_offsets.empty();
+  std::vector<std::pair<int, int>> untracked_char_offsets;
   for (int i = 0; i < input.pre_tokenized.size(); i++) {
     const icu::UnicodeString& token = input.pre_tokenized[i];
-    const std::pair<int, int>& token_offset = input.offsets[i];
+    if (!track_offsets) {
+      untracked_char_offsets.assign(token.length(), std::make_pair(0, 0));
+    }
     const std::vector<std::pair<int, int>>& token_char_offsets =
-        input.char_offsets[i];
+        track_offsets ? input.char_offsets[i] : untracked_char_offsets;
     icu::UnicodeString current;
     icu::StringCharacterIterator it(token);
     int token_idx = 0;
+    bool in_delimiters = false;
+    auto flush_current = [&](int end) {
+      result.pre_tokenized.emplace_back(current);
+      result.offsets.emplace_back(token_char_offsets[token_idx].first,
+                                  token_char_offsets[end - 1].second);
+      result.char_offsets.emplace_back(token_char_offsets.begin() + token_idx,
+                                       token_char_offsets.begin() + end);
+      current.remove();
+      token_idx = end;
+    };
+    // char_offsets hold one entry per code point, so positions count those.
+    int char_idx = 0;
     for (it.first(); it.hasNext();) {
-      int char_start = it.getIndex();
+      int char_start = char_idx;
       UChar32 c = it.next32PostInc();
-      int char_end = it.getIndex();
+      int char_end = ++char_idx;
       if (should_split(c)) {
         switch (behavior) {
           case SplitDelimiterBehavior::kRemoved:
@@ -145,13 +171,25 @@ PreTokenizerResult split(const PreTokenizerResult& input,
                 current_char_offsets.emplace_back(token_char_offsets[j].first,
                                                   token_char_offsets[j].second);
               }
+              result.char_offsets.emplace_back(current_char_offsets);
               current.remove();
             }
             token_idx = char_start;
             current.append(c);
             break;
+          case SplitDelimiterBehavior::kContiguous:
+            if (!current.isEmpty() && !in_delimiters) {
+              flush_current(char_start);
+            }
+            in_delimiters = true;
+            current.append(c);
+            break;
         }
       } else {
+        if (in_delimiters && !current.isEmpty()) {
+          flush_current(char_start);
+        }
+        in_delimiters = false;
         current.append(c);
       }
     }
@@ -167,6 +205,10 @@ PreTokenizerResult split(const PreTokenizerResult& input,
       result.char_offsets.emplace_back(current_char_offsets);
     }
   }
+  if (!track_offsets) {
+    result.char_offsets.clear();
+    result.offsets.clear();
+  }
   return result;
 }
 
@@ -183,15 +225,97 @@ PreTokenizerResult PreTokenizer::PreTokenize(const PreTokenizerResult& input) {
 
 BertPreTokenizer::BertPreTokenizer() {}
 
+namespace {
+
+// Splits every piece of input in one pass, classify tells what to do with
+// each code point.
+template <typename Classifier>
+PreTokenizerResult splitChars(const PreTokenizerResult& input,
+                              const Classifier& classify) {
+  PreTokenizerResult result;
+  result.pre_tokenized.reserve(input.pre_tokenized.size() * 2);
+  result.char_offsets.reserve(input.pre_tokenized.size() * 2);
+  result.offsets.reserve(input.pre_tokenized.size() * 2);
+  bool track_offsets = !input.char_offsets.empty();
+  icu::UnicodeString current;
+  std::vector<std::pair<int, int>> current_char_offsets;
+  bool contiguous = false;
+  bool current_at_start = false;
+  auto flush = [&]() {
+    contiguous = false;
+    if (current.isEmpty())
+      return;
+    if (result.pre_tokenized.empty())
+      result.at_start = input.at_start && current_at_start;
+    result.pre_tokenized.emplace_back(std::move(current));
+    current.remove();
+    if (track_offsets) {
+      result.offsets.emplace_back(current_char_offsets.front().first,
+                                  current_char_offsets.back().second);
+      result.char_offsets.emplace_back(std::move(current_char_offsets));
+      current_char_offsets.clear();
+    }
+  };
+
+  for (int i = 0; i < input.pre_tokenized.size(); i++) {
+    const icu::UnicodeString& token = input.pre_tokenized[i];
+    const UChar* buffer = token.getBuffer();
+    int length = token.length();
+    int char_idx = 0;
+    for (int pos = 0; pos < length; char_idx++) {
+      UChar32 c;
+      U16_NEXT(buffer, pos, length, c);
+      CharAction action = classify(c);
+      if (action == CharAction::kRemove) {
+        flush();
+        continue;
+      }
+      if (action == CharAction::kIsolate ||
+          action == CharAction::kMergeWithNext ||
+          (action == CharAction::kContiguous && !contiguous) ||
+          (action == CharAction::kKeep && contiguous)) {
+        flush();
+      }
+      if (current.isEmpty())
+        current_at_start = i == 0 && char_idx == 0;
+      current.append(c);
+      if (track_offsets)
+        current_char_offsets.emplace_back(input.char_offsets[i][char_idx]);
+      if (action == CharAction::kIsolate ||
+          action == CharAction::kMergeWithPrevious) {
+        flush();
+      }
+      contiguous = action == CharAction::kContiguous;
+    }
+    flush();
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>> preTokenizeString(
+    PreTokenizer* pre_tokenizer, const std::string& input) {
+  PreTokenizerResult pre_tokenized = pre_tokenizer->PreTokenize(
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(input)));
+  std::vector<std::pair<std::string, std::pair<int, int>>> result;
+  result.reserve(pre_tokenized.pre_tokenized.size());
+  for (int i = 0; i < pre_tokenized.pre_tokenized.size(); i++) {
+    std::string str;
+    pre_tokenized.pre_tokenized[i].toUTF8String(str);
+    result.emplace_back(str, pre_tokenized.offsets[i]);
+  }
+  return result;
+}
+
+} // namespace
+
+// Whitespace is removed and punctuation isolated in the same pass.
 PreTokenizerResult BertPreTokenizer::PreTokenize(
     const PreTokenizerResult& input) {
-  PreTokenizerResult input_pre_tokenized = split(
-      input, [](UChar32 c) { return u_isWhitespace(c); },
-      SplitDelimiterBehavior::kRemoved);
-  input_pre_tokenized = split(
-      input_pre_tokenized, [](UChar32 c) { return u_ispunct(c); },
-      SplitDelimiterBehavior::kIsolated);
-  return input_pre_tokenized;
+  return splitChars(input, [](UChar32 c) {
+    if (unicode::IsWhitespace(c))
+      return CharAction::kRemove;
+    return unicode::IsPunct(c) ? CharAction::kIsolate : CharAction::kKeep;
+  });
 }
 
 std::vector<std::pair<std::string, std::pair<int, int>>>
@@ -209,6 +333,689 @@ BertPreTokenizer::PreTokenizeString(const std::string& input) {
   return result;
 }
 
+namespace {
+
+enum CharClass : uint8_t { kLetter, kNumber, kWhitespace, kOther };
+
+inline uint8_t classifyChar(UChar32 c) {
+  if (unicode::IsUWhiteSpace(c))
+    return kWhitespace;
+  uint32_t mask = unicode::CategoryMask(c);
+  if (mask & U_GC_L_MASK)
+    return kLetter;
+  if (mask & U_GC_N_MASK)
+    return kNumber;
+  return kOther;
+}
+
+// Latin-1 is looked up in a table, everything else goes to ICU.
+inline uint8_t charClass(UChar32 c) {
+  static const std::array<uint8_t, 256> latin1_classes = [] {
+    std::array<uint8_t, 256> classes;
+    for (UChar32 i = 0; i < 256; i++) {
+      classes[i] = classifyChar(i);
+    }
+    return classes;
+  }();
+  return c < 256 ? latin1_classes[c] : classifyChar(c);
+}
+
+// Scanner over the code points of a UTF-16 buffer, all positions are code
+// unit indices.
+class Scanner {
+ public:
+  explicit Scanner(const icu::UnicodeString& input)
+      : buffer_(input.getBuffer()), length_(input.length()) {}
+
+  int length() const { return length_; }
+
+  UChar32 at(int pos, int* next) const {
+    UChar32 c;
+    U16_NEXT(buffer_, pos, length_, c);
+    *next = pos;
+    return c;
+  }
+
+  uint8_t classAt(int pos) const {
+    int next;
+    return pos < length_ ? charClass(at(pos, &next))
+                         : static_cast<uint8_t>(kWhitespace);
+  }
+
+  // End of the run of code points of class cls starting at pos, at most
+  // max_chars long when max_chars > 0.
+  int run(int pos, uint8_t cls, int max_chars = 0) const {
+    int count = 0;
+    while (pos < length_ && (max_chars == 0 || count < max_chars)) {
+      int next;
+      if (charClass(at(pos, &next)) != cls)
+        break;
+      pos = next;
+      count++;
+    }
+    return pos;
+  }
+
+  // End of 's|'t|'re|'ve|'m|'ll|'d at pos or -1.
+  int contraction(int pos, bool ignore_case) const {
+    if (buffer_[pos] != '\'' || pos + 1 >= length_)
+      return -1;
+    auto lower = [&](int i) -> UChar {
+      UChar c = i < length_ ? buffer_[i] : 0;
+      return ignore_case && c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+    };
+    UChar first = lower(pos + 1);
+    if (first == 's' || first == 't' || first == 'm' || first == 'd')
+      return pos + 2;
+    UChar second = lower(pos + 2);
+    if ((first == 'r' && second == 'e') || (first == 'v' && second == 'e') ||
+        (first == 'l' && second == 'l'))
+      return pos + 3;
+    return -1;
+  }
+
+  // \s+(?!\S)|\s+ at pos, where pos starts a whitespace run.
+  int whitespace(int pos) const {
+    int last = pos;
+    int end = pos;
+    while (end < length_) {
+      int next;
+      if (charClass(at(end, &next)) != kWhitespace)
+        break;
+      last = end;
+      end = next;
+    }
+    return end == length_ || last == pos ? end : last;
+  }
+
+ private:
+  const UChar* buffer_;
+  int length_;
+};
+
+} // namespace
+
+std::vector<std::pair<int, int>> splitGPT2(const icu::UnicodeString& input) {
+  Scanner scanner(input);
+  std::vector<std::pair<int, int>> matches;
+  int pos = 0;
+  while (pos < scanner.length()) {
+    int end = scanner.contraction(pos, false);
+    if (end < 0) {
+      int next;
+      UChar32 c = scanner.at(pos, &next);
+      uint8_t cls = charClass(c);
+      int run_start = pos;
+      if (c == ' ' && scanner.classAt(next) != kWhitespace) {
+        run_start = next;
+        cls = scanner.classAt(next);
+      }
+      end = cls == kWhitespace ? scanner.whitespace(pos)
+                               : scanner.run(run_start, cls);
+    }
+    matches.emplace_back(pos, end);
+    pos = end;
+  }
+  return matches;
+}
+
+std::vector<std::pair<int, int>> splitLlama3(const icu::UnicodeString& input) {
+  Scanner scanner(input);
+  std::vector<std::pair<int, int>> matches;
+  int pos = 0;
+  while (pos < scanner.length()) {
+    int end = scanner.contraction(pos, true);
+    if (end < 0) {
+      int next;
+      UChar32 c = scanner.at(pos, &next);
+      uint8_t cls = charClass(c);
+      uint8_t next_cls = scanner.classAt(next);
+      bool is_newline = c == '\r' || c == '\n';
+      if (cls == kLetter) {
+        end = scanner.run(pos, kLetter);
+      } else if (!is_newline && cls != kNumber && next < scanner.length() &&
+                 next_cls == kLetter) {
+        end = scanner.run(next, kLetter);
+      } else if (cls == kNumber) {
+        end = scanner.run(pos, kNumber, 3);
+      } else if (cls == kOther || (c == ' ' && next < scanner.length() &&
+                                   next_cls == kOther)) {
+        end = scanner.run(cls == kOther ? pos : next, kOther);
+        while (end < scanner.length() &&
+               (input.charAt(end) == '\r' || input.charAt(end) == '\n')) {
+          end++;
+        }
+      } else {
+        // \s*[\r\n]+ ends after the last line break of the whitespace run
+        end = -1;
+        int ws = pos;
+        while (ws < scanner.length()) {
+          UChar32 w = scanner.at(ws, &next);
+          if (charClass(w) != kWhitespace)
+            break;
+          if (w == '\r' || w == '\n')
+            end = next;
+          ws = next;
+        }
+        if (end < 0) {
+          end = scanner.whitespace(pos);
+        }
+      }
+    }
+    matches.emplace_back(pos, end);
+    pos = end;
+  }
+  return matches;
+}
+
+Metaspace::Metaspace(const std::string& replacement,
+                     PrependScheme prepend_scheme, bool split)
+    : replacement_(icu::UnicodeString::fromUTF8(replacement).char32At(0)),
+      prepend_scheme_(prepend_scheme),
+      split_(split) {}
+
+// Spaces are replaced while walking the input once, and with split the
+// pieces are cut in the same pass (MergedWithNext on the replacement).
+PreTokenizerResult Metaspace::PreTokenize(const PreTokenizerResult& input) {
+  bool track_offsets = !input.char_offsets.empty();
+  PreTokenizerResult result;
+  result.pre_tokenized.reserve(input.pre_tokenized.size());
+  result.char_offsets.reserve(input.pre_tokenized.size());
+  result.offsets.reserve(input.pre_tokenized.size());
+  result.at_start = input.at_start;
+  icu::UnicodeString current;
+  std::vector<std::pair<int, int>> current_char_offsets;
+  auto flush = [&]() {
+    if (current.isEmpty())
+      return;
+    result.pre_tokenized.emplace_back(std::move(current));
+    current.remove();
+    if (track_offsets) {
+      result.offsets.emplace_back(current_char_offsets.front().first,
+                                  current_char_offsets.back().second);
+      result.char_offsets.emplace_back(std::move(current_char_offsets));
+      current_char_offsets.clear();
+    }
+  };
+
+  for (int i = 0; i < input.pre_tokenized.size(); i++) {
+    const icu::UnicodeString& token = input.pre_tokenized[i];
+    if (token.isEmpty())
+      continue;
+
+    int start = track_offsets ? input.char_offsets[i].front().first : 0;
+    bool at_start = track_offsets ? start == 0 : input.at_start && i == 0;
+    bool prepend = prepend_scheme_ == PrependScheme::kAlways ||
+                   (prepend_scheme_ == PrependScheme::kFirst && at_start);
+    UChar32 first = token.char32At(0);
+    if (prepend && first != ' ' && first != replacement_) {
+      current.append(replacement_);
+      if (track_offsets)
+        current_char_offsets.emplace_back(start, start);
+    }
+
+    icu::StringCharacterIterator it(token);
+    int char_idx = 0;
+    for (it.first(); it.hasNext(); char_idx++) {
+      UChar32 c = it.next32PostInc();
+      if (c == ' ') {
+        c = replacement_;
+      }
+      if (split_ && c == replacement_) {
+        flush();
+      }
+      current.append(c);
+      if (track_offsets)
+        current_char_offsets.emplace_back(input.char_offsets[i][char_idx]);
+    }
+    flush();
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+Metaspace::PreTokenizeString(const std::string& input) {
+  icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+  PreTokenizerResult pre_tokenized = PreTokenizerResult(unicode_input);
+  pre_tokenized = PreTokenize(pre_tokenized);
+  std::vector<std::pair<std::string, std::pair<int, int>>> result;
+  result.reserve(pre_tokenized.pre_tokenized.size());
+  for (int i = 0; i < pre_tokenized.pre_tokenized.size(); i++) {
+    std::string str;
+    pre_tokenized.pre_tokenized[i].toUTF8String(str);
+    result.emplace_back(str, pre_tokenized.offsets[i]);
+  }
+  return result;
+}
+
+WhitespaceSplit::WhitespaceSplit() {}
+
+PreTokenizerResult WhitespaceSplit::PreTokenize(
+    const PreTokenizerResult& input) {
+  return splitChars(input, [this](UChar32 c) { return Classify(c); });
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+WhitespaceSplit::PreTokenizeString(const std::string& input) {
+  return preTokenizeString(this, input);
+}
+
+namespace {
+
+CharAction toCharAction(SplitDelimiterBehavior behavior) {
+  switch (behavior) {
+    case SplitDelimiterBehavior::kRemoved:
+      return CharAction::kRemove;
+    case SplitDelimiterBehavior::kIsolated:
+      return CharAction::kIsolate;
+    case SplitDelimiterBehavior::kMergedWithPrevious:
+      return CharAction::kMergeWithPrevious;
+    case SplitDelimiterBehavior::kMergedWithNext:
+      return CharAction::kMergeWithNext;
+    case SplitDelimiterBehavior::kContiguous:
+      return CharAction::kContiguous;
+  }
+  return CharAction::kIsolate;
+}
+
+} // namespace
+
+Punctuation::Punctuation(SplitDelimiterBehavior behavior)
+    : action_(toCharAction(behavior)) {}
+
+PreTokenizerResult Punctuation::PreTokenize(const PreTokenizerResult& input) {
+  return splitChars(input, [this](UChar32 c) { return Classify(c); });
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+Punctuation::PreTokenizeString(const std::string& input) {
+  return preTokenizeString(this, input);
+}
+
+Digits::Digits(bool individual_digits)
+    : individual_digits_(individual_digits) {}
+
+PreTokenizerResult Digits::PreTokenize(const PreTokenizerResult& input) {
+  return splitChars(input, [this](UChar32 c) { return Classify(c); });
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+Digits::PreTokenizeString(const std::string& input) {
+  return preTokenizeString(this, input);
+}
+
+FusedSplit::FusedSplit(const std::vector<CharPreTokenizer>& steps)
+    : steps_(steps) {}
+
+CharAction FusedSplit::Classify(UChar32 c) const {
+  CharAction action = CharAction::kKeep;
+  for (const CharPreTokenizer& step : steps_) {
+    CharAction step_action =
+        std::visit([c](const auto& s) { return s.Classify(c); }, step);
+    if (step_action == CharAction::kRemove)
+      return step_action;
+    if (step_action == CharAction::kIsolate ||
+        (step_action == CharAction::kContiguous &&
+         action == CharAction::kKeep)) {
+      action = step_action;
+    }
+  }
+  return action;
+}
+
+PreTokenizerResult FusedSplit::PreTokenize(const PreTokenizerResult& input) {
+  return splitChars(input, [this](UChar32 c) { return Classify(c); });
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+FusedSplit::PreTokenizeString(const std::string& input) {
+  return preTokenizeString(this, input);
+}
+
+namespace {
+
+const char kGPT2Pattern[] =
+    R"('s|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+)"
+    R"(|\s+(?!\S)|\s+)";
+
+const char kLlama3Pattern[] =
+    R"((?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,3})"
+    R"(| ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+)";
+
+} // namespace
+
+Split::Split(const std::string& pattern, bool is_regex,
+             SplitDelimiterBehavior behavior, bool invert)
+    : pattern_(icu::UnicodeString::fromUTF8(pattern)),
+      behavior_(behavior),
+      invert_(invert),
+      splitter_(nullptr) {
+  if (!is_regex)
+    return;
+  if (pattern == kGPT2Pattern) {
+    splitter_ = splitGPT2;
+  } else if (pattern == kLlama3Pattern) {
+    splitter_ = splitLlama3;
+  } else {
+    UErrorCode status = U_ZERO_ERROR;
+    UParseError parse_error;
+    regex_.reset(icu::RegexPattern::compile(pattern_, parse_error, status));
+    if (U_FAILURE(status)) {
+      throw std::invalid_argument("invalid split pattern: " + pattern);
+    }
+  }
+}
+
+std::vector<std::pair<int, int>> Split::Matches(
+    const icu::UnicodeString& input) const {
+  if (splitter_ != nullptr)
+    return splitter_(input);
+  std::vector<std::pair<int, int>> matches;
+  if (regex_) {
+    UErrorCode status = U_ZERO_ERROR;
+    std::unique_ptr<icu::RegexMatcher> matcher(regex_->matcher(input, status));
+    while (U_SUCCESS(status) && matcher->find(status)) {
+      int start = matcher->start(status);
+      int end = matcher->end(status);
+      if (end > start)
+        matches.emplace_back(start, end);
+    }
+  } else if (!pattern_.isEmpty()) {
+    for (int pos = input.indexOf(pattern_); pos >= 0;
+         pos = input.indexOf(pattern_, pos + pattern_.length())) {
+      matches.emplace_back(pos, pos + pattern_.length());
+    }
+  }
+  return matches;
+}
+
+// Matches are the delimiters (the pieces in between with invert), pieces are
+// then cut on code unit boundaries and mapped back to code point offsets.
+PreTokenizerResult Split::PreTokenize(const PreTokenizerResult& input) {
+  PreTokenizerResult result;
+  result.pre_tokenized.reserve(input.pre_tokenized.size());
+  result.char_offsets.reserve(input.pre_tokenized.size());
+  result.offsets.reserve(input.pre_tokenized.size());
+  bool track_offsets = !input.char_offsets.empty();
+  std::vector<int> unit_chars;
+  for (int i = 0; i < input.pre_tokenized.size(); i++) {
+    const icu::UnicodeString& token = input.pre_tokenized[i];
+    int length = token.length();
+    if (track_offsets) {
+      unit_chars.assign(length + 1, 0);
+      for (int pos = 0, char_idx = 0; pos < length; char_idx++) {
+        int next = token.moveIndex32(pos, 1);
+        for (; pos < next; pos++) {
+          unit_chars[pos] = char_idx;
+        }
+        unit_chars[next] = char_idx + 1;
+      }
+    }
+    auto emit = [&](int start, int end) {
+      if (start >= end)
+        return;
+      if (result.pre_tokenized.empty())
+        result.at_start = input.at_start && i == 0 && start == 0;
+      result.pre_tokenized.emplace_back(token, start, end - start);
+      if (!track_offsets)
+        return;
+      const std::vector<std::pair<int, int>>& token_char_offsets =
+          input.char_offsets[i];
+      result.char_offsets.emplace_back(
+          token_char_offsets.begin() + unit_chars[start],
+          token_char_offsets.begin() + unit_chars[end]);
+      result.offsets.emplace_back(result.char_offsets.back().front().first,
+                                  result.char_offsets.back().back().second);
+    };
+
+    // Alternating (gap, delimiter) ranges covering the whole piece.
+    std::vector<std::pair<int, int>> matches = Matches(token);
+    std::vector<std::pair<int, int>> delimiters;
+    if (invert_) {
+      int pos = 0;
+      for (const std::pair<int, int>& match : matches) {
+        delimiters.emplace_back(pos, match.first);
+        pos = match.second;
+      }
+      delimiters.emplace_back(pos, length);
+    } else {
+      delimiters = std::move(matches);
+    }
+    if (behavior_ == SplitDelimiterBehavior::kContiguous) {
+      std::vector<std::pair<int, int>> merged;
+      for (const std::pair<int, int>& delimiter : delimiters) {
+        if (!merged.empty() && merged.back().second == delimiter.first) {
+          merged.back().second = delimiter.second;
+        } else {
+          merged.push_back(delimiter);
+        }
+      }
+      delimiters = std::move(merged);
+    }
+
+    int pos = 0;
+    int pending = 0;
+    for (const std::pair<int, int>& delimiter : delimiters) {
+      switch (behavior_) {
+        case SplitDelimiterBehavior::kRemoved:
+          emit(pos, delimiter.first);
+          break;
+        case SplitDelimiterBehavior::kIsolated:
+        case SplitDelimiterBehavior::kContiguous:
+          emit(pos, delimiter.first);
+          emit(delimiter.first, delimiter.second);
+          break;
+        case SplitDelimiterBehavior::kMergedWithPrevious:
+          emit(pos, delimiter.second);
+          break;
+        case SplitDelimiterBehavior::kMergedWithNext:
+          emit(pending, delimiter.first);
+          pending = delimiter.first;
+          break;
+      }
+      pos = delimiter.second;
+    }
+    emit(behavior_ == SplitDelimiterBehavior::kMergedWithNext ? pending : pos,
+         length);
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+Split::PreTokenizeString(const std::string& input) {
+  return preTokenizeString(this, input);
+}
+
+Sequence::Sequence(
+    const std::vector<std::shared_ptr<PreTokenizer>>& pre_tokenizers)
+    : pre_tokenizers_(pre_tokenizers) {}
+
+PreTokenizerResult Sequence::PreTokenize(const PreTokenizerResult& input) {
+  PreTokenizerResult result = input;
+  for (const std::shared_ptr<PreTokenizer>& pre_tokenizer : pre_tokenizers_) {
+    result = pre_tokenizer->PreTokenize(result);
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+Sequence::PreTokenizeString(const std::string& input) {
+  return preTokenizeString(this, input);
+}
+
+namespace {
+
+std::optional<CharPreTokenizer> asCharPreTokenizer(
+    const std::shared_ptr<PreTokenizer>& pre_tokenizer) {
+  if (auto whitespace =
+          std::dynamic_pointer_cast<WhitespaceSplit>(pre_tokenizer))
+    return *whitespace;
+  if (auto punctuation =
+          std::dynamic_pointer_cast<Punctuation>(pre_tokenizer)) {
+    // Merged behaviors depend on the order of the steps, those run alone.
+    CharAction action = punctuation->Classify('!');
+    if (action == CharAction::kMergeWithPrevious ||
+        action == CharAction::kMergeWithNext)
+      return std::nullopt;
+    return *punctuation;
+  }
+  if (auto digits = std::dynamic_pointer_cast<Digits>(pre_tokenizer))
+    return *digits;
+  return std::nullopt;
+}
+
+// Whether the step keeps runs of the code points it splits off together.
+bool isContiguous(const CharPreTokenizer& step) {
+  return std::visit(
+      [](const auto& s) {
+        return s.Classify('!') == CharAction::kContiguous ||
+               s.Classify('0') == CharAction::kContiguous;
+      },
+      step);
+}
+
+} // namespace
+
+std::shared_ptr<PreTokenizer> fusePreTokenizers(
+    const std::vector<std::shared_ptr<PreTokenizer>>& pre_tokenizers) {
+  std::vector<std::shared_ptr<PreTokenizer>> stages;
+  std::vector<std::shared_ptr<PreTokenizer>> group;
+  std::vector<CharPreTokenizer> group_steps;
+  bool group_contiguous = false;
+  auto flush = [&]() {
+    if (group.size() == 1) {
+      stages.push_back(group.front());
+    } else if (group.size() > 1) {
+      stages.push_back(std::make_shared<FusedSplit>(group_steps));
+    }
+    group.clear();
+    group_steps.clear();
+    group_contiguous = false;
+  };
+  for (const std::shared_ptr<PreTokenizer>& pre_tokenizer : pre_tokenizers) {
+    if (!pre_tokenizer)
+      throw std::invalid_argument("unsupported pre-tokenizer in sequence");
+    std::optional<CharPreTokenizer> step = asCharPreTokenizer(pre_tokenizer);
+    if (step) {
+      // The runs of two contiguous steps would fuse into one, so they go in
+      // separate groups.
+      bool contiguous = isContiguous(*step);
+      if (contiguous && group_contiguous)
+        flush();
+      group_contiguous = group_contiguous || contiguous;
+      group.push_back(pre_tokenizer);
+      group_steps.push_back(std::move(*step));
+      continue;
+    }
+    flush();
+    stages.push_back(pre_tokenizer);
+  }
+  flush();
+  if (stages.size() == 1)
+    return stages.front();
+  return std::make_shared<Sequence>(stages);
+}
+
+UChar32 byteToUnicode(uint8_t byte) {
+  // Printable bytes map to themselves, the rest to 256 and up in order.
+  static const std::array<UChar32, 256> table = [] {
+    std::array<UChar32, 256> bytes;
+    int n = 0;
+    for (int b = 0; b < 256; b++) {
+      bool printable = (b >= '!' && b <= '~') || (b >= 0xA1 && b <= 0xAC) ||
+                       (b >= 0xAE && b <= 0xFF);
+      bytes[b] = printable ? b : 256 + n++;
+    }
+    return bytes;
+  }();
+  return table[byte];
+}
+
+ByteLevel::ByteLevel(bool add_prefix_space, bool use_regex)
+    : add_prefix_space_(add_prefix_space), use_regex_(use_regex) {}
+
+PreTokenizerResult ByteLevel::PreTokenize(const PreTokenizerResult& input) {
+  bool track_offsets = !input.char_offsets.empty();
+  PreTokenizerResult result;
+  result.at_start = input.at_start;
+  result.pre_tokenized.reserve(input.pre_tokenized.size());
+  result.char_offsets.reserve(input.pre_tokenized.size());
+  result.offsets.reserve(input.pre_tokenized.size());
+  const std::vector<std::pair<int, int>> untracked_char_offsets;
+  for (int i = 0; i < input.pre_tokenized.size(); i++) {
+    const icu::UnicodeString* token = &input.pre_tokenized[i];
+    const std::vector<std::pair<int, int>>* token_char_offsets =
+        track_offsets ? &input.char_offsets[i] : &untracked_char_offsets;
+    if (token->isEmpty())
+      continue;
+
+    icu::UnicodeString prefixed;
+    std::vector<std::pair<int, int>> prefixed_char_offsets;
+    if (add_prefix_space_ && token->charAt(0) != ' ') {
+      prefixed.append(' ').append(*token);
+      if (track_offsets) {
+        prefixed_char_offsets.reserve(token_char_offsets->size() + 1);
+        int start = token_char_offsets->front().first;
+        prefixed_char_offsets.emplace_back(start, start);
+        prefixed_char_offsets.insert(prefixed_char_offsets.end(),
+                                     token_char_offsets->begin(),
+                                     token_char_offsets->end());
+        token_char_offsets = &prefixed_char_offsets;
+      }
+      token = &prefixed;
+    }
+
+    std::vector<std::pair<int, int>> ranges =
+        use_regex_ ? splitGPT2(*token)
+                   : std::vector<std::pair<int, int>>{{0, token->length()}};
+    const UChar* buffer = token->getBuffer();
+    int length = token->length();
+    int char_idx = 0;
+    for (const std::pair<int, int>& range : ranges) {
+      int max_bytes = (range.second - range.first) * 3;
+      icu::UnicodeString mapped(max_bytes, 0, 0);
+      std::vector<std::pair<int, int>> mapped_char_offsets;
+      if (track_offsets)
+        mapped_char_offsets.reserve(max_bytes);
+      for (int pos = range.first; pos < range.second;) {
+        UChar32 c;
+        U16_NEXT(buffer, pos, length, c);
+        uint8_t bytes[U8_MAX_LENGTH];
+        int num_bytes = 0;
+        U8_APPEND_UNSAFE(bytes, num_bytes, c);
+        for (int b = 0; b < num_bytes; b++) {
+          mapped.append(static_cast<UChar>(byteToUnicode(bytes[b])));
+          if (track_offsets)
+            mapped_char_offsets.emplace_back((*token_char_offsets)[char_idx]);
+        }
+        char_idx++;
+      }
+      result.pre_tokenized.emplace_back(std::move(mapped));
+      if (track_offsets) {
+        result.offsets.emplace_back(mapped_char_offsets.front().first,
+                                    mapped_char_offsets.back().second);
+        result.char_offsets.emplace_back(std::move(mapped_char_offsets));
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, std::pair<int, int>>>
+ByteLevel::PreTokenizeString(const std::string& input) {
+  icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+  PreTokenizerResult pre_tokenized = PreTokenizerResult(unicode_input);
+  pre_tokenized = PreTokenize(pre_tokenized);
+  std::vector<std::pair<std::string, std::pair<int, int>>> result;
+  result.reserve(pre_tokenized.pre_tokenized.size());
+  for (int i = 0; i < pre_tokenized.pre_tokenized.size(); i++) {
+    std::string str;
+    pre_tokenized.pre_tokenized[i].toUTF8String(str);
+    result.emplace_back(str, pre_tokenized.offsets[i]);
+  }
+  return result;
+}
+
 } // namespace pre_tokenizers
 
 } // namespace tokenizers
@@ -0,0 +1,273 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/registry.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tokenizers/tokenizer.h"
+
+namespace tokenizers {
+
+namespace {
+
+uint32_t rotateRight(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+// SHA-256 of the config bytes (FIPS 180-4). Unlike a fast hash, configs
+// cannot be crafted to collide with the config of another tokenizer.
+std::array<uint8_t, 32> digestConfig(const std::string& json_config) {
+  static const uint32_t kRounds[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+      0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+      0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+      0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+      0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+      0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+      0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+      0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+  uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                       0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  // The message, a one bit, zeros and the bit length, in 64 byte blocks.
+  std::string message = json_config;
+  uint64_t bits = static_cast<uint64_t>(json_config.size()) * 8;
+  message.push_back(static_cast<char>(0x80));
+  while (message.size() % 64 != 56) message.push_back(0);
+  for (int i = 7; i >= 0; i--) {
+    message.push_back(static_cast<char>(bits >> (8 * i)));
+  }
+  for (size_t block = 0; block < message.size(); block += 64) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+      w[i] = 0;
+      for (int j = 0; j < 4; j++) {
+        w[i] = w[i] << 8 |
+               static_cast<unsigned char>(message[block + 4 * i + j]);
+      }
+    }
+    for (int i = 16; i < 64; i++) {
+      uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^
+                    (w[i - 15] >> 3);
+      uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^
+                    (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+      uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+      uint32_t choose = (e & f) ^ (~e & g);
+      uint32_t t1 = h + s1 + choose + kRounds[i] + w[i];
+      uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+      uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t t2 = s0 + majority;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+  std::array<uint8_t, 32> digest;
+  for (int i = 0; i < 32; i++) {
+    digest[i] = static_cast<uint8_t>(state[i / 4] >> (24 - 8 * (i % 4)));
+  }
+  return digest;
+}
+
+std::string hexDigest(const std::array<uint8_t, 32>& digest) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  std::string hex;
+  for (uint8_t byte : digest) {
+    hex.push_back(kHexDigits[byte >> 4]);
+    hex.push_back(kHexDigits[byte & 0xF]);
+  }
+  return hex;
+}
+
+} // namespace
+
+TokenizerRegistry::TokenizerRegistry(size_t memory_budget)
+    : memory_budget_(memory_budget) {}
+
+void TokenizerRegistry::Register(const std::string& name,
+                                 std::function<std::string()> load_config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  names_[name] = Name{std::move(load_config), std::nullopt};
+}
+
+void TokenizerRegistry::RegisterFile(const std::string& name,
+                                     const std::string& path) {
+  Register(name, [path]() {
+    std::ifstream file(path);
+    if (!file) {
+      throw std::invalid_argument("could not read tokenizer config " + path);
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+  });
+}
+
+std::shared_ptr<const Tokenizer> TokenizerRegistry::Get(
+    const std::string& name) {
+  std::function<std::string()> load_config;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = names_.find(name);
+    if (it == names_.end()) {
+      throw std::out_of_range("unknown tokenizer " + name);
+    }
+    if (it->second.key) {
+      if (std::shared_ptr<const Tokenizer> tokenizer =
+              Find(*it->second.key)) {
+        return tokenizer;
+      }
+    }
+    load_config = it->second.load_config;
+  }
+  std::string json_config = load_config();
+  Key key = digestConfig(json_config);
+  std::shared_ptr<const Tokenizer> tokenizer = Load(json_config, key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  names_[name].key = key;
+  return tokenizer;
+}
+
+std::shared_ptr<const Tokenizer> TokenizerRegistry::Load(
+    const std::string& json_config) {
+  return Load(json_config, digestConfig(json_config));
+}
+
+std::shared_ptr<const Tokenizer> TokenizerRegistry::Load(
+    const std::string& json_config, const Key& key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::shared_ptr<const Tokenizer> tokenizer = Find(key)) {
+      return tokenizer;
+    }
+  }
+  // Parsing dominates, so it runs unlocked. If another thread loads the
+  // same config meanwhile, its tokenizer wins and this one is dropped.
+  std::shared_ptr<const Tokenizer> tokenizer =
+      std::make_shared<const Tokenizer>(json_config);
+  int built_tables = tokenizer->BuiltTables();
+  size_t memory_usage = tokenizer->MemoryUsage();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (std::shared_ptr<const Tokenizer> loaded = Find(key)) {
+    return loaded;
+  }
+  Entry& entry = entries_[key];
+  entry.tokenizer = tokenizer;
+  entry.shared = tokenizer;
+  entry.memory_usage = memory_usage;
+  entry.built_tables = built_tables;
+  memory_usage_ += memory_usage;
+  entry.lru = lru_.insert(lru_.begin(), key);
+  Evict();
+  return tokenizer;
+}
+
+size_t TokenizerRegistry::memory_usage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_usage_;
+}
+
+std::vector<TokenizerRegistryEntry> TokenizerRegistry::Entries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<TokenizerRegistryEntry> result;
+  auto add = [&](const Key& key, const Entry& entry) {
+    TokenizerRegistryEntry info{hexDigest(key), entry.memory_usage,
+                                entry.tokenizer != nullptr, {}};
+    for (const auto& [name, registered] : names_) {
+      if (registered.key == key) info.names.emplace_back(name);
+    }
+    std::sort(info.names.begin(), info.names.end());
+    result.emplace_back(std::move(info));
+  };
+  for (const Key& key : lru_) {
+    add(key, entries_.at(key));
+  }
+  for (const auto& [key, entry] : entries_) {
+    if (!entry.tokenizer && !entry.shared.expired()) add(key, entry);
+  }
+  return result;
+}
+
+std::shared_ptr<const Tokenizer> TokenizerRegistry::Find(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  Entry& entry = it->second;
+  if (entry.tokenizer) {
+    lru_.splice(lru_.begin(), lru_, entry.lru);
+    return entry.tokenizer;
+  }
+  std::shared_ptr<const Tokenizer> tokenizer = entry.shared.lock();
+  if (!tokenizer) {
+    entries_.erase(it);
+    return nullptr;
+  }
+  // Evicted but still in use elsewhere, make it resident again.
+  entry.tokenizer = tokenizer;
+  memory_usage_ += entry.memory_usage;
+  entry.lru = lru_.insert(lru_.begin(), key);
+  Evict();
+  return tokenizer;
+}
+
+void TokenizerRegistry::Evict() {
+  // Measuring walks the vocabularies, so only tokenizers that built a table
+  // since they were last measured are.
+  for (const Key& key : lru_) {
+    Entry& entry = entries_.at(key);
+    int built_tables = entry.tokenizer->BuiltTables();
+    if (built_tables == entry.built_tables)
+      continue;
+    entry.built_tables = built_tables;
+    size_t memory_usage = entry.tokenizer->MemoryUsage();
+    memory_usage_ = memory_usage_ - entry.memory_usage + memory_usage;
+    entry.memory_usage = memory_usage;
+  }
+  // The most recently used tokenizer stays even when it alone is over budget.
+  while (memory_budget_ > 0 && memory_usage_ > memory_budget_ &&
+         lru_.size() > 1) {
+    auto it = entries_.find(lru_.back());
+    lru_.pop_back();
+    memory_usage_ -= it->second.memory_usage;
+    it->second.tokenizer.reset();
+  }
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (!it->second.tokenizer && it->second.shared.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+} // namespace tokenizers
@@ -0,0 +1,72 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace tokenizers {
+
+namespace {
+
+constexpr std::memory_order kRelaxed = std::memory_order_relaxed;
+
+} // namespace
+
+void StatsCollector::RecordEncode(uint64_t bytes_in, uint64_t tokens_out) {
+  encode_calls_.fetch_add(1, kRelaxed);
+  bytes_in_.fetch_add(bytes_in, kRelaxed);
+  tokens_out_.fetch_add(tokens_out, kRelaxed);
+}
+
+void StatsCollector::RecordUnkTokens(uint64_t unk_tokens) {
+  unk_tokens_.fetch_add(unk_tokens, kRelaxed);
+}
+
+void StatsCollector::RecordStage(Stage stage, Clock::time_point* start,
+                                 uint64_t bytes_in, uint64_t bytes_out,
+                                 uint64_t tokens_out) {
+  Clock::time_point now = Clock::now();
+  AtomicStageStats& stats = stages_[static_cast<int>(stage)];
+  stats.calls.fetch_add(1, kRelaxed);
+  stats.nanoseconds.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - *start)
+          .count(),
+      kRelaxed);
+  stats.bytes_in.fetch_add(bytes_in, kRelaxed);
+  stats.bytes_out.fetch_add(bytes_out, kRelaxed);
+  stats.tokens_out.fetch_add(tokens_out, kRelaxed);
+  *start = now;
+}
+
+TokenizerStats StatsCollector::Snapshot() const {
+  TokenizerStats snapshot;
+  snapshot.encode_calls = encode_calls_.load(kRelaxed);
+  snapshot.bytes_in = bytes_in_.load(kRelaxed);
+  snapshot.tokens_out = tokens_out_.load(kRelaxed);
+  snapshot.unk_tokens = unk_tokens_.load(kRelaxed);
+  for (int i = 0; i < stages_.size(); i++) {
+    snapshot.stages[i].calls = stages_[i].calls.load(kRelaxed);
+    snapshot.stages[i].nanoseconds = stages_[i].nanoseconds.load(kRelaxed);
+    snapshot.stages[i].bytes_in = stages_[i].bytes_in.load(kRelaxed);
+    snapshot.stages[i].bytes_out = stages_[i].bytes_out.load(kRelaxed);
+    snapshot.stages[i].tokens_out = stages_[i].tokens_out.load(kRelaxed);
+  }
+  return snapshot;
+}
+
+void StatsCollector::Reset() {
+  encode_calls_.store(0, kRelaxed);
+  bytes_in_.store(0, kRelaxed);
+  tokens_out_.store(0, kRelaxed);
+  unk_tokens_.store(0, kRelaxed);
+  for (AtomicStageStats& stats : stages_) {
+    stats.calls.store(0, kRelaxed);
+    stats.nanoseconds.store(0, kRelaxed);
+    stats.bytes_in.store(0, kRelaxed);
+    stats.bytes_out.store(0, kRelaxed);
+    stats.tokens_out.store(0, kRelaxed);
+  }
+}
+
+} // namespace tokenizers
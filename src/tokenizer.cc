@@ -2,15 +2,25 @@
 #include "tokenizers/tokenizer.h"
 
 #include <simdjson.h>
+#include <unicode/uchar.h>
 #include <unicode/unistr.h>
+#include <unicode/utf16.h>
+#include <unicode/utf8.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "tokenizers/common.h"
+#include "tokenizers/unicode.h"
 
 namespace tokenizers {
 
@@ -50,6 +60,36 @@ std::shared_ptr<AddedVocabulary> parseAddedVocabulary(
   return nullptr;
 }
 
+namespace {
+
+// "pattern": {"String": "..."} or {"Regex": "..."}
+std::string parsePattern(simdjson::ondemand::value& config, bool* is_regex) {
+  *is_regex = false;
+  auto pattern_result = config["pattern"].get_object();
+  if (pattern_result.error() != simdjson::SUCCESS)
+    return "";
+  for (auto field : pattern_result) {
+    *is_regex = std::string_view(field.unescaped_key().value()) == "Regex";
+    return std::string(field.value().get_string().value());
+  }
+  return "";
+}
+
+pre_tokenizers::SplitDelimiterBehavior parseSplitDelimiterBehavior(
+    const std::string& behavior) {
+  if (behavior == "Removed")
+    return pre_tokenizers::SplitDelimiterBehavior::kRemoved;
+  if (behavior == "MergedWithPrevious")
+    return pre_tokenizers::SplitDelimiterBehavior::kMergedWithPrevious;
+  if (behavior == "MergedWithNext")
+    return pre_tokenizers::SplitDelimiterBehavior::kMergedWithNext;
+  if (behavior == "Contiguous")
+    return pre_tokenizers::SplitDelimiterBehavior::kContiguous;
+  return pre_tokenizers::SplitDelimiterBehavior::kIsolated;
+}
+
+} // namespace
+
 std::shared_ptr<normalizers::Normalizer> parseNormalizer(
     simdjson::ondemand::value& config) {
   if (config.is_null())
@@ -57,6 +97,53 @@ std::shared_ptr<normalizers::Normalizer> parseNormalizer(
 
   std::string type = get_string_or_default(std::move(config), "type");
 
+  if (type == "Sequence") {
+    std::vector<std::shared_ptr<normalizers::Normalizer>> normalizers;
+    for (auto element : config["normalizers"].get_array()) {
+      simdjson::ondemand::value normalizer_config = element.value();
+      normalizers.push_back(parseNormalizer(normalizer_config));
+    }
+    return normalizers::fuseNormalizers(normalizers);
+  }
+
+  if (type == "NFC") {
+    return std::make_shared<normalizers::NFC>();
+  }
+
+  if (type == "NFD") {
+    return std::make_shared<normalizers::NFD>();
+  }
+
+  if (type == "NFKC") {
+    return std::make_shared<normalizers::NFKC>();
+  }
+
+  if (type == "NFKD") {
+    return std::make_shared<normalizers::NFKD>();
+  }
+
+  if (type == "Lowercase") {
+    return std::make_shared<normalizers::Lowercase>();
+  }
+
+  if (type == "StripAccents") {
+    return std::make_shared<normalizers::StripAccents>();
+  }
+
+  if (type == "Replace") {
+    bool is_regex;
+    std::string pattern = parsePattern(config, &is_regex);
+    if (is_regex)
+      return nullptr;
+    return std::make_shared<normalizers::Replace>(
+        pattern, get_string_or_default(std::move(config), "content"));
+  }
+
+  if (type == "Prepend") {
+    return std::make_shared<normalizers::Prepend>(
+        get_string_or_default(std::move(config), "prepend"));
+  }
+
   if (type == "BertNormalizer") {
     return std::make_shared<normalizers::BertNormalizer>(
         get_bool_or_default(std::move(config), "clean_text"),
@@ -75,10 +162,67 @@ std::shared_ptr<pre_tokenizers::PreTokenizer> parsePreTokenizer(
 
   std::string type = get_string_or_default(std::move(config), "type");
 
+  if (type == "Sequence") {
+    std::vector<std::shared_ptr<pre_tokenizers::PreTokenizer>> pre_tokenizers;
+    for (auto element : config["pretokenizers"].get_array()) {
+      simdjson::ondemand::value pre_tokenizer_config = element.value();
+      pre_tokenizers.push_back(parsePreTokenizer(pre_tokenizer_config));
+    }
+    return pre_tokenizers::fusePreTokenizers(pre_tokenizers);
+  }
+
   if (type == "BertPreTokenizer") {
     return std::make_shared<pre_tokenizers::BertPreTokenizer>();
   }
 
+  if (type == "WhitespaceSplit") {
+    return std::make_shared<pre_tokenizers::WhitespaceSplit>();
+  }
+
+  if (type == "Punctuation") {
+    return std::make_shared<pre_tokenizers::Punctuation>(
+        parseSplitDelimiterBehavior(
+            get_string_or_default(std::move(config), "behavior", "Isolated")));
+  }
+
+  if (type == "Digits") {
+    return std::make_shared<pre_tokenizers::Digits>(
+        get_bool_or_default(std::move(config), "individual_digits", false));
+  }
+
+  if (type == "Split") {
+    bool is_regex;
+    std::string pattern = parsePattern(config, &is_regex);
+    return std::make_shared<pre_tokenizers::Split>(
+        pattern, is_regex,
+        parseSplitDelimiterBehavior(
+            get_string_or_default(std::move(config), "behavior", "Isolated")),
+        get_bool_or_default(std::move(config), "invert", false));
+  }
+
+  if (type == "ByteLevel") {
+    return std::make_shared<pre_tokenizers::ByteLevel>(
+        get_bool_or_default(std::move(config), "add_prefix_space", true),
+        get_bool_or_default(std::move(config), "use_regex", true));
+  }
+
+  if (type == "Metaspace") {
+    std::string prepend_scheme =
+        get_string_or_default(std::move(config), "prepend_scheme");
+    if (prepend_scheme.empty()) {
+      prepend_scheme =
+          get_bool_or_default(std::move(config), "add_prefix_space", true)
+              ? "always"
+              : "never";
+    }
+    return std::make_shared<pre_tokenizers::Metaspace>(
+        get_string_or_default(std::move(config), "replacement", "\u2581"),
+        prepend_scheme == "first"   ? pre_tokenizers::PrependScheme::kFirst
+        : prepend_scheme == "never" ? pre_tokenizers::PrependScheme::kNever
+                                    : pre_tokenizers::PrependScheme::kAlways,
+        get_bool_or_default(std::move(config), "split", true));
+  }
+
   return nullptr;
 }
 
@@ -101,6 +245,57 @@ std::shared_ptr<models::Model> parseModel(simdjson::ondemand::value& config) {
         get_int64_or_default(std::move(config), "max_input_chars_per_word", 0));
   }
 
+  if (type == "BPE") {
+    std::unordered_map<std::string, int> vocab;
+    for (auto element : config["vocab"].get_object()) {
+      vocab[std::string(element.unescaped_key().value())] =
+          static_cast<int>(static_cast<int64_t>(element.value()));
+    }
+
+    // merges are either "left right" strings or ["left", "right"] arrays
+    std::vector<std::pair<std::string, std::string>> merges;
+    for (auto element : config["merges"].get_array()) {
+      if (element.type() == simdjson::ondemand::json_type::array) {
+        std::vector<std::string> parts;
+        for (auto part : element.get_array()) {
+          parts.emplace_back(std::string(part.get_string().value()));
+        }
+        if (parts.size() == 2) {
+          merges.emplace_back(parts[0], parts[1]);
+        }
+      } else {
+        std::string merge = std::string(element.get_string().value());
+        size_t space = merge.find(' ');
+        if (space != std::string::npos) {
+          merges.emplace_back(merge.substr(0, space), merge.substr(space + 1));
+        }
+      }
+    }
+
+    return std::make_shared<models::BPE>(
+        vocab, merges, get_string_or_default(std::move(config), "unk_token"),
+        get_string_or_default(std::move(config), "continuing_subword_prefix"),
+        get_string_or_default(std::move(config), "end_of_word_suffix"),
+        get_bool_or_default(std::move(config), "fuse_unk"),
+        get_bool_or_default(std::move(config), "byte_fallback"),
+        get_bool_or_default(std::move(config), "ignore_merges"));
+  }
+
+  if (type == "Unigram") {
+    std::vector<std::pair<std::string, double>> vocab;
+    for (auto element : config["vocab"].get_array()) {
+      auto piece = element.get_array();
+      auto it = piece.begin();
+      std::string token = std::string((*it).get_string().value());
+      ++it;
+      vocab.emplace_back(token, (*it).get_double().value());
+    }
+
+    return std::make_shared<models::Unigram>(
+        vocab, get_int64_or_default(std::move(config), "unk_id", -1),
+        get_bool_or_default(std::move(config), "byte_fallback"));
+  }
+
   return nullptr;
 }
 
@@ -175,12 +370,30 @@ std::shared_ptr<decoders::Decoder> parseDecoder(
         get_bool_or_default(std::move(config), "cleanup", true));
   }
 
+  if (type == "Metaspace") {
+    std::string prepend_scheme =
+        get_string_or_default(std::move(config), "prepend_scheme");
+    bool add_prefix_space =
+        prepend_scheme.empty()
+            ? get_bool_or_default(std::move(config), "add_prefix_space", true)
+            : prepend_scheme != "never";
+    return std::make_shared<decoders::Metaspace>(
+        get_string_or_default(std::move(config), "replacement", "\u2581"),
+        add_prefix_space);
+  }
+
+  if (type == "ByteLevel") {
+    return std::make_shared<decoders::ByteLevel>();
+  }
+
   return nullptr;
 }
 
-Tokenizer::Tokenizer() : version("") {}
+Tokenizer::Tokenizer()
+    : version(""), stats_(std::make_shared<StatsCollector>()) {}
 
-Tokenizer::Tokenizer(const std::string& json_config) {
+Tokenizer::Tokenizer(const std::string& json_config)
+    : stats_(std::make_shared<StatsCollector>()) {
   if (json_config.length() == 0) {
     throw std::invalid_argument(
         "json config is required for initializing a tokenizer");
@@ -203,119 +416,779 @@ Tokenizer::Tokenizer(const std::string& json_config) {
   decoder = parseDecoder(decoder_config);
 }
 
-Encoding Tokenizer::Encode(const std::string& input, bool add_special_tokens) {
-  icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
-  std::vector<Encoding> encodings = {EncodeSingleSequence(&unicode_input, 0)};
-  if (truncation.get() != nullptr) {
-    truncation->TruncateEncodings(encodings);
+namespace {
+
+uint64_t countTokens(const std::vector<Encoding>& encodings) {
+  uint64_t tokens = 0;
+  for (const Encoding& encoding : encodings) {
+    tokens += encoding.ids.size();
   }
-  if (add_special_tokens && post_processor.get() != nullptr) {
-    encodings = post_processor->ProcessEncodings(encodings);
+  return tokens;
+}
+
+// Chunks of a document can only be encoded separately when no step looks
+// across the whitespace they are split at.
+bool isChunkable(const std::shared_ptr<normalizers::Normalizer>& normalizer,
+                 const std::shared_ptr<pre_tokenizers::PreTokenizer>&
+                     pre_tokenizer,
+                 const std::shared_ptr<AddedVocabulary>& added_vocabulary) {
+  if (added_vocabulary && added_vocabulary->CrossesWhitespace())
+    return false;
+  using normalizers::BertNormalizer;
+  using normalizers::Lowercase;
+  using normalizers::NFC;
+  using normalizers::NFD;
+  using normalizers::NFKC;
+  using normalizers::NFKD;
+  using normalizers::StripAccents;
+  using pre_tokenizers::BertPreTokenizer;
+  using pre_tokenizers::WhitespaceSplit;
+  normalizers::Normalizer* n = normalizer.get();
+  bool chunkable_normalizer =
+      n == nullptr || dynamic_cast<BertNormalizer*>(n) ||
+      dynamic_cast<Lowercase*>(n) || dynamic_cast<StripAccents*>(n) ||
+      dynamic_cast<NFC*>(n) || dynamic_cast<NFD*>(n) ||
+      dynamic_cast<NFKC*>(n) || dynamic_cast<NFKD*>(n);
+  pre_tokenizers::PreTokenizer* p = pre_tokenizer.get();
+  return chunkable_normalizer && (dynamic_cast<BertPreTokenizer*>(p) ||
+                                  dynamic_cast<WhitespaceSplit*>(p));
+}
+
+// The number of UTF-16 code units of valid UTF-8 input: one per character,
+// two for those past the BMP, which take four bytes.
+int utf16Length(const std::string& input) {
+  int length = 0;
+  for (unsigned char c : input) {
+    if ((c & 0xC0) != 0x80) length++;
+    if (c >= 0xF0) length++;
   }
-  if (padding.get() != nullptr) {
-    padding->PadEncodings(encodings);
-  }
-  Encoding encoding;
-  for (const Encoding& enc : encodings) {
-    encoding.ids.insert(encoding.ids.end(), enc.ids.begin(), enc.ids.end());
-    encoding.tokens.insert(encoding.tokens.end(), enc.tokens.begin(),
-                           enc.tokens.end());
-    encoding.type_ids.insert(encoding.type_ids.end(), enc.type_ids.begin(),
-                             enc.type_ids.end());
-    encoding.offsets.insert(encoding.offsets.end(), enc.offsets.begin(),
-                            enc.offsets.end());
-    encoding.word_ids.insert(encoding.word_ids.end(), enc.word_ids.begin(),
-                             enc.word_ids.end());
-    encoding.special_tokens_mask.insert(encoding.special_tokens_mask.end(),
-                                        enc.special_tokens_mask.begin(),
-                                        enc.special_tokens_mask.end());
-    encoding.attention_mask.insert(encoding.attention_mask.end(),
-                                   enc.attention_mask.begin(),
-                                   enc.attention_mask.end());
+  return length;
+}
+
+// Splits into [start, end) ranges of at least kBatchChunkLength UTF-16 code
+// units, each ending right before whitespace.
+std::vector<std::pair<int, int>> chunkRanges(const icu::UnicodeString& input) {
+  std::vector<std::pair<int, int>> ranges;
+  int start = 0;
+  int length = input.length();
+  while (length - start > Tokenizer::kBatchChunkLength) {
+    int end = start + Tokenizer::kBatchChunkLength;
+    while (end < length && !unicode::IsUWhiteSpace(input.charAt(end))) {
+      end++;
+    }
+    if (end == length) {
+      break;
+    }
+    ranges.emplace_back(start, end);
+    start = end;
+  }
+  ranges.emplace_back(start, length);
+  return ranges;
+}
+
+// End of the chunk of UTF-8 input starting at `start`: right before the
+// first ASCII whitespace at least `length` bytes in.
+int utf8ChunkEnd(const std::string& input, int start, int length) {
+  int end = start + length;
+  while (end < input.size()) {
+    char c = input[end];
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+        c == '\f') {
+      return end;
+    }
+    end++;
+  }
+  return input.size();
+}
+
+// Length in offset_type units of the code units [start, end) of text.
+int offsetLength(const icu::UnicodeString& text, int start, int end,
+                 OffsetType offset_type) {
+  switch (offset_type) {
+    case OffsetType::kUtf16:
+      return end - start;
+    case OffsetType::kCodePoints:
+      return text.countChar32(start, end - start);
+    case OffsetType::kUtf8: {
+      const UChar* buffer = text.getBuffer();
+      int length = 0;
+      for (int pos = start; pos < end;) {
+        UChar32 c;
+        U16_NEXT(buffer, pos, end, c);
+        length += U8_LENGTH(c);
+      }
+      return length;
+    }
+  }
+  return end - start;
+}
+
+// Converts consecutive ranges of code units of text to offset_type units.
+std::vector<std::pair<int, int>> offsetRanges(
+    const icu::UnicodeString& text,
+    const std::vector<std::pair<int, int>>& ranges, OffsetType offset_type) {
+  if (offset_type == OffsetType::kUtf16)
+    return ranges;
+  std::vector<std::pair<int, int>> result;
+  result.reserve(ranges.size());
+  int pos = 0;
+  int offset = 0;
+  for (const std::pair<int, int>& range : ranges) {
+    offset += offsetLength(text, pos, range.first, offset_type);
+    int start = offset;
+    offset += offsetLength(text, range.first, range.second, offset_type);
+    result.emplace_back(start, offset);
+    pos = range.second;
+  }
+  return result;
+}
+
+// Maps the offsets of a token, in code units of pre_token, to the original
+// offsets of the code points it covers.
+std::pair<int, int> alignOffsets(
+    const icu::UnicodeString& pre_token,
+    const std::vector<std::pair<int, int>>& char_offsets,
+    const std::pair<int, int>& offsets) {
+  int num_chars = char_offsets.size();
+  bool one_unit_chars = pre_token.length() == num_chars;
+  auto char_index = [&](int unit) {
+    int index = one_unit_chars ? unit : pre_token.countChar32(0, unit);
+    return std::min(index, num_chars);
+  };
+  int start = char_index(offsets.first);
+  int end = char_index(offsets.second);
+  if (start >= end) {
+    int at = start < num_chars ? char_offsets[start].first
+                               : char_offsets.back().second;
+    return {at, at};
+  }
+  return {char_offsets[start].first, char_offsets[end - 1].second};
+}
+
+// Concatenates the encodings of consecutive chunks, shifting offsets by the
+// chunk start and word ids past the words of the previous chunks.
+Encoding stitchChunks(const std::vector<Encoding>& chunks,
+                      const std::vector<std::pair<int, int>>& ranges,
+                      std::pmr::memory_resource* resource =
+                          std::pmr::get_default_resource()) {
+  Encoding stitched(resource);
+  int word_base = 0;
+  for (int i = 0; i < chunks.size(); i++) {
+    const Encoding& chunk = chunks[i];
+    stitched.ids.insert(stitched.ids.end(), chunk.ids.begin(),
+                        chunk.ids.end());
+    stitched.type_ids.insert(stitched.type_ids.end(), chunk.type_ids.begin(),
+                             chunk.type_ids.end());
+    stitched.tokens.insert(stitched.tokens.end(), chunk.tokens.begin(),
+                           chunk.tokens.end());
+    for (const std::pair<int, int>& offsets : chunk.offsets) {
+      stitched.offsets.emplace_back(offsets.first + ranges[i].first,
+                                    offsets.second + ranges[i].first);
+    }
+    int next_word_base = word_base;
+    for (const std::optional<int>& word_id : chunk.word_ids) {
+      if (!word_id.has_value()) {
+        stitched.word_ids.emplace_back(std::nullopt);
+        continue;
+      }
+      stitched.word_ids.emplace_back(*word_id + word_base);
+      next_word_base = std::max(next_word_base, *word_id + word_base + 1);
+    }
+    word_base = next_word_base;
+    stitched.special_tokens_mask.insert(stitched.special_tokens_mask.end(),
+                                        chunk.special_tokens_mask.begin(),
+                                        chunk.special_tokens_mask.end());
+    stitched.attention_mask.insert(stitched.attention_mask.end(),
+                                   chunk.attention_mask.begin(),
+                                   chunk.attention_mask.end());
+  }
+  return stitched;
+}
+
+} // namespace
+
+Encoding Tokenizer::Encode(const std::string& input, bool add_special_tokens,
+                           EncodeOptions options,
+                           std::pmr::memory_resource* resource,
+                           WorkStealingExecutor* executor) const {
+  bool collect_stats = stats_->enabled();
+  int token_limit = TokenLimit(1, 0, 0, add_special_tokens, options);
+  std::vector<Encoding> encodings;
+  if (executor != nullptr && token_limit < 0 &&
+      utf16Length(input) > kBatchChunkLength &&
+      isChunkable(normalizer, pre_tokenizer, added_vocabulary)) {
+    encodings.emplace_back(
+        EncodeChunked(input, 0, options, resource, collect_stats, executor));
+  } else {
+    encodings.emplace_back(EncodeSequence(input, 0, token_limit, options,
+                                          resource, collect_stats));
+  }
+  Encoding encoding =
+      PostProcessEncodings(std::move(encodings), add_special_tokens, options,
+                           resource, collect_stats);
+  if (collect_stats) {
+    stats_->RecordEncode(input.size(), encoding.ids.size());
   }
   return encoding;
 }
 
 Encoding Tokenizer::Encode(const std::pair<std::string, std::string>& input,
-                           bool add_special_tokens) {
-  std::pair<icu::UnicodeString, icu::UnicodeString> unicode_input = {
-      icu::UnicodeString::fromUTF8(input.first),
-      icu::UnicodeString::fromUTF8(input.second)};
-  std::vector<Encoding> encodings = {
-      EncodeSingleSequence(&unicode_input.first, 0),
-      EncodeSingleSequence(&unicode_input.second, 1)};
+                           bool add_special_tokens, EncodeOptions options,
+                           std::pmr::memory_resource* resource) const {
+  bool collect_stats = stats_->enabled();
+  // Only a sequence truncated on its own can stop early, and how much of it
+  // is kept depends on the length of the other, so that one goes first.
+  int last = truncation.get() != nullptr &&
+                     truncation->strategy() == TruncationStrategy::kOnlyFirst
+                 ? 0
+                 : 1;
+  std::vector<Encoding> encodings(2, Encoding(resource));
+  encodings[1 - last] =
+      EncodeSequence(last == 0 ? input.second : input.first, 1 - last, -1,
+                     options, resource, collect_stats);
+  encodings[last] = EncodeSequence(
+      last == 0 ? input.first : input.second, last,
+      TokenLimit(2, last, encodings[1 - last].ids.size(), add_special_tokens,
+                 options),
+      options, resource, collect_stats);
+  Encoding encoding =
+      PostProcessEncodings(std::move(encodings), add_special_tokens, options,
+                           resource, collect_stats);
+  if (collect_stats) {
+    stats_->RecordEncode(input.first.size() + input.second.size(),
+                         encoding.ids.size());
+  }
+  return encoding;
+}
+
+std::vector<Encoding> Tokenizer::EncodeBatch(
+    const std::vector<std::string>& inputs, bool add_special_tokens,
+    EncodeOptions options, WorkStealingExecutor* executor) const {
+  std::vector<Encoding> encodings =
+      EncodeBatchUnpadded(inputs, add_special_tokens, options, executor);
+  if (padding.get() != nullptr) {
+    encodings = padding->PadEncodings(encodings);
+  }
+  return encodings;
+}
+
+std::vector<EncodedBatch> Tokenizer::EncodeBucketed(
+    const std::vector<std::string>& inputs, int max_batch_size,
+    double max_padding_ratio, bool add_special_tokens, EncodeOptions options,
+    WorkStealingExecutor* executor) const {
+  std::vector<Encoding> encodings =
+      EncodeBatchUnpadded(inputs, add_special_tokens, options, executor);
+  std::vector<int> lengths;
+  lengths.reserve(encodings.size());
+  for (const Encoding& encoding : encodings) {
+    lengths.emplace_back(encoding.ids.size());
+  }
+  Padding batch_padding = padding.get() != nullptr ? *padding : Padding();
+  std::vector<EncodedBatch> batches;
+  for (std::vector<int>& bucket :
+       BucketByLength(lengths, max_batch_size, max_padding_ratio)) {
+    EncodedBatch batch;
+    batch.encodings.reserve(bucket.size());
+    for (int index : bucket) {
+      batch.encodings.emplace_back(std::move(encodings[index]));
+    }
+    batch.encodings = batch_padding.PadEncodings(batch.encodings);
+    batch.indices = std::move(bucket);
+    batches.emplace_back(std::move(batch));
+  }
+  return batches;
+}
+
+std::vector<Encoding> Tokenizer::EncodeBatchUnpadded(
+    const std::vector<std::string>& inputs, bool add_special_tokens,
+    EncodeOptions options, WorkStealingExecutor* executor) const {
+  if (executor == nullptr) {
+    executor = &WorkStealingExecutor::Default();
+  }
+  bool collect_stats = stats_->enabled();
+  // Documents that truncation cuts short are encoded up to the limit instead
+  // of chunked in parallel.
+  int token_limit = TokenLimit(1, 0, 0, add_special_tokens, options);
+  bool chunkable =
+      isChunkable(normalizer, pre_tokenizer, added_vocabulary) &&
+      token_limit < 0;
+  std::vector<Encoding> encodings(inputs.size());
+  auto finish = [&](int i, std::vector<Encoding> sequences) {
+    encodings[i] =
+        PostProcessEncodings(std::move(sequences), add_special_tokens, options,
+                             std::pmr::get_default_resource(), collect_stats,
+                             false);
+    if (collect_stats) {
+      stats_->RecordEncode(inputs[i].size(), encodings[i].ids.size());
+    }
+  };
+
+  // Long documents are converted up front to find their chunks, the last
+  // chunk to finish stitches the document together.
+  struct ChunkedDocument {
+    icu::UnicodeString input;
+    std::vector<std::pair<int, int>> ranges;
+    std::vector<std::pair<int, int>> offset_ranges;
+    std::vector<Encoding> chunks;
+    std::atomic<int> remaining;
+  };
+  std::vector<std::unique_ptr<ChunkedDocument>> documents(inputs.size());
+  std::vector<std::pair<int, std::function<void()>>> tasks;
+  for (int i = 0; i < inputs.size(); i++) {
+    if (chunkable && utf16Length(inputs[i]) > kBatchChunkLength) {
+      auto document = std::make_unique<ChunkedDocument>();
+      document->input = icu::UnicodeString::fromUTF8(inputs[i]);
+      document->ranges = chunkRanges(document->input);
+      if (document->ranges.size() > 1) {
+        document->offset_ranges =
+            offsetRanges(document->input, document->ranges, offset_type);
+        document->chunks.resize(document->ranges.size());
+        document->remaining.store(document->ranges.size());
+        for (int j = 0; j < document->ranges.size(); j++) {
+          ChunkedDocument* doc = document.get();
+          int start = doc->ranges[j].first;
+          int length = doc->ranges[j].second - start;
+          tasks.emplace_back(length, [&, doc, i, j, start, length]() {
+            icu::UnicodeString chunk = doc->input.tempSubString(start, length);
+            doc->chunks[j] = EncodeSingleSequence(
+                &chunk, 0, options, std::pmr::get_default_resource(),
+                collect_stats);
+            if (doc->remaining.fetch_sub(1) == 1) {
+              finish(i, {stitchChunks(doc->chunks, doc->offset_ranges)});
+            }
+          });
+        }
+        documents[i] = std::move(document);
+        continue;
+      }
+    }
+    tasks.emplace_back(inputs[i].size(), [&, i]() {
+      finish(i, {EncodeSequence(inputs[i], 0, token_limit, options,
+                                std::pmr::get_default_resource(),
+                                collect_stats)});
+    });
+  }
+
+  std::stable_sort(
+      tasks.begin(), tasks.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+  std::vector<std::function<void()>> ordered_tasks;
+  ordered_tasks.reserve(tasks.size());
+  for (auto& task : tasks) {
+    ordered_tasks.emplace_back(std::move(task.second));
+  }
+  executor->Run(std::move(ordered_tasks));
+  return encodings;
+}
+
+Encoding Tokenizer::PostProcessEncodings(std::vector<Encoding> encodings,
+                                         bool add_special_tokens,
+                                         EncodeOptions options,
+                                         std::pmr::memory_resource* resource,
+                                         bool collect_stats, bool pad) const {
+  StatsCollector::Clock::time_point start;
+  if (collect_stats) {
+    start = StatsCollector::Clock::now();
+  }
+  bool process = add_special_tokens && post_processor.get() != nullptr;
   if (truncation.get() != nullptr) {
-    truncation->TruncateEncodings(encodings);
+    encodings = truncation->TruncateEncodings(
+        encodings,
+        process ? post_processor->AddedTokens(encodings.size() > 1) : 0);
+    if (collect_stats) {
+      stats_->RecordStage(Stage::kTruncation, &start, 0, 0,
+                          countTokens(encodings));
+    }
   }
-  if (add_special_tokens && post_processor.get() != nullptr) {
-    encodings = post_processor->ProcessEncodings(encodings);
+  auto merge = [&](std::vector<Encoding> sequences) {
+    return process ? post_processor->Process(std::move(sequences), options,
+                                             resource)
+                   : ConcatEncodings(std::move(sequences), options, resource);
+  };
+  // Each overflowing part of a sequence is merged with the kept part of the
+  // other.
+  std::pmr::vector<Encoding> overflowing(resource);
+  if (hasOption(options, EncodeOptions::kOverflowing)) {
+    for (int i = 0; i < encodings.size(); i++) {
+      for (Encoding& part : encodings[i].overflowing) {
+        std::vector<Encoding> sequences = encodings;
+        sequences[i] = std::move(part);
+        overflowing.emplace_back(merge(std::move(sequences)));
+      }
+    }
   }
-  if (padding.get() != nullptr) {
-    padding->PadEncodings(encodings);
-  }
-  Encoding encoding;
-  for (const Encoding& enc : encodings) {
-    encoding.ids.insert(encoding.ids.end(), enc.ids.begin(), enc.ids.end());
-    encoding.tokens.insert(encoding.tokens.end(), enc.tokens.begin(),
-                           enc.tokens.end());
-    encoding.type_ids.insert(encoding.type_ids.end(), enc.type_ids.begin(),
-                             enc.type_ids.end());
-    encoding.offsets.insert(encoding.offsets.end(), enc.offsets.begin(),
-                            enc.offsets.end());
-    encoding.word_ids.insert(encoding.word_ids.end(), enc.word_ids.begin(),
-                             enc.word_ids.end());
-    encoding.special_tokens_mask.insert(encoding.special_tokens_mask.end(),
-                                        enc.special_tokens_mask.begin(),
-                                        enc.special_tokens_mask.end());
-    encoding.attention_mask.insert(encoding.attention_mask.end(),
-                                   enc.attention_mask.begin(),
-                                   enc.attention_mask.end());
+  Encoding encoding = merge(std::move(encodings));
+  encoding.overflowing = std::move(overflowing);
+  if (process && collect_stats) {
+    stats_->RecordStage(Stage::kPostProcessor, &start, 0, 0,
+                        encoding.ids.size());
+  }
+  if (pad && padding.get() != nullptr) {
+    std::vector<Encoding> padded;
+    padded.emplace_back(std::move(encoding));
+    encoding = std::move(padding->PadEncodings(padded)[0]);
+    if (collect_stats) {
+      stats_->RecordStage(Stage::kPadding, &start, 0, 0, encoding.ids.size());
+    }
   }
   return encoding;
 }
 
-std::string Tokenizer::Decode(const std::vector<int>& ids,
-                              bool skip_special_tokens) {
-  std::vector<std::string> tokens;
+size_t Tokenizer::CountTokens(std::string_view input,
+                              bool add_special_tokens) const {
+  normalizers::NormalizerResult normalized(
+      icu::UnicodeString::fromUTF8(
+          icu::StringPiece(input.data(), static_cast<int32_t>(input.size()))),
+      false, false);
+  std::vector<normalizers::NormalizerResult> splits;
+  if (added_vocabulary.get() != nullptr &&
+      added_vocabulary->MayMatch(normalized.normalized)) {
+    splits = added_vocabulary->FindSplits(normalized);
+  } else if (!normalized.normalized.isEmpty()) {
+    splits.emplace_back(std::move(normalized));
+  }
+  size_t count = 0;
+  for (normalizers::NormalizerResult& split : splits) {
+    if (normalizer.get() != nullptr && !split.pre_normalized) {
+      split = normalizer->Normalize(std::move(split));
+    }
+    pre_tokenizers::PreTokenizerResult pre_tokenized(
+        {split.normalized}, std::vector<std::pair<int, int>>());
+    pre_tokenized.at_start = &split == &splits.front();
+    if (pre_tokenizer.get() != nullptr && !split.pre_normalized) {
+      pre_tokenized = pre_tokenizer->PreTokenize(pre_tokenized);
+    }
+    if (split.pre_normalized && added_vocabulary.get() != nullptr &&
+        added_vocabulary->FindToken(split.normalized) != nullptr) {
+      count++;
+      continue;
+    }
+    if (model.get() == nullptr)
+      continue;
+    for (const icu::UnicodeString& pre_token : pre_tokenized.pre_tokenized) {
+      count += model->CountTokens(pre_token);
+    }
+  }
+  if (add_special_tokens && post_processor.get() != nullptr) {
+    count += post_processor->AddedTokens(false);
+  }
+  return count;
+}
+
+void Tokenizer::DecodeTo(const std::vector<int>& ids,
+                         bool skip_special_tokens,
+                         std::vector<std::string_view>* tokens,
+                         std::string* out) const {
+  tokens->clear();
   for (const int id : ids) {
-    std::optional<std::string> opt_token = model->IdToToken(id);
-    if (!opt_token.has_value())
+    std::optional<std::string_view> token = model->IdToTokenView(id);
+    if (!token.has_value() && added_vocabulary.get() != nullptr) {
+      // Added tokens need not be in the model's vocabulary.
+      if (const AddedToken* added_token = added_vocabulary->FindToken(id)) {
+        token = added_token->content;
+      }
+    }
+    if (!token.has_value())
       continue;
-    if (!skip_special_tokens ||
-        !added_vocabulary->IsSpecialToken(opt_token.value())) {
-      tokens.emplace_back(opt_token.value());
+    if (!skip_special_tokens || added_vocabulary.get() == nullptr ||
+        !added_vocabulary->IsSpecialToken(*token)) {
+      tokens->emplace_back(*token);
     }
   }
-  std::string result = "";
-  tokens = decoder->DecodeChain(tokens);
-  for (const std::string& token : tokens) {
-    result += token;
+  if (decoder.get() == nullptr) {
+    for (std::string_view token : *tokens) {
+      out->append(token);
+    }
+    return;
   }
+  decoder->Decode(*tokens, out);
+}
+
+std::string Tokenizer::Decode(const std::vector<int>& ids,
+                              bool skip_special_tokens) const {
+  std::vector<std::string_view> tokens;
+  std::string result;
+  DecodeTo(ids, skip_special_tokens, &tokens, &result);
   return result;
 }
 
+DecodedBatch Tokenizer::DecodeBatch(const std::vector<std::vector<int>>& ids,
+                                    bool skip_special_tokens,
+                                    WorkStealingExecutor* executor) const {
+  if (executor == nullptr) {
+    executor = &WorkStealingExecutor::Default();
+  }
+  DecodedBatch batch;
+  batch.offsets.assign(ids.size() + 1, 0);
+  int num_tasks = std::min<int>(ids.size(), 4 * executor->num_threads());
+  // Offsets are first relative to the buffer of the range.
+  std::vector<std::string> buffers(num_tasks);
+  auto range = [&](int task) {
+    return std::make_pair(task * ids.size() / num_tasks,
+                          (task + 1) * ids.size() / num_tasks);
+  };
+  std::vector<std::function<void()>> tasks;
+  for (int t = 0; t < num_tasks; t++) {
+    tasks.emplace_back([&, t]() {
+      std::vector<std::string_view> tokens;
+      auto [begin, end] = range(t);
+      for (size_t i = begin; i < end; i++) {
+        DecodeTo(ids[i], skip_special_tokens, &tokens, &buffers[t]);
+        batch.offsets[i + 1] = buffers[t].size();
+      }
+    });
+  }
+  executor->Run(std::move(tasks));
+
+  size_t length = 0;
+  for (int t = 0; t < num_tasks; t++) {
+    auto [begin, end] = range(t);
+    for (size_t i = begin; i < end; i++) {
+      batch.offsets[i + 1] += length;
+    }
+    length += buffers[t].size();
+  }
+  batch.text.reserve(length);
+  for (std::string& buffer : buffers) {
+    batch.text.append(buffer);
+    std::string().swap(buffer);
+  }
+  return batch;
+}
+
+std::vector<std::string> Tokenizer::DecodeBatchStrings(
+    const std::vector<std::vector<int>>& ids, bool skip_special_tokens,
+    WorkStealingExecutor* executor) const {
+  if (executor == nullptr) {
+    executor = &WorkStealingExecutor::Default();
+  }
+  std::vector<std::string> results(ids.size());
+  int num_tasks = std::min<int>(ids.size(), 4 * executor->num_threads());
+  std::vector<std::function<void()>> tasks;
+  for (int t = 0; t < num_tasks; t++) {
+    tasks.emplace_back([&, t]() {
+      std::vector<std::string_view> tokens;
+      size_t end = (t + 1) * ids.size() / num_tasks;
+      for (size_t i = t * ids.size() / num_tasks; i < end; i++) {
+        DecodeTo(ids[i], skip_special_tokens, &tokens, &results[i]);
+      }
+    });
+  }
+  executor->Run(std::move(tasks));
+  return results;
+}
+
+void Tokenizer::EnableStats(bool enabled) { stats_->set_enabled(enabled); }
+
+TokenizerStats Tokenizer::Stats() const { return stats_->Snapshot(); }
+
+void Tokenizer::ResetStats() { stats_->Reset(); }
+
+size_t Tokenizer::MemoryUsage() const {
+  size_t usage = sizeof(Tokenizer) + HeapUsage(version);
+  if (model) usage += model->MemoryUsage();
+  if (added_vocabulary) usage += added_vocabulary->MemoryUsage();
+  return usage;
+}
+
+int Tokenizer::BuiltTables() const {
+  int built = 0;
+  if (model) built += model->BuiltTables();
+  if (added_vocabulary) built += added_vocabulary->BuiltTables();
+  return built;
+}
+
+MemoryUsageMap Tokenizer::MemoryUsageByStructure() const {
+  MemoryUsageMap usage;
+  if (model) {
+    for (const auto& [name, bytes] : model->MemoryUsageByStructure()) {
+      usage["model." + name] = bytes;
+    }
+  }
+  if (added_vocabulary) {
+    for (const auto& [name, bytes] :
+         added_vocabulary->MemoryUsageByStructure()) {
+      usage["added_vocabulary." + name] = bytes;
+    }
+  }
+  return usage;
+}
+
+int Tokenizer::TokenLimit(int num_sequences, int index, int other_tokens,
+                          bool add_special_tokens,
+                          EncodeOptions options) const {
+  if (truncation.get() == nullptr ||
+      hasOption(options, EncodeOptions::kOverflowing) ||
+      !isChunkable(normalizer, pre_tokenizer, added_vocabulary)) {
+    return -1;
+  }
+  // Under kLongestFirst the cut of a pair depends on both full lengths.
+  TruncationStrategy strategy = truncation->strategy();
+  bool truncated_alone =
+      num_sequences == 1
+          ? strategy != TruncationStrategy::kOnlySecond
+          : strategy == (index == 0 ? TruncationStrategy::kOnlyFirst
+                                    : TruncationStrategy::kOnlySecond);
+  // Word ids count from the start of the sequence.
+  if (!truncated_alone ||
+      (truncation->direction() == TruncationDirection::kLeft &&
+       hasOption(options, EncodeOptions::kWordIds))) {
+    return -1;
+  }
+  int added_tokens = add_special_tokens && post_processor.get() != nullptr
+                         ? post_processor->AddedTokens(num_sequences > 1)
+                         : 0;
+  int token_limit = truncation->max_length() - added_tokens - other_tokens;
+  return token_limit > 0 ? token_limit : -1;
+}
+
+Encoding Tokenizer::EncodeSequence(const std::string& input, int type_id,
+                                   int token_limit, EncodeOptions options,
+                                   std::pmr::memory_resource* resource,
+                                   bool collect_stats) const {
+  // Unlike the parallel chunks, the chunks here are cut from the UTF-8
+  // input and measured in bytes, up to kBatchChunkLength of them.
+  if (token_limit < 0 || input.size() <= kBatchChunkLength) {
+    icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+    return EncodeSingleSequence(&unicode_input, type_id, options, resource,
+                                collect_stats);
+  }
+  std::vector<Encoding> chunks;
+  std::vector<std::pair<int, int>> ranges;
+  int tokens = 0;
+  if (truncation->direction() == TruncationDirection::kRight) {
+    // Only the chunks needed are converted, each one's offsets continue from
+    // the length of the previous chunks. Chunks are sized for the tokens
+    // still missing at kBytesPerToken, so little is encoded past the limit.
+    constexpr int kBytesPerToken = 4;
+    constexpr int kMinChunkLength = 256;
+    int start = 0;
+    while (start < input.size() && tokens < token_limit) {
+      int end = utf8ChunkEnd(
+          input, start,
+          std::clamp((token_limit - tokens) * kBytesPerToken, kMinChunkLength,
+                     kBatchChunkLength));
+      icu::UnicodeString chunk = icu::UnicodeString::fromUTF8(
+          icu::StringPiece(input.data() + start, end - start));
+      int offset_start = ranges.empty() ? 0 : ranges.back().second;
+      int offset_length =
+          offset_type == OffsetType::kUtf8
+              ? end - start
+              : offsetLength(chunk, 0, chunk.length(), offset_type);
+      ranges.emplace_back(offset_start, offset_start + offset_length);
+      chunks.emplace_back(EncodeSingleSequence(&chunk, type_id, options,
+                                               resource, collect_stats));
+      tokens += chunks.back().ids.size();
+      start = end;
+    }
+    return stitchChunks(chunks, ranges, resource);
+  }
+  icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+  std::vector<std::pair<int, int>> all_ranges = chunkRanges(unicode_input);
+  std::vector<std::pair<int, int>> all_offset_ranges =
+      offsetRanges(unicode_input, all_ranges, offset_type);
+  for (int i = all_ranges.size() - 1; i >= 0 && tokens < token_limit; i--) {
+    const std::pair<int, int>& range = all_ranges[i];
+    icu::UnicodeString chunk = unicode_input.tempSubString(
+        range.first, range.second - range.first);
+    ranges.emplace_back(all_offset_ranges[i]);
+    chunks.emplace_back(EncodeSingleSequence(&chunk, type_id, options,
+                                             resource, collect_stats));
+    tokens += chunks.back().ids.size();
+  }
+  std::reverse(chunks.begin(), chunks.end());
+  std::reverse(ranges.begin(), ranges.end());
+  return stitchChunks(chunks, ranges, resource);
+}
+
+Encoding Tokenizer::EncodeChunked(const std::string& input, int type_id,
+                                  EncodeOptions options,
+                                  std::pmr::memory_resource* resource,
+                                  bool collect_stats,
+                                  WorkStealingExecutor* executor) const {
+  icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+  std::vector<std::pair<int, int>> ranges = chunkRanges(unicode_input);
+  if (ranges.size() == 1) {
+    return EncodeSingleSequence(&unicode_input, type_id, options, resource,
+                                collect_stats);
+  }
+  std::vector<Encoding> chunks(ranges.size());
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(ranges.size());
+  // The chunks are encoded concurrently, so they cannot share a resource
+  // that is not thread-safe. Only the stitched encoding uses `resource`.
+  for (int i = 0; i < ranges.size(); i++) {
+    tasks.emplace_back([&, i]() {
+      icu::UnicodeString chunk = unicode_input.tempSubString(
+          ranges[i].first, ranges[i].second - ranges[i].first);
+      chunks[i] = EncodeSingleSequence(&chunk, type_id, options,
+                                       std::pmr::get_default_resource(),
+                                       collect_stats);
+    });
+  }
+  executor->Run(std::move(tasks));
+  return stitchChunks(chunks,
+                      offsetRanges(unicode_input, ranges, offset_type),
+                      resource);
+}
+
 Encoding Tokenizer::EncodeSingleSequence(icu::UnicodeString* unicode_input,
-                                         int type_id) {
+                                         int type_id, EncodeOptions options,
+                                         std::pmr::memory_resource* resource,
+                                         bool collect_stats) const {
+  StatsCollector::Clock::time_point start;
+  if (collect_stats) {
+    start = StatsCollector::Clock::now();
+  }
+  auto text_bytes = [](const auto& splits) {
+    uint64_t bytes = 0;
+    for (const auto& split : splits) {
+      bytes += split.normalized.length() * sizeof(char16_t);
+    }
+    return bytes;
+  };
+  bool track_offsets = hasOption(options, EncodeOptions::kOffsets);
   normalizers::NormalizerResult normalized =
-      normalizers::NormalizerResult(*unicode_input);
-  std::vector<normalizers::NormalizerResult> normalized_splits = {normalized};
-  if (added_vocabulary.get() != nullptr) {
+      normalizers::NormalizerResult(*unicode_input, false, track_offsets,
+                                    offset_type);
+  std::vector<normalizers::NormalizerResult> normalized_splits;
+  // Input without the first character of any added token is passed on
+  // whole, without copying it into splits.
+  if (added_vocabulary.get() != nullptr &&
+      added_vocabulary->MayMatch(normalized.normalized)) {
     normalized_splits = added_vocabulary->FindSplits(normalized);
+  } else if (!normalized.normalized.isEmpty()) {
+    normalized_splits.emplace_back(std::move(normalized));
+  }
+  if (added_vocabulary.get() != nullptr && collect_stats) {
+    stats_->RecordStage(Stage::kAddedVocabulary, &start,
+                        unicode_input->length() * sizeof(char16_t),
+                        text_bytes(normalized_splits), 0);
   }
   if (normalizer.get() != nullptr) {
+    uint64_t bytes_in = collect_stats ? text_bytes(normalized_splits) : 0;
     for (normalizers::NormalizerResult& split : normalized_splits) {
       if (!split.pre_normalized) {
-        split = normalizer->Normalize(split);
+        split = normalizer->Normalize(std::move(split));
       }
     }
+    if (collect_stats) {
+      stats_->RecordStage(Stage::kNormalizer, &start, bytes_in,
+                          text_bytes(normalized_splits), 0);
+    }
   }
   std::vector<pre_tokenizers::PreTokenizerResult> pre_tokenized_splits;
   for (const normalizers::NormalizerResult& split : normalized_splits) {
     pre_tokenizers::PreTokenizerResult pre_tokenized =
-        pre_tokenizers::PreTokenizerResult(
-            {split.normalized},
-            std::vector<std::vector<std::pair<int, int>>>({{split.offsets}}));
+        track_offsets
+            ? pre_tokenizers::PreTokenizerResult(
+                  {split.normalized},
+                  std::vector<std::vector<std::pair<int, int>>>(
+                      {{split.offsets}}))
+            : pre_tokenizers::PreTokenizerResult(
+                  {split.normalized}, std::vector<std::pair<int, int>>());
     pre_tokenized.pre_pre_tokenized = split.pre_normalized;
+    pre_tokenized.at_start = pre_tokenized_splits.empty();
     pre_tokenized_splits.emplace_back(pre_tokenized);
   }
   if (pre_tokenizer.get() != nullptr) {
@@ -324,27 +1197,92 @@ Encoding Tokenizer::EncodeSingleSequence(icu::UnicodeString* unicode_input,
         split = pre_tokenizer->PreTokenize(split);
       }
     }
+    if (collect_stats) {
+      uint64_t bytes_out = 0;
+      uint64_t pre_tokens = 0;
+      for (const pre_tokenizers::PreTokenizerResult& split :
+           pre_tokenized_splits) {
+        for (const icu::UnicodeString& pre_token : split.pre_tokenized) {
+          bytes_out += pre_token.length() * sizeof(char16_t);
+        }
+        pre_tokens += split.pre_tokenized.size();
+      }
+      stats_->RecordStage(Stage::kPreTokenizer, &start,
+                          text_bytes(normalized_splits), bytes_out,
+                          pre_tokens);
+    }
   }
-  Encoding encoding;
+  bool with_tokens = hasOption(options, EncodeOptions::kTokens);
+  bool with_type_ids = hasOption(options, EncodeOptions::kTypeIds);
+  bool with_word_ids = hasOption(options, EncodeOptions::kWordIds);
+  bool with_special_tokens_mask =
+      hasOption(options, EncodeOptions::kSpecialTokensMask);
+  bool with_attention_mask = hasOption(options, EncodeOptions::kAttentionMask);
+  Encoding encoding(resource);
   if (model.get() != nullptr) {
+    std::optional<int> unk_id;
+    uint64_t unk_tokens = 0;
+    if (collect_stats) {
+      unk_id = model->UnkTokenId();
+    }
     int word_id = -1;
     for (const pre_tokenizers::PreTokenizerResult& pre_tokenized :
          pre_tokenized_splits) {
       for (int i = 0; i < pre_tokenized.pre_tokenized.size(); i++) {
-        std::vector<Token> tokens = model->Tokenize(
-            pre_tokenized.pre_tokenized[i], pre_tokenized.offsets[i]);
+        // Tokens are aligned through the offsets of their code points when
+        // the pre-tokenizer kept them, which also covers normalizers that
+        // changed the length of the text.
+        const icu::UnicodeString& pre_token = pre_tokenized.pre_tokenized[i];
+        bool align = track_offsets && i < pre_tokenized.char_offsets.size() &&
+                     !pre_tokenized.char_offsets[i].empty();
+        std::pair<int, int> offset(0, 0);
+        if (align) {
+          offset.second = pre_token.length();
+        } else if (track_offsets) {
+          offset = pre_tokenized.offsets[i];
+        }
+        // Added tokens take their own id rather than the model's pieces.
+        const AddedToken* added_token = nullptr;
+        if (pre_tokenized.pre_pre_tokenized &&
+            added_vocabulary.get() != nullptr) {
+          added_token = added_vocabulary->FindToken(pre_token);
+        }
+        std::vector<Token> tokens;
+        if (added_token != nullptr) {
+          tokens.emplace_back(added_token->content, added_token->id, offset,
+                              false);
+        } else {
+          tokens = model->Tokenize(pre_token, offset);
+        }
         for (const Token& token : tokens) {
+          if (collect_stats && token.id == unk_id)
+            unk_tokens++;
           encoding.ids.emplace_back(token.id);
-          encoding.tokens.emplace_back(token.value);
-          encoding.type_ids.emplace_back(type_id);
-          encoding.offsets.emplace_back(token.offsets);
-          encoding.word_ids.emplace_back(
-              token.is_continuing_subword ? word_id : ++word_id);
-          encoding.special_tokens_mask.emplace_back(0);
-          encoding.attention_mask.emplace_back(1);
+          if (with_tokens)
+            encoding.tokens.emplace_back(token.value);
+          if (with_type_ids)
+            encoding.type_ids.emplace_back(type_id);
+          if (align) {
+            encoding.offsets.emplace_back(alignOffsets(
+                pre_token, pre_tokenized.char_offsets[i], token.offsets));
+          } else if (track_offsets) {
+            encoding.offsets.emplace_back(token.offsets);
+          }
+          if (with_word_ids) {
+            encoding.word_ids.emplace_back(
+                token.is_continuing_subword ? word_id : ++word_id);
+          }
+          if (with_special_tokens_mask)
+            encoding.special_tokens_mask.emplace_back(0);
+          if (with_attention_mask)
+            encoding.attention_mask.emplace_back(1);
         }
       }
     }
+    if (collect_stats) {
+      stats_->RecordStage(Stage::kModel, &start, 0, 0, encoding.ids.size());
+      stats_->RecordUnkTokens(unk_tokens);
+    }
   }
   return encoding;
 }
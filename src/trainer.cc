@@ -0,0 +1,476 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/trainer.h"
+
+#include <unicode/unistr.h>
+#include <unicode/utf8.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tokenizers {
+
+namespace trainers {
+
+namespace {
+
+// Lines read from a file before they are fed at once.
+constexpr size_t kFeedBlockBytes = 64 << 20;
+// Fewer words than this are merged into on the calling thread.
+constexpr int kParallelMergeWords = 4096;
+
+uint64_t pairKey(int first, int second) {
+  return (static_cast<uint64_t>(first) << 32) | static_cast<uint32_t>(second);
+}
+
+// A pair of tokens to merge, the most frequent first and, between equally
+// frequent ones, the one of the lowest ids.
+struct Merge {
+  uint64_t pair;
+  int64_t count;
+  std::vector<int> words;
+};
+
+bool operator<(const Merge& a, const Merge& b) {
+  if (a.count != b.count)
+    return a.count < b.count;
+  return a.pair > b.pair;
+}
+
+// A change of `delta` occurrences of a pair in a word.
+struct PairChange {
+  uint64_t pair;
+  int delta;
+  int word;
+};
+
+// Replaces every first, second pair of symbols with replacement and records
+// how the counts of the neighbouring pairs change.
+void mergeWord(std::vector<int>* symbols, int first, int second,
+               int replacement, int word, std::vector<PairChange>* changes) {
+  std::vector<int>& s = *symbols;
+  for (int i = 0; i + 1 < s.size(); i++) {
+    if (s[i] != first || s[i + 1] != second)
+      continue;
+    if (i > 0) {
+      changes->push_back({pairKey(s[i - 1], first), -1, word});
+      changes->push_back({pairKey(s[i - 1], replacement), 1, word});
+    }
+    s[i] = replacement;
+    s.erase(s.begin() + i + 1);
+    if (i + 1 < s.size()) {
+      changes->push_back({pairKey(second, s[i + 1]), -1, word});
+      changes->push_back({pairKey(replacement, s[i + 1]), 1, word});
+    }
+  }
+}
+
+std::string codePointToUTF8(UChar32 c) {
+  std::string result;
+  icu::UnicodeString(c).toUTF8String(result);
+  return result;
+}
+
+void appendJsonString(const std::string& value, std::string* out) {
+  out->push_back('"');
+  for (unsigned char c : value) {
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (c < 0x20) {
+      char escaped[7];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out->append(escaped);
+    } else {
+      out->push_back(c);
+    }
+  }
+  out->push_back('"');
+}
+
+// The index of `value` in `values`, or -1.
+int indexOf(const std::vector<std::string>& values, const std::string& value) {
+  auto it = std::find(values.begin(), values.end(), value);
+  return it == values.end() ? -1 : it - values.begin();
+}
+
+} // namespace
+
+WordPieceTrainer::WordPieceTrainer(
+    int vocab_size, int min_frequency,
+    const std::vector<std::string>& special_tokens, int limit_alphabet,
+    const std::string& continuing_subword_prefix, const std::string& unk_token)
+    : vocab_size_(vocab_size),
+      min_frequency_(min_frequency),
+      special_tokens_(special_tokens),
+      limit_alphabet_(limit_alphabet),
+      continuing_subword_prefix_(continuing_subword_prefix),
+      unk_token_(unk_token),
+      word_counts_(kNumShards) {
+  if (indexOf(special_tokens_, unk_token_) < 0) {
+    throw std::invalid_argument("unk_token " + unk_token_ +
+                                " is not a special token");
+  }
+}
+
+void WordPieceTrainer::CountWords(const std::string& input,
+                                  std::vector<WordCounts>* shards) {
+  normalizers::NormalizerResult normalized = normalizer_.Normalize(
+      normalizers::NormalizerResult(icu::UnicodeString::fromUTF8(input), false,
+                                    false));
+  pre_tokenizers::PreTokenizerResult pre_tokenized =
+      pre_tokenizer_.PreTokenize(pre_tokenizers::PreTokenizerResult(
+          {normalized.normalized}, std::vector<std::pair<int, int>>()));
+  std::string word;
+  for (const icu::UnicodeString& pre_token : pre_tokenized.pre_tokenized) {
+    if (pre_token.isEmpty())
+      continue;
+    word.clear();
+    pre_token.toUTF8String(word);
+    (*shards)[std::hash<std::string>()(word) % kNumShards][word]++;
+  }
+}
+
+void WordPieceTrainer::Feed(const std::vector<std::string>& inputs,
+                            WorkStealingExecutor* executor) {
+  if (inputs.empty())
+    return;
+  if (executor == nullptr) {
+    executor = &WorkStealingExecutor::Default();
+  }
+  int num_tasks =
+      std::min<int>(inputs.size(), 4 * executor->num_threads());
+  std::vector<std::vector<WordCounts>> task_counts(
+      num_tasks, std::vector<WordCounts>(kNumShards));
+  std::vector<std::function<void()>> tasks;
+  for (int i = 0; i < num_tasks; i++) {
+    tasks.emplace_back([&, i]() {
+      size_t end = (i + 1) * inputs.size() / num_tasks;
+      for (size_t j = i * inputs.size() / num_tasks; j < end; j++) {
+        CountWords(inputs[j], &task_counts[i]);
+      }
+    });
+  }
+  executor->Run(std::move(tasks));
+
+  // A word lands in the same shard for every task, so shards merge
+  // independently.
+  tasks.clear();
+  for (int shard = 0; shard < kNumShards; shard++) {
+    tasks.emplace_back([&, shard]() {
+      for (std::vector<WordCounts>& counts : task_counts) {
+        for (const auto& [word, count] : counts[shard]) {
+          word_counts_[shard][word] += count;
+        }
+        WordCounts().swap(counts[shard]);
+      }
+    });
+  }
+  executor->Run(std::move(tasks));
+}
+
+void WordPieceTrainer::FeedFile(const std::string& path,
+                                WorkStealingExecutor* executor) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::invalid_argument("could not read corpus " + path);
+  }
+  std::vector<std::string> lines;
+  size_t bytes = 0;
+  std::string line;
+  while (std::getline(file, line)) {
+    bytes += line.size();
+    lines.emplace_back(std::move(line));
+    if (bytes >= kFeedBlockBytes) {
+      Feed(lines, executor);
+      lines.clear();
+      bytes = 0;
+    }
+  }
+  Feed(lines, executor);
+}
+
+size_t WordPieceTrainer::NumWords() const {
+  size_t num_words = 0;
+  for (const WordCounts& counts : word_counts_) {
+    num_words += counts.size();
+  }
+  return num_words;
+}
+
+std::vector<std::string> WordPieceTrainer::Train(
+    WorkStealingExecutor* executor) {
+  if (executor == nullptr) {
+    executor = &WorkStealingExecutor::Default();
+  }
+  // Words in a fixed order, so that the ids of the tokens do not depend on
+  // the order of the hash maps.
+  std::vector<std::pair<std::string, uint64_t>> words;
+  words.reserve(NumWords());
+  for (const WordCounts& counts : word_counts_) {
+    words.insert(words.end(), counts.begin(), counts.end());
+  }
+  std::sort(words.begin(), words.end());
+
+  std::vector<std::string> vocab;
+  std::unordered_map<std::string, int> ids;
+  auto add_token = [&](const std::string& token) {
+    auto [it, inserted] = ids.emplace(token, vocab.size());
+    if (inserted) {
+      vocab.push_back(token);
+    }
+    return it->second;
+  };
+  for (const std::string& token : special_tokens_) {
+    add_token(token);
+  }
+
+  std::unordered_map<UChar32, uint64_t> char_counts;
+  for (const auto& [word, count] : words) {
+    for (int i = 0; i < word.size();) {
+      UChar32 c;
+      U8_NEXT(word.data(), i, static_cast<int>(word.size()), c);
+      char_counts[c] += count;
+    }
+  }
+  std::vector<std::pair<UChar32, uint64_t>> alphabet(char_counts.begin(),
+                                                     char_counts.end());
+  if (limit_alphabet_ >= 0 && alphabet.size() > limit_alphabet_) {
+    std::sort(alphabet.begin(), alphabet.end(),
+              [](const auto& a, const auto& b) {
+                return a.second != b.second ? a.second > b.second
+                                            : a.first < b.first;
+              });
+    alphabet.resize(limit_alphabet_);
+  }
+  std::sort(alphabet.begin(), alphabet.end());
+  for (const auto& [c, count] : alphabet) {
+    add_token(codePointToUTF8(c));
+  }
+
+  // Characters left out of the alphabet are dropped from the words.
+  std::vector<std::vector<int>> symbols(words.size());
+  std::vector<uint64_t> counts(words.size());
+  for (int w = 0; w < words.size(); w++) {
+    const std::string& word = words[w].first;
+    counts[w] = words[w].second;
+    for (int i = 0; i < word.size();) {
+      int start = i;
+      UChar32 c;
+      U8_NEXT(word.data(), i, static_cast<int>(word.size()), c);
+      std::string token = word.substr(start, i - start);
+      if (ids.find(token) == ids.end())
+        continue;
+      if (start > 0) {
+        token = continuing_subword_prefix_ + token;
+      }
+      symbols[w].push_back(add_token(token));
+    }
+  }
+  std::vector<std::pair<std::string, uint64_t>>().swap(words);
+
+  // Pairs are counted over ranges of words in parallel.
+  int num_tasks = std::max<int>(
+      1, std::min<int>(symbols.size() / kParallelMergeWords,
+                       4 * executor->num_threads()));
+  std::vector<std::unordered_map<uint64_t, int64_t>> task_pair_counts(
+      num_tasks);
+  std::vector<std::unordered_map<uint64_t, std::vector<int>>> task_words(
+      num_tasks);
+  std::vector<std::function<void()>> tasks;
+  for (int t = 0; t < num_tasks; t++) {
+    tasks.emplace_back([&, t]() {
+      size_t end = (t + 1) * symbols.size() / num_tasks;
+      for (size_t w = t * symbols.size() / num_tasks; w < end; w++) {
+        for (int i = 0; i + 1 < symbols[w].size(); i++) {
+          uint64_t pair = pairKey(symbols[w][i], symbols[w][i + 1]);
+          task_pair_counts[t][pair] += counts[w];
+          std::vector<int>& pair_words = task_words[t][pair];
+          if (pair_words.empty() || pair_words.back() != static_cast<int>(w)) {
+            pair_words.push_back(w);
+          }
+        }
+      }
+    });
+  }
+  executor->Run(std::move(tasks));
+  std::unordered_map<uint64_t, int64_t> pair_counts;
+  std::unordered_map<uint64_t, std::vector<int>> pair_words;
+  for (int t = 0; t < num_tasks; t++) {
+    for (const auto& [pair, count] : task_pair_counts[t]) {
+      pair_counts[pair] += count;
+    }
+    for (auto& [pair, words] : task_words[t]) {
+      std::vector<int>& all_words = pair_words[pair];
+      all_words.insert(all_words.end(), words.begin(), words.end());
+    }
+  }
+  task_pair_counts.clear();
+  task_words.clear();
+
+  std::vector<Merge> queue;
+  for (auto& [pair, words] : pair_words) {
+    int64_t count = pair_counts[pair];
+    if (count > 0) {
+      queue.push_back({pair, count, std::move(words)});
+    }
+  }
+  pair_words.clear();
+  std::make_heap(queue.begin(), queue.end());
+
+  while (vocab.size() < vocab_size_ && !queue.empty()) {
+    std::pop_heap(queue.begin(), queue.end());
+    Merge top = std::move(queue.back());
+    queue.pop_back();
+    // Counts change after a merge is queued, it is requeued with the
+    // current one.
+    int64_t count = pair_counts[top.pair];
+    if (top.count != count) {
+      top.count = count;
+      queue.push_back(std::move(top));
+      std::push_heap(queue.begin(), queue.end());
+      continue;
+    }
+    if (top.count < 1 || top.count < min_frequency_)
+      break;
+
+    int first = top.pair >> 32;
+    int second = static_cast<int>(top.pair & 0xFFFFFFFF);
+    std::string second_token = vocab[second];
+    if (second_token.compare(0, continuing_subword_prefix_.size(),
+                             continuing_subword_prefix_) == 0) {
+      second_token.erase(0, continuing_subword_prefix_.size());
+    }
+    int replacement = add_token(vocab[first] + second_token);
+
+    std::sort(top.words.begin(), top.words.end());
+    top.words.erase(std::unique(top.words.begin(), top.words.end()),
+                    top.words.end());
+    int num_merge_tasks = std::max<int>(
+        1, std::min<int>(top.words.size() / kParallelMergeWords,
+                         4 * executor->num_threads()));
+    std::vector<std::vector<PairChange>> changes(num_merge_tasks);
+    auto merge_words = [&](int t) {
+      size_t end = (t + 1) * top.words.size() / num_merge_tasks;
+      for (size_t i = t * top.words.size() / num_merge_tasks; i < end; i++) {
+        int w = top.words[i];
+        mergeWord(&symbols[w], first, second, replacement, w, &changes[t]);
+      }
+    };
+    if (num_merge_tasks == 1) {
+      merge_words(0);
+    } else {
+      tasks.clear();
+      for (int t = 0; t < num_merge_tasks; t++) {
+        tasks.emplace_back([&, t]() { merge_words(t); });
+      }
+      executor->Run(std::move(tasks));
+    }
+
+    std::unordered_map<uint64_t, std::vector<int>> new_pair_words;
+    for (const std::vector<PairChange>& task_changes : changes) {
+      for (const PairChange& change : task_changes) {
+        pair_counts[change.pair] += change.delta * counts[change.word];
+        if (change.delta > 0) {
+          new_pair_words[change.pair].push_back(change.word);
+        }
+      }
+    }
+    for (auto& [pair, words] : new_pair_words) {
+      int64_t count = pair_counts[pair];
+      if (count > 0) {
+        queue.push_back({pair, count, std::move(words)});
+        std::push_heap(queue.begin(), queue.end());
+      }
+    }
+  }
+  return vocab;
+}
+
+std::shared_ptr<models::WordPiece> WordPieceTrainer::MakeModel(
+    const std::vector<std::string>& vocab) const {
+  std::unordered_map<std::string, int> ids;
+  for (int i = 0; i < vocab.size(); i++) {
+    ids.emplace(vocab[i], i);
+  }
+  return std::make_shared<models::WordPiece>(ids, unk_token_,
+                                             continuing_subword_prefix_);
+}
+
+std::string WordPieceTrainer::ToJson(
+    const std::vector<std::string>& vocab) const {
+  std::string json = "{\n  \"version\": \"1.0\",\n  \"truncation\": null,\n"
+                     "  \"padding\": null,\n  \"added_tokens\": [";
+  for (int i = 0; i < special_tokens_.size(); i++) {
+    json += i == 0 ? "\n    {\"id\": " : ",\n    {\"id\": ";
+    json += std::to_string(indexOf(vocab, special_tokens_[i]));
+    json += ", \"content\": ";
+    appendJsonString(special_tokens_[i], &json);
+    json += ", \"single_word\": false, \"lstrip\": false, \"rstrip\": false, "
+            "\"normalized\": false, \"special\": true}";
+  }
+  json += "\n  ],\n"
+          "  \"normalizer\": {\"type\": \"BertNormalizer\", "
+          "\"clean_text\": true, \"handle_chinese_chars\": true, "
+          "\"strip_accents\": true, \"lowercase\": true},\n"
+          "  \"pre_tokenizer\": {\"type\": \"BertPreTokenizer\"},\n"
+          "  \"post_processor\": ";
+
+  // [CLS] A [SEP] and [CLS] A [SEP] B [SEP] when both tokens are special.
+  int cls_id = indexOf(special_tokens_, "[CLS]") < 0
+                   ? -1
+                   : indexOf(vocab, "[CLS]");
+  int sep_id = indexOf(special_tokens_, "[SEP]") < 0
+                   ? -1
+                   : indexOf(vocab, "[SEP]");
+  if (cls_id >= 0 && sep_id >= 0) {
+    auto special = [](const char* id, int type_id) {
+      return std::string("{\"SpecialToken\": {\"id\": \"") + id +
+             "\", \"type_id\": " + std::to_string(type_id) + "}}";
+    };
+    auto sequence = [](const char* id, int type_id) {
+      return std::string("{\"Sequence\": {\"id\": \"") + id +
+             "\", \"type_id\": " + std::to_string(type_id) + "}}";
+    };
+    json += "{\n    \"type\": \"TemplateProcessing\",\n    \"single\": [" +
+            special("[CLS]", 0) + ", " + sequence("A", 0) + ", " +
+            special("[SEP]", 0) + "],\n    \"pair\": [" +
+            special("[CLS]", 0) + ", " + sequence("A", 0) + ", " +
+            special("[SEP]", 0) + ", " + sequence("B", 1) + ", " +
+            special("[SEP]", 1) + "],\n    \"special_tokens\": {" +
+            "\"[CLS]\": {\"id\": \"[CLS]\", \"ids\": [" +
+            std::to_string(cls_id) + "], \"tokens\": [\"[CLS]\"]}, " +
+            "\"[SEP]\": {\"id\": \"[SEP]\", \"ids\": [" +
+            std::to_string(sep_id) + "], \"tokens\": [\"[SEP]\"]}}\n  }";
+  } else {
+    json += "null";
+  }
+
+  json += ",\n  \"decoder\": {\"type\": \"WordPiece\", \"prefix\": ";
+  appendJsonString(continuing_subword_prefix_, &json);
+  json += ", \"cleanup\": true},\n"
+          "  \"model\": {\n    \"type\": \"WordPiece\",\n    \"unk_token\": ";
+  appendJsonString(unk_token_, &json);
+  json += ",\n    \"continuing_subword_prefix\": ";
+  appendJsonString(continuing_subword_prefix_, &json);
+  json += ",\n    \"max_input_chars_per_word\": 100,\n    \"vocab\": {";
+  for (int i = 0; i < vocab.size(); i++) {
+    json += i == 0 ? "\n      " : ",\n      ";
+    appendJsonString(vocab[i], &json);
+    json += ": " + std::to_string(i);
+  }
+  json += "\n    }\n  }\n}\n";
+  return json;
+}
+
+} // namespace trainers
+
+} // namespace tokenizers
@@ -7,7 +7,10 @@
 #include <unicode/ustring.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdio>
+#include <numeric>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,6 +33,31 @@ Truncation::Truncation(const TruncationDirection& direction,
       max_length_(max_length),
       stride_(stride) {}
 
+namespace {
+
+// Fields that were not requested when encoding are empty and stay empty.
+template <typename Vector>
+void slice(const Vector& vec, int start, int stop, Vector* out) {
+  if (!vec.empty())
+    out->assign(vec.begin() + start, vec.begin() + stop);
+}
+
+// The slice allocates from the resource of the encoding.
+Encoding sliceEncoding(const Encoding& encoding, int start, int stop) {
+  Encoding sliced(encoding.resource());
+  slice(encoding.ids, start, stop, &sliced.ids);
+  slice(encoding.type_ids, start, stop, &sliced.type_ids);
+  slice(encoding.tokens, start, stop, &sliced.tokens);
+  slice(encoding.offsets, start, stop, &sliced.offsets);
+  slice(encoding.word_ids, start, stop, &sliced.word_ids);
+  slice(encoding.special_tokens_mask, start, stop,
+        &sliced.special_tokens_mask);
+  slice(encoding.attention_mask, start, stop, &sliced.attention_mask);
+  return sliced;
+}
+
+} // namespace
+
 void TruncateEncoding(Encoding* encoding, int max_length, int stride,
                       TruncationDirection direction) {
   int encoding_len = encoding->ids.size();
@@ -39,7 +67,8 @@ void TruncateEncoding(Encoding* encoding, int max_length, int stride,
   }
 
   if (max_length == 0) {
-    encoding->overflowing.emplace_back(*encoding);
+    encoding->overflowing.emplace_back(
+        sliceEncoding(*encoding, 0, encoding_len));
     encoding->ids.clear();
     encoding->type_ids.clear();
     encoding->tokens.clear();
@@ -71,64 +100,33 @@ void TruncateEncoding(Encoding* encoding, int max_length, int stride,
     }
   }
 
-  Encoding new_encoding;
-  new_encoding.ids.assign(encoding->ids.begin() + ranges[0].first,
-                          encoding->ids.begin() + ranges[0].second);
-  new_encoding.type_ids.assign(encoding->type_ids.begin() + ranges[0].first,
-                               encoding->type_ids.begin() + ranges[0].second);
-  new_encoding.tokens.assign(encoding->tokens.begin() + ranges[0].first,
-                             encoding->tokens.begin() + ranges[0].second);
-  new_encoding.offsets.assign(encoding->offsets.begin() + ranges[0].first,
-                              encoding->offsets.begin() + ranges[0].second);
-  new_encoding.word_ids.assign(encoding->word_ids.begin() + ranges[0].first,
-                               encoding->word_ids.begin() + ranges[0].second);
-  new_encoding.special_tokens_mask.assign(
-      encoding->special_tokens_mask.begin() + ranges[0].first,
-      encoding->special_tokens_mask.begin() + ranges[0].second);
-  new_encoding.attention_mask.assign(
-      encoding->attention_mask.begin() + ranges[0].first,
-      encoding->attention_mask.begin() + ranges[0].second);
-
+  Encoding new_encoding =
+      sliceEncoding(*encoding, ranges[0].first, ranges[0].second);
   new_encoding.overflowing.reserve(ranges.size() - 1);
   for (int i = 1; i < ranges.size(); i++) {
-    new_encoding.overflowing.emplace_back(Encoding(
-        std::vector<int>(encoding->ids.begin() + ranges[i].first,
-                         encoding->ids.begin() + ranges[i].second),
-        std::vector<int>(encoding->type_ids.begin() + ranges[i].first,
-                         encoding->type_ids.begin() + ranges[i].second),
-        std::vector<std::string>(encoding->tokens.begin() + ranges[i].first,
-                                 encoding->tokens.begin() + ranges[i].second),
-        std::vector<std::pair<int, int>>(
-            encoding->offsets.begin() + ranges[i].first,
-            encoding->offsets.begin() + ranges[i].second),
-        std::vector<std::optional<int>>(
-            encoding->word_ids.begin() + ranges[i].first,
-            encoding->word_ids.begin() + ranges[i].second),
-        std::vector<int>(
-            encoding->special_tokens_mask.begin() + ranges[i].first,
-            encoding->special_tokens_mask.begin() + ranges[i].second),
-        std::vector<int>(encoding->attention_mask.begin() + ranges[i].first,
-                         encoding->attention_mask.begin() + ranges[i].second)));
+    new_encoding.overflowing.emplace_back(
+        sliceEncoding(*encoding, ranges[i].first, ranges[i].second));
   }
-  *encoding = new_encoding;
+  *encoding = std::move(new_encoding);
 }
 
 std::vector<Encoding> Truncation::TruncateEncodings(
-    const std::vector<Encoding>& encodings) {
+    const std::vector<Encoding>& encodings, int added_tokens) {
   std::vector<Encoding> result = encodings;
-  if (max_length_ == 0) {
+  int max_length = std::max(0, max_length_ - added_tokens);
+  if (max_length == 0) {
     for (int i = 0; i < result.size(); i++) {
-      TruncateEncoding(&result[i], max_length_, stride_, direction_);
+      TruncateEncoding(&result[i], max_length, stride_, direction_);
     }
     return result;
   }
 
   int total_length =
       result[0].ids.size() + (result.size() > 1 ? result[1].ids.size() : 0);
-  if (total_length <= max_length_) {
+  if (total_length <= max_length) {
     return result;
   }
-  int to_remove = total_length - max_length_;
+  int to_remove = total_length - max_length;
 
   if (strategy_ == TruncationStrategy::kLongestFirst) {
     if (result.size() > 1) {
@@ -139,14 +137,14 @@ std::vector<Encoding> Truncation::TruncateEncodings(
         swap = true;
         std::swap(n1, n2);
       }
-      if (n1 > max_length_) {
+      if (n1 > max_length) {
         n2 = n1;
       } else {
-        n2 = std::max(n1, max_length_ - n1);
+        n2 = std::max(n1, max_length - n1);
       }
-      if (n1 + n2 > max_length_) {
-        n1 = max_length_ / 2;
-        n2 = n1 + max_length_ % 2;
+      if (n1 + n2 > max_length) {
+        n1 = max_length / 2;
+        n2 = n1 + max_length % 2;
       }
       if (swap) {
         std::swap(n1, n2);
@@ -159,6 +157,10 @@ std::vector<Encoding> Truncation::TruncateEncodings(
     }
   } else if (strategy_ == TruncationStrategy::kOnlyFirst ||
              strategy_ == TruncationStrategy::kOnlySecond) {
+    if (strategy_ == TruncationStrategy::kOnlySecond && result.size() < 2) {
+      throw std::invalid_argument(
+          "truncating only the second sequence needs a pair of sequences");
+    }
     int target_length = strategy_ == TruncationStrategy::kOnlyFirst
                             ? result[0].ids.size()
                             : result[1].ids.size();
@@ -205,34 +207,24 @@ void PadEncoding(Encoding* encoding, int target_length, int pad_id,
   }
 
   int pad_length = target_length - encoding->ids.size();
+  bool pad_all = encoding->ids.empty();
+  // Fields that were not requested when encoding are left empty.
+  auto pad = [&](auto& vec, const auto& value) {
+    if (vec.empty() && !pad_all) {
+      return;
+    }
+    auto position =
+        direction == PaddingDirection::kLeft ? vec.begin() : vec.end();
+    vec.insert(position, pad_length, value);
+  };
 
-  if (direction == PaddingDirection::kLeft) {
-    encoding->ids.insert(encoding->ids.begin(), pad_length, pad_id);
-    encoding->type_ids.insert(encoding->type_ids.begin(), pad_length,
-                              pad_type_id);
-    encoding->tokens.insert(encoding->tokens.begin(), pad_length, pad_token);
-    encoding->offsets.insert(encoding->offsets.begin(), pad_length,
-                             std::make_pair(0, 0));
-    encoding->word_ids.insert(encoding->word_ids.begin(), pad_length,
-                              std::nullopt);
-    encoding->special_tokens_mask.insert(encoding->special_tokens_mask.begin(),
-                                         pad_length, 1);
-    encoding->attention_mask.insert(encoding->attention_mask.begin(),
-                                    pad_length, 0);
-  } else {
-    encoding->ids.insert(encoding->ids.end(), pad_length, pad_id);
-    encoding->type_ids.insert(encoding->type_ids.end(), pad_length,
-                              pad_type_id);
-    encoding->tokens.insert(encoding->tokens.end(), pad_length, pad_token);
-    encoding->offsets.insert(encoding->offsets.end(), pad_length,
-                             std::make_pair(0, 0));
-    encoding->word_ids.insert(encoding->word_ids.end(), pad_length,
-                              std::nullopt);
-    encoding->special_tokens_mask.insert(encoding->special_tokens_mask.end(),
-                                         pad_length, 1);
-    encoding->attention_mask.insert(encoding->attention_mask.end(), pad_length,
-                                    0);
-  }
+  pad(encoding->ids, pad_id);
+  pad(encoding->type_ids, pad_type_id);
+  pad(encoding->tokens, std::pmr::string(pad_token));
+  pad(encoding->offsets, std::make_pair(0, 0));
+  pad(encoding->word_ids, std::optional<int>());
+  pad(encoding->special_tokens_mask, 1);
+  pad(encoding->attention_mask, 0);
 }
 
 std::vector<Encoding> Padding::PadEncodings(
@@ -263,6 +255,38 @@ std::vector<Encoding> Padding::PadEncodings(
   return result;
 }
 
+std::vector<std::vector<int>> BucketByLength(const std::vector<int>& lengths,
+                                             int max_batch_size,
+                                             double max_padding_ratio) {
+  std::vector<int> order(lengths.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return lengths[a] < lengths[b];
+  });
+  std::vector<std::vector<int>> buckets;
+  std::vector<int> bucket;
+  int64_t bucket_tokens = 0;
+  for (int index : order) {
+    // Sorted ascending, so the new sequence is the longest of the bucket.
+    int64_t padded_tokens =
+        static_cast<int64_t>(lengths[index]) * (bucket.size() + 1);
+    int64_t padding_tokens = padded_tokens - bucket_tokens - lengths[index];
+    if (!bucket.empty() &&
+        (bucket.size() >= max_batch_size ||
+         padding_tokens > max_padding_ratio * padded_tokens)) {
+      buckets.emplace_back(std::move(bucket));
+      bucket.clear();
+      bucket_tokens = 0;
+    }
+    bucket.emplace_back(index);
+    bucket_tokens += lengths[index];
+  }
+  if (!bucket.empty()) {
+    buckets.emplace_back(std::move(bucket));
+  }
+  return buckets;
+}
+
 // TODO(omkar): Add Aho-Corasick algorithm for better performance
 std::vector<std::pair<int, int>> FindMatches(
     const icu::UnicodeString& input,
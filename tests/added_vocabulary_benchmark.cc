@@ -92,6 +92,29 @@ static void BM_AddedVocabularyFindSplitsLStripAndRStrip(
   }
 }
 
+// Added tokens are rare in real text, most inputs hold none of their first
+// characters and some hold those characters but no added token.
+static void BM_AddedVocabularyFindSplitsRareMatch(
+    benchmark::State& state) { // NOLINT
+  AddedVocabulary added_vocabulary(
+      {AddedToken(0, "[CLS]", false, false, false, false, true),
+       AddedToken(1, "[SEP]", false, false, false, false, true),
+       AddedToken(2, "[MASK]", false, false, false, false, true),
+       AddedToken(3, "<|endoftext|>", false, false, false, false, true)});
+  std::string text;
+  for (int i = 0; i < 64; i++) {
+    text += "The capital of India is New Delhi. ";
+  }
+  if (state.range(0) == 1)
+    text += "See [1] and a < b.";
+  NormalizerResult input =
+      NormalizerResult(icu::UnicodeString::fromUTF8(text));
+  for (auto _ : state) {
+    std::vector<NormalizerResult> output = added_vocabulary.FindSplits(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
 BENCHMARK(BM_AddedVocabularyIsSpecialTokenTrue)->ThreadPerCpu();
 BENCHMARK(BM_AddedVocabularyIsSpecialTokenFalse)->ThreadPerCpu();
 BENCHMARK(BM_AddedVocabularyFindSplitsSpecialToken)->ThreadPerCpu();
@@ -99,3 +122,4 @@ BENCHMARK(BM_AddedVocabularyFindSplitsSingleWord)->ThreadPerCpu();
 BENCHMARK(BM_AddedVocabularyFindSplitsLStrip)->ThreadPerCpu();
 BENCHMARK(BM_AddedVocabularyFindSplitsRStrip)->ThreadPerCpu();
 BENCHMARK(BM_AddedVocabularyFindSplitsLStripAndRStrip)->ThreadPerCpu();
+BENCHMARK(BM_AddedVocabularyFindSplitsRareMatch)->Arg(0)->Arg(1);
@@ -136,3 +136,23 @@ TEST(AddedVocabularyFindSplits, LStripAndRStrip) {
   std::vector<NormalizerResult> got_result = added_vocabulary.FindSplits(input);
   assertAddedVocabularyValues(got_result, expected_result);
 }
+
+TEST(AddedVocabularyFindSplits, NoFirstCharacter) {
+  AddedVocabulary added_vocabulary(
+      {AddedToken(0, "[MASK]", false, false, false, false, true),
+       AddedToken(1, "<|im_start|>", false, false, false, false, true),
+       AddedToken(2, u8"世界", false, false, false, false, false)});
+  ASSERT_FALSE(added_vocabulary.MayMatch(icu::UnicodeString("Capital of")));
+  ASSERT_TRUE(added_vocabulary.MayMatch(icu::UnicodeString("a < b")));
+  ASSERT_TRUE(added_vocabulary.MayMatch(
+      icu::UnicodeString::fromUTF8(u8"hello 世")));
+  ASSERT_FALSE(added_vocabulary.MayMatch(
+      icu::UnicodeString::fromUTF8(u8"hello 界")));
+
+  NormalizerResult input =
+      NormalizerResult(icu::UnicodeString("Capital of India"));
+  assertAddedVocabularyValues(added_vocabulary.FindSplits(input), {input});
+  // A first character without the rest of a token also leaves one split.
+  input = NormalizerResult(icu::UnicodeString("is [MASK or <|im_end|>"));
+  assertAddedVocabularyValues(added_vocabulary.FindSplits(input), {input});
+}
@@ -0,0 +1,276 @@
+// Copyright 2025 Omkar Prabhu
+// Heap allocations per call of each stage of the pipeline, reported as the
+// allocs and alloc_bytes counters. Built with -DCOUNT_ALLOCATIONS=ON, which
+// interposes malloc on glibc, catching operator new and ICU as well, and
+// replaces operator new elsewhere. The counting slows down every benchmark
+// of the binary, so it is off by default. CI checks the counters against
+// tests/allocation_baseline.json with scripts/check_allocations.py.
+#include <benchmark/benchmark.h>
+#include <unicode/unistr.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tokenizers/common.h"
+#include "tokenizers/normalizer.h"
+#include "tokenizers/pre_tokenizer.h"
+#include "tokenizers/tokenizer.h"
+
+#ifdef TOKENIZERS_COUNT_ALLOCATIONS
+
+namespace {
+
+std::atomic<int64_t> num_allocations{0};
+std::atomic<int64_t> allocated_bytes{0};
+
+void countAllocation(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size) {
+  countAllocation(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  countAllocation(count * size);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  countAllocation(size);
+  return __libc_realloc(ptr, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  countAllocation(size);
+  return __libc_memalign(alignment, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+  countAllocation(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+  countAllocation(size);
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr == nullptr ? ENOMEM : 0;
+}
+
+} // extern "C"
+
+#else
+
+// Without glibc only C++ allocations are counted.
+void *operator new(size_t size) {
+  countAllocation(size);
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  countAllocation(size);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+#endif
+
+using tokenizers::Encoding;
+using tokenizers::Token;
+using tokenizers::Tokenizer;
+using tokenizers::normalizers::NormalizerResult;
+using tokenizers::pre_tokenizers::PreTokenizerResult;
+
+static const char kAllocationConfigPath[] =
+    "../../scripts/tokenizers/bert-base-uncased.json";
+static const char kAllocationInput[] =
+    u8"Hello world! I'm learning BERT-based NLP with unaffordable costs in "
+    u8"São Paulo, 北京大学, and Python是一种编程语言.";
+
+static std::string readAllocationConfig() {
+  std::ifstream file(kAllocationConfigPath);
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+// Counts the allocations made between construction and Report, averaged
+// over the calls, `calls_per_iteration` in each iteration of the benchmark.
+class AllocationCounter {
+ public:
+  AllocationCounter()
+      : allocations_(num_allocations.load(std::memory_order_relaxed)),
+        bytes_(allocated_bytes.load(std::memory_order_relaxed)) {}
+
+  void Report(benchmark::State &state, // NOLINT
+              int calls_per_iteration = 1) const {
+    double allocations =
+        num_allocations.load(std::memory_order_relaxed) - allocations_;
+    double bytes = allocated_bytes.load(std::memory_order_relaxed) - bytes_;
+    state.counters["allocs"] = benchmark::Counter(
+        allocations / calls_per_iteration, benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes"] = benchmark::Counter(
+        bytes / calls_per_iteration, benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  int64_t allocations_;
+  int64_t bytes_;
+};
+
+// The VmRSS or VmHWM line of /proc/self/status in bytes, -1 when there is
+// none.
+static int64_t readProcStatus(const std::string &key) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, key.size() + 1, key + ":") == 0) {
+      return std::stoll(line.substr(key.size() + 1)) * 1024;
+    }
+  }
+  return -1;
+}
+
+static void BM_AllocationsLoad(benchmark::State &state) { // NOLINT
+  std::string config = readAllocationConfig();
+  // Linux resets the peak resident size when "5" is written to clear_refs,
+  // so the first load's peak is measured from the current resident size.
+  // Without the reset the peak is the process's so far, and is not
+  // reported.
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  bool reset = static_cast<bool>(clear_refs << "5" << std::flush);
+  int64_t rss = readProcStatus("VmRSS");
+  {
+    Tokenizer tokenizer(config);
+    benchmark::DoNotOptimize(tokenizer);
+  }
+  int64_t peak_rss = readProcStatus("VmHWM");
+  if (reset && rss >= 0 && peak_rss >= 0) {
+    state.counters["peak_rss"] = peak_rss - rss;
+  }
+
+  AllocationCounter counter;
+  for (auto _ : state) {
+    Tokenizer tokenizer(config);
+    benchmark::DoNotOptimize(tokenizer);
+  }
+  counter.Report(state);
+}
+
+static void BM_AllocationsEncode(benchmark::State &state) { // NOLINT
+  Tokenizer tokenizer(readAllocationConfig());
+  std::string input = kAllocationInput;
+  tokenizer.Encode(input);
+  AllocationCounter counter;
+  for (auto _ : state) {
+    Encoding encoding = tokenizer.Encode(input);
+    benchmark::DoNotOptimize(encoding);
+  }
+  counter.Report(state);
+}
+
+static void BM_AllocationsDecode(benchmark::State &state) { // NOLINT
+  Tokenizer tokenizer(readAllocationConfig());
+  Encoding encoding = tokenizer.Encode(kAllocationInput);
+  std::vector<int> ids(encoding.ids.begin(), encoding.ids.end());
+  // The first decode builds the decode tables.
+  tokenizer.Decode(ids);
+  AllocationCounter counter;
+  for (auto _ : state) {
+    std::string text = tokenizer.Decode(ids);
+    benchmark::DoNotOptimize(text);
+  }
+  counter.Report(state);
+}
+
+// The stages are called as Encode calls them, the normalizer on a copy of
+// the input.
+static void BM_AllocationsNormalize(benchmark::State &state) { // NOLINT
+  Tokenizer tokenizer(readAllocationConfig());
+  NormalizerResult input(icu::UnicodeString::fromUTF8(kAllocationInput));
+  AllocationCounter counter;
+  for (auto _ : state) {
+    NormalizerResult normalized = tokenizer.normalizer->Normalize(input);
+    benchmark::DoNotOptimize(normalized);
+  }
+  counter.Report(state);
+}
+
+static void BM_AllocationsPreTokenize(benchmark::State &state) { // NOLINT
+  Tokenizer tokenizer(readAllocationConfig());
+  PreTokenizerResult input(
+      tokenizer.normalizer
+          ->Normalize(NormalizerResult(
+              icu::UnicodeString::fromUTF8(kAllocationInput)))
+          .normalized);
+  AllocationCounter counter;
+  for (auto _ : state) {
+    PreTokenizerResult pre_tokenized =
+        tokenizer.pre_tokenizer->PreTokenize(input);
+    benchmark::DoNotOptimize(pre_tokenized);
+  }
+  counter.Report(state);
+}
+
+// Counted per call, one call per word of the input.
+static void BM_AllocationsTokenize(benchmark::State &state) { // NOLINT
+  Tokenizer tokenizer(readAllocationConfig());
+  PreTokenizerResult words = tokenizer.pre_tokenizer->PreTokenize(
+      PreTokenizerResult(tokenizer.normalizer
+                             ->Normalize(NormalizerResult(
+                                 icu::UnicodeString::fromUTF8(
+                                     kAllocationInput)))
+                             .normalized));
+  AllocationCounter counter;
+  for (auto _ : state) {
+    for (const icu::UnicodeString &word : words.pre_tokenized) {
+      std::vector<Token> tokens =
+          tokenizer.model->Tokenize(word, {0, word.length()});
+      benchmark::DoNotOptimize(tokens);
+    }
+  }
+  counter.Report(state, words.pre_tokenized.size());
+}
+
+BENCHMARK(BM_AllocationsLoad)->Iterations(20);
+BENCHMARK(BM_AllocationsEncode);
+BENCHMARK(BM_AllocationsDecode);
+BENCHMARK(BM_AllocationsNormalize);
+BENCHMARK(BM_AllocationsPreTokenize);
+BENCHMARK(BM_AllocationsTokenize);
+
+#endif // TOKENIZERS_COUNT_ALLOCATIONS
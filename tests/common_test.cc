@@ -0,0 +1,90 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/common.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using tokenizers::CompactEncoding;
+using tokenizers::EncodeOptions;
+using tokenizers::Encoding;
+
+void assertCompactEncodingValues(const Encoding& got,
+                                 const Encoding& expected) {
+  ASSERT_EQ(got.ids, expected.ids);
+  ASSERT_EQ(got.type_ids, expected.type_ids);
+  ASSERT_EQ(got.tokens, expected.tokens);
+  ASSERT_EQ(got.offsets, expected.offsets);
+  ASSERT_EQ(got.word_ids, expected.word_ids);
+  ASSERT_EQ(got.special_tokens_mask, expected.special_tokens_mask);
+  ASSERT_EQ(got.attention_mask, expected.attention_mask);
+  ASSERT_EQ(got.overflowing.size(), expected.overflowing.size());
+  for (int i = 0; i < got.overflowing.size(); i++) {
+    assertCompactEncodingValues(got.overflowing[i], expected.overflowing[i]);
+  }
+}
+
+TEST(CompactEncodingTest, RoundTrip) {
+  Encoding encoding({101, 7592, 2088, 102}, {0, 0, 1, 1},
+                    {"[CLS]", "hello", "a-rather-long-wordpiece-token",
+                     "[SEP]"},
+                    {{0, 0}, {0, 5}, {6, 35}, {0, 0}},
+                    {std::nullopt, 0, 1, std::nullopt}, {1, 0, 0, 1},
+                    {1, 1, 1, 0});
+  encoding.overflowing.emplace_back(Encoding({2088}, {1}, {"world"}, {{6, 11}},
+                                             {0}, {0}, {1}));
+  CompactEncoding compact(encoding);
+  ASSERT_EQ(compact.size(), 4);
+  ASSERT_EQ(compact.fields(), EncodeOptions::kAllFields);
+  ASSERT_TRUE(compact.narrow_ids());
+  ASSERT_EQ(compact.id(1), 7592);
+  ASSERT_EQ(compact.token(2), "a-rather-long-wordpiece-token");
+  ASSERT_EQ(compact.word_id(0), std::nullopt);
+  ASSERT_EQ(compact.word_id(2), 1);
+  ASSERT_EQ(compact.special_tokens_mask(3), 1);
+  ASSERT_EQ(compact.attention_mask(3), 0);
+  int64_t ids[4];
+  compact.CopyIds(ids);
+  ASSERT_EQ(ids[3], 102);
+  assertCompactEncodingValues(compact.ToEncoding(), encoding);
+}
+
+TEST(CompactEncodingTest, WideIdsAndMissingFields) {
+  Encoding encoding;
+  encoding.ids = {5, 70000, 128000};
+  encoding.attention_mask = {1, 1, 1};
+  CompactEncoding compact(encoding);
+  ASSERT_FALSE(compact.narrow_ids());
+  ASSERT_EQ(compact.id(2), 128000);
+  ASSERT_EQ(compact.fields(), EncodeOptions::kAttentionMask);
+  assertCompactEncodingValues(compact.ToEncoding(), encoding);
+
+  encoding.type_ids = {0, 0, 256};
+  EXPECT_THROW({ CompactEncoding invalid(encoding); }, std::invalid_argument);
+}
+
+TEST(CompactEncodingTest, MemoryUsage) {
+  Encoding encoding;
+  for (int i = 0; i < 512; i++) {
+    encoding.ids.emplace_back(1000 + i);
+    encoding.type_ids.emplace_back(0);
+    encoding.tokens.emplace_back("tok" + std::to_string(i % 10));
+    encoding.offsets.emplace_back(4 * i, 4 * i + 3);
+    encoding.word_ids.emplace_back(i);
+    encoding.special_tokens_mask.emplace_back(0);
+    encoding.attention_mask.emplace_back(1);
+  }
+  CompactEncoding compact(encoding);
+  ASSERT_GT(encoding.MemoryUsage(), 3 * compact.MemoryUsage());
+}
+
+TEST(HeapUsageTest, String) {
+  ASSERT_EQ(tokenizers::HeapUsage(std::string()), 0);
+  std::string heap(std::string().capacity() + 1, 'a');
+  ASSERT_GT(tokenizers::HeapUsage(heap), heap.size());
+}
@@ -0,0 +1,146 @@
+// Copyright 2025 Omkar Prabhu
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tokenizers/common.h"
+#include "tokenizers/stats.h"
+#include "tokenizers/tokenizer.h"
+
+using tokenizers::Encoding;
+using tokenizers::Stage;
+using tokenizers::Tokenizer;
+using tokenizers::TokenizerStats;
+
+// Run from the build's tests directory, like the other benchmarks.
+const char* kTokenizerPath = "../../scripts/tokenizers/bert-base-uncased.json";
+const char* kCorpusDir = "../../tests/corpus/";
+const std::vector<std::string> kCorpora = {
+    "web_en", "cjk", "european", "code", "chat_emoji", "long_document"};
+const std::vector<std::pair<Stage, std::string>> kStageNames = {
+    {Stage::kAddedVocabulary, "added_vocabulary"},
+    {Stage::kNormalizer, "normalize"},
+    {Stage::kPreTokenizer, "pre_tokenize"},
+    {Stage::kModel, "model"},
+    {Stage::kPostProcessor, "post_process"}};
+
+std::string read_file_for_benchmark(const std::string& filepath) {
+  std::ifstream file(filepath);
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+Tokenizer& bertTokenizer() {
+  static Tokenizer tokenizer(read_file_for_benchmark(kTokenizerPath));
+  return tokenizer;
+}
+
+// Repeats a corpus up to `length` bytes, cut back to a UTF-8 boundary.
+const std::string& corpusInput(int corpus, int length) {
+  static std::unordered_map<int64_t, std::string> inputs;
+  int64_t key = (static_cast<int64_t>(corpus) << 32) | length;
+  auto it = inputs.find(key);
+  if (it != inputs.end()) {
+    return it->second;
+  }
+  std::string text =
+      read_file_for_benchmark(kCorpusDir + kCorpora[corpus] + ".txt");
+  if (text.empty()) {
+    return inputs[key];
+  }
+  std::string input;
+  input.reserve(length + text.size());
+  while (input.size() < length) {
+    input += text;
+  }
+  int end = length;
+  while (end > 0 && (static_cast<unsigned char>(input[end]) & 0xC0) == 0x80) {
+    end--;
+  }
+  input.resize(end);
+  return inputs[key] = std::move(input);
+}
+
+bool setUpCorpus(benchmark::State& state, const std::string** input) {
+  *input = &corpusInput(state.range(0), state.range(1));
+  if ((*input)->empty()) {
+    state.SkipWithError("corpus or tokenizer config not found");
+    return false;
+  }
+  state.SetLabel(kCorpora[state.range(0)]);
+  return true;
+}
+
+void setThroughputCounters(benchmark::State& state, const std::string& input,
+                           int64_t tokens) {
+  state.SetBytesProcessed(state.iterations() * input.size());
+  state.counters["tokens"] = tokens;
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      tokens * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+static void BM_CorpusEncode(benchmark::State& state) { // NOLINT
+  Tokenizer& tokenizer = bertTokenizer();
+  const std::string* input;
+  if (!setUpCorpus(state, &input)) {
+    return;
+  }
+  int64_t tokens = 0;
+  for (auto _ : state) {
+    Encoding output = tokenizer.Encode(*input);
+    tokens = output.ids.size();
+    benchmark::DoNotOptimize(output);
+  }
+  setThroughputCounters(state, *input, tokens);
+}
+
+// Reports the time Tokenizer::Encode spends in each stage per iteration,
+// taken from its Stats. Needs a build with -DENABLE_STATS=ON.
+static void BM_CorpusEncodeStages(benchmark::State& state) { // NOLINT
+  if (!tokenizers::kStatsCompiled) {
+    state.SkipWithError("stats are not compiled in, build with ENABLE_STATS");
+    return;
+  }
+  Tokenizer& tokenizer = bertTokenizer();
+  const std::string* input;
+  if (!setUpCorpus(state, &input)) {
+    return;
+  }
+  tokenizer.ResetStats();
+  tokenizer.EnableStats();
+  int64_t tokens = 0;
+  for (auto _ : state) {
+    Encoding output = tokenizer.Encode(*input);
+    tokens = output.ids.size();
+    benchmark::DoNotOptimize(output);
+  }
+  TokenizerStats stats = tokenizer.Stats();
+  tokenizer.EnableStats(false);
+  setThroughputCounters(state, *input, tokens);
+  for (const auto& [stage, name] : kStageNames) {
+    state.counters[name] =
+        benchmark::Counter(stats.stage(stage).nanoseconds * 1e-9,
+                           benchmark::Counter::kAvgIterations);
+  }
+}
+
+// Inputs from 16 B to 1 MiB, so that costs growing faster than the input
+// show up. Past the size of a corpus the text repeats, which the WordPiece
+// model of bert-base-uncased does not cache.
+void corpusArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"corpus", "bytes"});
+  for (int corpus = 0; corpus < kCorpora.size(); corpus++) {
+    for (int length = 16; length <= (1 << 20); length *= 16) {
+      benchmark->Args({corpus, length});
+    }
+  }
+}
+
+BENCHMARK(BM_CorpusEncode)->Apply(corpusArguments);
+BENCHMARK(BM_CorpusEncodeStages)->Apply(corpusArguments);
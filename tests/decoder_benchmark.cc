@@ -7,6 +7,7 @@
 #include "tokenizers/decoder.h"
 
 using tokenizers::decoders::Decoder;
+using tokenizers::decoders::Metaspace;
 using tokenizers::decoders::WordPieceDecoder;
 
 static void BM_WordPieceDecoderAllOps(benchmark::State& state) { // NOLINT
@@ -19,4 +20,15 @@ static void BM_WordPieceDecoderAllOps(benchmark::State& state) { // NOLINT
   }
 }
 
+static void BM_MetaspaceDecoder(benchmark::State& state) { // NOLINT
+  Metaspace decoder;
+  std::vector<std::string> input = {u8"▁Hey", u8"▁my", u8"▁fri", u8"end",
+                                    u8"▁how", u8"▁are", u8"▁you", u8"?"};
+  for (auto _ : state) {
+    std::vector<std::string> output = decoder.DecodeChain(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
 BENCHMARK(BM_WordPieceDecoderAllOps)->ThreadPerCpu();
+BENCHMARK(BM_MetaspaceDecoder)->ThreadPerCpu();
@@ -5,9 +5,12 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
+using tokenizers::decoders::ByteLevel;
 using tokenizers::decoders::Decoder;
+using tokenizers::decoders::Metaspace;
 using tokenizers::decoders::WordPieceDecoder;
 
 void assertDecoderValues(const std::vector<std::string>& got,
@@ -32,3 +35,58 @@ TEST(WordPieceDecoderTest, AllOptions) {
   std::vector<std::string> got_tokens = decoder.DecodeChain(input);
   assertDecoderValues(got_tokens, expected_tokens);
 }
+
+// Decode appends what DecodeChain returns, joined.
+void assertDecodeMatchesChain(Decoder* decoder,
+                              const std::vector<std::string>& input) {
+  std::string expected;
+  for (const std::string& token : decoder->DecodeChain(input)) {
+    expected += token;
+  }
+  std::string got = "prefix";
+  decoder->Decode(std::vector<std::string_view>(input.begin(), input.end()),
+                  &got);
+  ASSERT_EQ(got, "prefix" + expected);
+}
+
+TEST(WordPieceDecoderTest, Decode) {
+  WordPieceDecoder decoder;
+  assertDecodeMatchesChain(&decoder, {"##uelo", "Ara", "##új", "##o", "No",
+                                      "##guera", ".", "do", "n't", "a b",
+                                      "' "});
+  WordPieceDecoder no_cleanup("##", false);
+  assertDecodeMatchesChain(&no_cleanup, {"hello", ".", "##s", "do", "not"});
+  assertDecodeMatchesChain(&decoder, {});
+}
+
+TEST(MetaspaceDecoderTest, AddPrefixSpace) {
+  Metaspace decoder;
+  std::vector<std::string> input = {u8"▁Hey", u8"▁", u8"▁friend", u8"!"};
+  std::vector<std::string> expected_tokens = {u8"Hey", u8" ", u8" friend",
+                                              u8"!"};
+  assertDecoderValues(decoder.DecodeChain(input), expected_tokens);
+}
+
+TEST(MetaspaceDecoderTest, NoPrefixSpace) {
+  Metaspace decoder(u8"▁", false);
+  std::vector<std::string> input = {u8"▁Hey", u8"▁friend"};
+  std::vector<std::string> expected_tokens = {u8" Hey", u8" friend"};
+  assertDecoderValues(decoder.DecodeChain(input), expected_tokens);
+}
+
+TEST(MetaspaceDecoderTest, Decode) {
+  Metaspace decoder;
+  assertDecodeMatchesChain(&decoder,
+                           {u8"▁Hey", u8"▁", u8"▁friend", u8"!", u8"▁▁a"});
+  Metaspace no_prefix_space(u8"▁", false);
+  assertDecodeMatchesChain(&no_prefix_space, {u8"▁Hey", u8"▁friend"});
+}
+
+TEST(ByteLevelDecoderTest, DecodeChain) {
+  ByteLevel decoder;
+  std::vector<std::string> input = {u8"ĠHey", u8"Ġfriend", u8"!", u8"ĠS",
+                                    u8"Ã£", u8"o", u8"<s>"};
+  std::vector<std::string> expected_tokens = {u8" Hey friend! São<s>"};
+  assertDecoderValues(decoder.DecodeChain(input), expected_tokens);
+  assertDecodeMatchesChain(&decoder, input);
+}
@@ -0,0 +1,98 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/executor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+using tokenizers::WorkStealingExecutor;
+
+TEST(WorkStealingExecutorTest, RunsAllTasks) {
+  WorkStealingExecutor executor(4);
+  ASSERT_EQ(executor.num_threads(), 4);
+  for (int run = 0; run < 3; run++) {
+    std::vector<int> results(100, 0);
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < results.size(); i++) {
+      tasks.emplace_back([&results, i]() { results[i] = i * i; });
+    }
+    executor.Run(std::move(tasks));
+    for (int i = 0; i < results.size(); i++) {
+      ASSERT_EQ(results[i], i * i);
+    }
+  }
+}
+
+TEST(WorkStealingExecutorTest, StealsFromBusyWorker) {
+  WorkStealingExecutor executor(2);
+  std::atomic<bool> release(false);
+  std::atomic<int> done(0);
+  std::vector<std::function<void()>> tasks;
+  // Worker 0 blocks on its first task until worker 1 has also run every
+  // task dealt to worker 0.
+  tasks.emplace_back([&]() {
+    while (done.load() < 9) {
+    }
+    release = true;
+  });
+  for (int i = 0; i < 9; i++) {
+    tasks.emplace_back([&]() { done++; });
+  }
+  executor.Run(std::move(tasks));
+  ASSERT_TRUE(release);
+  ASSERT_EQ(done, 9);
+}
+
+TEST(WorkStealingExecutorTest, RethrowsException) {
+  WorkStealingExecutor executor(3);
+  std::atomic<int> done(0);
+  std::vector<std::function<void()>> tasks;
+  for (int i = 0; i < 10; i++) {
+    tasks.emplace_back([&, i]() {
+      done++;
+      if (i == 5) {
+        throw std::runtime_error("task failed");
+      }
+    });
+  }
+  EXPECT_THROW(executor.Run(std::move(tasks)), std::runtime_error);
+  ASSERT_EQ(done, 10);
+}
+
+TEST(WorkStealingExecutorTest, NestedRun) {
+  WorkStealingExecutor executor(2);
+  std::atomic<int> done(0);
+  std::vector<std::function<void()>> tasks;
+  for (int i = 0; i < 4; i++) {
+    tasks.emplace_back([&]() {
+      std::vector<std::function<void()>> nested;
+      for (int j = 0; j < 3; j++) {
+        nested.emplace_back([&]() { done++; });
+      }
+      executor.Run(std::move(nested));
+    });
+  }
+  executor.Run(std::move(tasks));
+  ASSERT_EQ(done, 12);
+}
+
+TEST(WorkStealingExecutorTest, RethrowsAfterEarlierRun) {
+  WorkStealingExecutor executor(4);
+  for (int run = 0; run < 50; run++) {
+    std::vector<std::function<void()>> tasks;
+    tasks.emplace_back([]() {});
+    executor.Run(std::move(tasks));
+    tasks.clear();
+    for (int i = 0; i < 8; i++) {
+      tasks.emplace_back([i]() {
+        if (i == 0) {
+          throw std::runtime_error("task failed");
+        }
+      });
+    }
+    EXPECT_THROW(executor.Run(std::move(tasks)), std::runtime_error);
+  }
+}
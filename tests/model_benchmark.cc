@@ -9,7 +9,9 @@
 #include "tokenizers/model.h"
 
 using tokenizers::Token;
+using tokenizers::models::BPE;
 using tokenizers::models::Model;
+using tokenizers::models::Unigram;
 using tokenizers::models::WordPiece;
 
 static void BM_WordPieceModelIsBad(benchmark::State& state) { // NOLINT
@@ -54,7 +56,87 @@ static void BM_WordPieceModelMaxInputCharsPerWord(
   }
 }
 
+static void BM_BPEModelMerges(benchmark::State& state) { // NOLINT
+  BPE model({{u8"u", 0},
+             {u8"n", 1},
+             {u8"r", 2},
+             {u8"e", 3},
+             {u8"l", 4},
+             {u8"a", 5},
+             {u8"t", 6},
+             {u8"d", 7},
+             {u8"un", 8},
+             {u8"re", 9},
+             {u8"la", 10},
+             {u8"te", 11},
+             {u8"ted", 12},
+             {u8"unre", 13}},
+            {{u8"u", u8"n"},
+             {u8"r", u8"e"},
+             {u8"l", u8"a"},
+             {u8"t", u8"e"},
+             {u8"te", u8"d"},
+             {u8"un", u8"re"}},
+            u8"", u8"", u8"", false, false, false, 0);
+  icu::UnicodeString input = icu::UnicodeString::fromUTF8(u8"unrelated");
+  for (auto _ : state) {
+    std::vector<Token> output = model.Tokenize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_BPEModelCached(benchmark::State& state) { // NOLINT
+  BPE model({{u8"u", 0},
+             {u8"n", 1},
+             {u8"r", 2},
+             {u8"e", 3},
+             {u8"l", 4},
+             {u8"a", 5},
+             {u8"t", 6},
+             {u8"d", 7},
+             {u8"un", 8},
+             {u8"re", 9},
+             {u8"la", 10},
+             {u8"te", 11},
+             {u8"ted", 12},
+             {u8"unre", 13}},
+            {{u8"u", u8"n"},
+             {u8"r", u8"e"},
+             {u8"l", u8"a"},
+             {u8"t", u8"e"},
+             {u8"te", u8"d"},
+             {u8"un", u8"re"}});
+  icu::UnicodeString input = icu::UnicodeString::fromUTF8(u8"unrelated");
+  for (auto _ : state) {
+    std::vector<Token> output = model.Tokenize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_UnigramModelViterbi(benchmark::State& state) { // NOLINT
+  Unigram model({{u8"<unk>", 0.0},
+                 {u8"▁token", -3.0},
+                 {u8"▁to", -2.0},
+                 {u8"ken", -2.5},
+                 {u8"ization", -3.0},
+                 {u8"iz", -2.0},
+                 {u8"ation", -2.0},
+                 {u8"▁is", -1.5},
+                 {u8"▁important", -4.0},
+                 {u8"!", -1.0}},
+                0);
+  icu::UnicodeString input = icu::UnicodeString::fromUTF8(
+      u8"▁tokenization▁is▁important!▁tokenization▁is▁important!");
+  for (auto _ : state) {
+    std::vector<Token> output = model.Tokenize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
 BENCHMARK(BM_WordPieceModelIsBad)->ThreadPerCpu();
 BENCHMARK(BM_WordPieceModelIsFound)->ThreadPerCpu();
 BENCHMARK(BM_WordPieceUnkToken)->ThreadPerCpu();
 BENCHMARK(BM_WordPieceModelMaxInputCharsPerWord)->ThreadPerCpu();
+BENCHMARK(BM_BPEModelMerges)->ThreadPerCpu();
+BENCHMARK(BM_BPEModelCached)->ThreadPerCpu();
+BENCHMARK(BM_UnigramModelViterbi)->ThreadPerCpu();
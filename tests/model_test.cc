@@ -4,12 +4,15 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "tokenizers/common.h"
 
 using tokenizers::Token;
+using tokenizers::models::BPE;
 using tokenizers::models::Model;
+using tokenizers::models::Unigram;
 using tokenizers::models::WordPiece;
 
 void assertModelValues(const std::vector<Token>& got,
@@ -65,3 +68,173 @@ TEST(WordPieceTest, MaxInputCharsPerWord) {
   std::vector<Token> got_tokens = model.TokenizeString(input);
   assertModelValues(got_tokens, expected_tokens);
 }
+
+TEST(WordPieceTest, CountTokens) {
+  WordPiece model(
+      {{u8"[UNK]", 1}, {u8"token", 2}, {u8"##izat", 3}, {u8"##ion", 4}},
+      u8"[UNK]", u8"##", 12);
+  for (std::string input :
+       {u8"", u8"tokenization", u8"tokenizationxyz", u8"xyz", u8"tokenize"}) {
+    icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+    ASSERT_EQ(model.CountTokens(unicode_input),
+              model.Tokenize(unicode_input).size())
+        << input;
+  }
+}
+
+TEST(WordPieceTest, ReverseVocabBuiltOnFirstUse) {
+  WordPiece model({{u8"[UNK]", 1}, {u8"token", 2}, {u8"##izat", 3}},
+                  u8"[UNK]", u8"##", 100);
+  size_t memory_usage = model.MemoryUsage();
+  ASSERT_EQ(model.MemoryUsageByStructure().at("reverse_vocab"), 0);
+  model.TokenizeString(u8"tokenizat");
+  ASSERT_EQ(model.MemoryUsageByStructure().at("reverse_vocab"), 0);
+
+  std::vector<std::thread> threads;
+  std::vector<std::string> got_tokens(8);
+  for (int t = 0; t < got_tokens.size(); t++) {
+    threads.emplace_back([&, t]() {
+      got_tokens[t] = model.IdToToken(1 + t % 3).value_or("");
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int t = 0; t < got_tokens.size(); t++) {
+    ASSERT_EQ(got_tokens[t], model.IdToTokenView(1 + t % 3).value());
+  }
+  ASSERT_EQ(model.IdToToken(4), std::nullopt);
+  ASSERT_GT(model.MemoryUsageByStructure().at("reverse_vocab"), 0);
+  ASSERT_GT(model.MemoryUsage(), memory_usage);
+}
+
+TEST(BPETest, Merges) {
+  BPE model({{u8"u", 0},
+             {u8"n", 1},
+             {u8"r", 2},
+             {u8"e", 3},
+             {u8"l", 4},
+             {u8"a", 5},
+             {u8"t", 6},
+             {u8"d", 7},
+             {u8"un", 8},
+             {u8"re", 9},
+             {u8"la", 10},
+             {u8"te", 11},
+             {u8"ted", 12},
+             {u8"unre", 13}},
+            {{u8"u", u8"n"},
+             {u8"r", u8"e"},
+             {u8"l", u8"a"},
+             {u8"t", u8"e"},
+             {u8"te", u8"d"},
+             {u8"un", u8"re"}});
+  std::vector<Token> expected_tokens = {Token(u8"unre", 13, {0, 4}, false),
+                                        Token(u8"la", 10, {4, 6}, true),
+                                        Token(u8"ted", 12, {6, 9}, true)};
+  assertModelValues(model.TokenizeString(u8"unrelated"), expected_tokens);
+  // second call is served from the word cache
+  assertModelValues(model.TokenizeString(u8"unrelated"), expected_tokens);
+}
+
+TEST(BPETest, CountTokens) {
+  BPE model({{u8"a", 0}, {u8"b", 1}, {u8"ab", 2}, {u8"[UNK]", 3}},
+            {{u8"a", u8"b"}}, u8"[UNK]");
+  icu::UnicodeString input = icu::UnicodeString::fromUTF8(u8"abxab");
+  ASSERT_EQ(model.CountTokens(input), 3);
+  // second call is served from the word cache
+  ASSERT_EQ(model.CountTokens(input), 3);
+  ASSERT_EQ(model.Tokenize(input).size(), 3);
+}
+
+TEST(BPETest, MergeRank) {
+  BPE model({{u8"a", 0}, {u8"b", 1}, {u8"ab", 2}, {u8"ba", 3}},
+            {{u8"b", u8"a"}, {u8"a", u8"b"}});
+  std::vector<Token> expected_tokens = {Token(u8"a", 0, {0, 1}, false),
+                                        Token(u8"ba", 3, {1, 3}, true)};
+  assertModelValues(model.TokenizeString(u8"aba"), expected_tokens);
+}
+
+TEST(BPETest, UnkToken) {
+  BPE model({{u8"a", 0}, {u8"[UNK]", 1}}, {}, u8"[UNK]");
+  std::vector<Token> expected_tokens = {
+      Token(u8"a", 0, {0, 1}, false), Token(u8"[UNK]", 1, {1, 2}, true),
+      Token(u8"[UNK]", 1, {2, 3}, true), Token(u8"a", 0, {3, 4}, true)};
+  assertModelValues(model.TokenizeString(u8"axxa"), expected_tokens);
+}
+
+TEST(BPETest, FuseUnk) {
+  BPE model({{u8"a", 0}, {u8"[UNK]", 1}}, {}, u8"[UNK]", u8"", u8"", true);
+  std::vector<Token> expected_tokens = {Token(u8"a", 0, {0, 1}, false),
+                                        Token(u8"[UNK]", 1, {1, 3}, true),
+                                        Token(u8"a", 0, {3, 4}, true)};
+  assertModelValues(model.TokenizeString(u8"axxa"), expected_tokens);
+}
+
+TEST(BPETest, DroppedCharacter) {
+  // Without an unk token, characters out of the vocab are dropped and the
+  // symbols after them keep their own offsets.
+  BPE model({{u8"a", 0}, {u8"b", 1}}, {});
+  std::vector<Token> expected_tokens = {Token(u8"a", 0, {0, 1}, false),
+                                        Token(u8"b", 1, {2, 3}, true)};
+  assertModelValues(model.TokenizeString(u8"a?b"), expected_tokens);
+}
+
+TEST(BPETest, ByteFallback) {
+  BPE model({{u8"a", 0}, {u8"<0xC3>", 1}, {u8"<0xA9>", 2}, {u8"[UNK]", 3}},
+            {}, u8"[UNK]", u8"", u8"", false, true);
+  std::vector<Token> expected_tokens = {Token(u8"a", 0, {0, 1}, false),
+                                        Token(u8"<0xC3>", 1, {1, 2}, true),
+                                        Token(u8"<0xA9>", 2, {1, 2}, true),
+                                        Token(u8"[UNK]", 3, {2, 3}, true)};
+  assertModelValues(model.TokenizeString(u8"aéb"), expected_tokens);
+}
+
+TEST(BPETest, ContinuingSubwordPrefixAndEndOfWordSuffix) {
+  BPE model({{u8"h", 0}, {u8"##i</w>", 1}, {u8"hi</w>", 2}},
+            {{u8"h", u8"##i</w>"}}, u8"", u8"##", u8"</w>");
+  std::vector<Token> expected_tokens = {Token(u8"hi</w>", 2, {0, 2}, false)};
+  assertModelValues(model.TokenizeString(u8"hi"), expected_tokens);
+}
+
+TEST(UnigramTest, Viterbi) {
+  Unigram model({{u8"<unk>", 0.0},
+                 {u8"a", -1.0},
+                 {u8"b", -2.0},
+                 {u8"ab", -2.5},
+                 {u8"abc", -8.0},
+                 {u8"c", -1.0}},
+                0);
+  std::vector<Token> expected_tokens = {Token(u8"ab", 3, {0, 2}, false),
+                                        Token(u8"c", 5, {2, 3}, true)};
+  assertModelValues(model.TokenizeString(u8"abc"), expected_tokens);
+}
+
+TEST(UnigramTest, UnkToken) {
+  Unigram model({{u8"<unk>", 0.0}, {u8"a", -1.0}, {u8"▁", -1.0}}, 0);
+  std::vector<Token> expected_tokens = {Token(u8"▁", 2, {0, 1}, false),
+                                        Token(u8"<unk>", 0, {1, 3}, true),
+                                        Token(u8"a", 1, {3, 4}, true)};
+  assertModelValues(model.TokenizeString(u8"▁xéa"), expected_tokens);
+}
+
+TEST(UnigramTest, TokenToId) {
+  Unigram model(
+      {{u8"<unk>", 0.0}, {u8"a", -1.0}, {u8"ab", -2.0}, {u8"a", -3.0}}, 0);
+  ASSERT_EQ(model.TokenToId(u8"a"), 1);
+  ASSERT_EQ(model.TokenToId(u8"ab"), 2);
+  ASSERT_EQ(model.TokenToId(u8"<unk>"), 0);
+  ASSERT_EQ(model.TokenToId(u8"b"), std::nullopt);
+  ASSERT_EQ(model.TokenToId(u8"<un"), std::nullopt);
+  ASSERT_EQ(model.TokenToId(u8""), std::nullopt);
+}
+
+TEST(UnigramTest, ByteFallback) {
+  Unigram model({{u8"<unk>", 0.0},
+                 {u8"a", -1.0},
+                 {u8"<0xC3>", -1.0},
+                 {u8"<0xA9>", -1.0}},
+                0, true);
+  std::vector<Token> expected_tokens = {Token(u8"a", 1, {0, 1}, false),
+                                        Token(u8"<0xC3>", 2, {1, 2}, true),
+                                        Token(u8"<0xA9>", 3, {1, 2}, true)};
+  assertModelValues(model.TokenizeString(u8"aé"), expected_tokens);
+}
@@ -1,17 +1,37 @@
 // Copyright 2025 Omkar Prabhu
 #include <benchmark/benchmark.h>
+#include <unicode/normalizer2.h>
 #include <unicode/unistr.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "tokenizers/normalizer.h"
 
 using tokenizers::normalizers::BertNormalizer;
+using tokenizers::normalizers::fuseNormalizers;
 using tokenizers::normalizers::isChineseChar;
 using tokenizers::normalizers::isControl;
 using tokenizers::normalizers::isWhitespace;
+using tokenizers::normalizers::Lowercase;
+using tokenizers::normalizers::NFC;
+using tokenizers::normalizers::NFD;
 using tokenizers::normalizers::Normalizer;
 using tokenizers::normalizers::NormalizerResult;
+using tokenizers::normalizers::Prepend;
+using tokenizers::normalizers::Replace;
+using tokenizers::normalizers::Sequence;
+using tokenizers::normalizers::StripAccents;
+
+static const std::vector<std::shared_ptr<Normalizer>> kSequenceSteps = {
+    std::make_shared<Prepend>("▁"),
+    std::make_shared<Replace>(" ", "▁"), std::make_shared<StripAccents>(),
+    std::make_shared<Lowercase>()};
+
+static const char kSequenceInput[] =
+    u8"Hello, World! I'm learning BERT-based NLP with unaffordable costs in "
+    u8"S\u00E3o Paulo, \u5317\u4EAC\u5927\u5B66, and Python.";
 
 static void BM_BertNormalizerNoOp(benchmark::State& state) { // NOLINT
   NormalizerResult input =
@@ -83,6 +103,72 @@ static void BM_BertNormalizerAllOpsString(benchmark::State& state) { // NOLINT
   }
 }
 
+static void BM_NormalizerSequenceSteps(benchmark::State& state) { // NOLINT
+  NormalizerResult input =
+      NormalizerResult(icu::UnicodeString::fromUTF8(kSequenceInput));
+  Sequence normalizer(kSequenceSteps);
+  for (auto _ : state) {
+    NormalizerResult output = normalizer.Normalize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_NormalizerSequenceFused(benchmark::State& state) { // NOLINT
+  NormalizerResult input =
+      NormalizerResult(icu::UnicodeString::fromUTF8(kSequenceInput));
+  std::shared_ptr<Normalizer> normalizer = fuseNormalizers(kSequenceSteps);
+  for (auto _ : state) {
+    NormalizerResult output = normalizer->Normalize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_NormalizerSequenceFusedInstantiated(
+    benchmark::State& state) { // NOLINT
+  NormalizerResult input =
+      NormalizerResult(icu::UnicodeString::fromUTF8(kSequenceInput));
+  std::shared_ptr<Normalizer> normalizer = fuseNormalizers(
+      {kSequenceSteps[0], kSequenceSteps[1]});
+  for (auto _ : state) {
+    NormalizerResult output = normalizer->Normalize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_NFCNormalized(benchmark::State& state) { // NOLINT
+  NormalizerResult input =
+      NormalizerResult(icu::UnicodeString::fromUTF8(kSequenceInput));
+  NFC normalizer;
+  for (auto _ : state) {
+    NormalizerResult output = normalizer.Normalize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_NFCDecomposed(benchmark::State& state) { // NOLINT
+  NormalizerResult input = NFD().Normalize(
+      NormalizerResult(icu::UnicodeString::fromUTF8(kSequenceInput)));
+  NFC normalizer;
+  for (auto _ : state) {
+    NormalizerResult output = normalizer.Normalize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+// Baseline: normalizing the whole input and recomputing the offsets.
+static void BM_NFCWithoutQuickCheck(benchmark::State& state) { // NOLINT
+  NormalizerResult input =
+      NormalizerResult(icu::UnicodeString::fromUTF8(kSequenceInput));
+  UErrorCode error_code = U_ZERO_ERROR;
+  const icu::Normalizer2* normalizer =
+      icu::Normalizer2::getNFCInstance(error_code);
+  for (auto _ : state) {
+    NormalizerResult output =
+        NormalizerResult(normalizer->normalize(input.normalized, error_code));
+    benchmark::DoNotOptimize(output);
+  }
+}
+
 BENCHMARK(BM_BertNormalizerNoOp)->ThreadPerCpu();
 BENCHMARK(BM_BertNormalizerCleanText)->ThreadPerCpu();
 BENCHMARK(BM_BertNormalizerHandleChineseChars)->ThreadPerCpu();
@@ -90,4 +176,10 @@ BENCHMARK(BM_BertNormalizerStripAccents)->ThreadPerCpu();
 BENCHMARK(BM_BertNormalizerLowercase)->ThreadPerCpu();
 BENCHMARK(BM_BertNormalizerAllOps)->ThreadPerCpu();
 BENCHMARK(BM_BertNormalizerAllOpsString)->ThreadPerCpu();
+BENCHMARK(BM_NormalizerSequenceSteps)->ThreadPerCpu();
+BENCHMARK(BM_NormalizerSequenceFused)->ThreadPerCpu();
+BENCHMARK(BM_NormalizerSequenceFusedInstantiated)->ThreadPerCpu();
+BENCHMARK(BM_NFCNormalized)->ThreadPerCpu();
+BENCHMARK(BM_NFCDecomposed)->ThreadPerCpu();
+BENCHMARK(BM_NFCWithoutQuickCheck)->ThreadPerCpu();
 BENCHMARK_MAIN();
@@ -3,14 +3,29 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 using tokenizers::normalizers::BertNormalizer;
+using tokenizers::normalizers::DynamicFusedNormalizer;
+using tokenizers::normalizers::FusedNormalizer;
+using tokenizers::normalizers::fuseNormalizers;
 using tokenizers::normalizers::isChineseChar;
 using tokenizers::normalizers::isControl;
 using tokenizers::normalizers::isWhitespace;
+using tokenizers::normalizers::Lowercase;
+using tokenizers::normalizers::NFC;
+using tokenizers::normalizers::NFD;
+using tokenizers::normalizers::NFKC;
+using tokenizers::normalizers::NFKD;
 using tokenizers::normalizers::Normalizer;
 using tokenizers::normalizers::NormalizerResult;
+using tokenizers::normalizers::Prepend;
+using tokenizers::normalizers::Replace;
+using tokenizers::normalizers::Sequence;
+using tokenizers::normalizers::StripAccents;
 
 void assertNormalizerValues(const NormalizerResult& got,
                             const NormalizerResult& expected) {
@@ -134,6 +149,156 @@ TEST(BertNormalizerTest, AllOptions) {
   assertNormalizerValues(normalizer.Normalize(input), expected_result);
 }
 
+TEST(NFCTest, AlreadyNormalized) {
+  NFC normalizer;
+  NormalizerResult input = NormalizerResult(u8"h\u00E9llo 世界");
+  assertNormalizerValues(normalizer.Normalize(input), input);
+}
+
+TEST(NFCTest, Compose) {
+  NFC normalizer;
+  NormalizerResult expected_result =
+      NormalizerResult(u8"ab\u00E9\u00E9", {{0, 1}, {1, 2}, {2, 4}, {4, 5}});
+  assertNormalizerValues(
+      normalizer.Normalize(NormalizerResult(u8"abe\u0301\u00E9")),
+      expected_result);
+}
+
+TEST(NFDTest, Decompose) {
+  NFD normalizer;
+  NormalizerResult expected_result = NormalizerResult(
+      u8"e\u0301a\u1112\u1161\u11AB",
+      {{0, 1}, {0, 1}, {1, 2}, {2, 3}, {2, 3}, {2, 3}});
+  assertNormalizerValues(
+      normalizer.Normalize(NormalizerResult(u8"\u00E9a\uD55C")),
+      expected_result);
+}
+
+TEST(NFKCTest, Compatibility) {
+  NFKC normalizer;
+  NormalizerResult expected_result =
+      NormalizerResult(u8"fix1", {{0, 1}, {0, 1}, {1, 2}, {2, 3}});
+  assertNormalizerValues(
+      normalizer.Normalize(NormalizerResult(u8"\uFB01x\u2460")),
+      expected_result);
+}
+
+TEST(NFKDTest, Compatibility) {
+  NFKD normalizer;
+  ASSERT_EQ(normalizer.NormalizeString(u8"\uFB01\u00E9"), u8"fie\u0301");
+}
+
+TEST(LowercaseTest, Normalize) {
+  Lowercase normalizer;
+  NormalizerResult expected_result =
+      NormalizerResult(u8"héllo", {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}});
+  assertNormalizerValues(normalizer.Normalize(NormalizerResult(u8"HÉLlo")),
+                         expected_result);
+}
+
+TEST(LowercaseTest, FullMapping) {
+  Lowercase normalizer;
+  NormalizerResult expected_result = NormalizerResult(
+      u8"i\u0307s \u03C3\u03C2",
+      {{0, 1}, {0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}});
+  assertNormalizerValues(
+      normalizer.Normalize(NormalizerResult(u8"\u0130S \u03A3\u03A3")),
+      expected_result);
+}
+
+TEST(StripAccentsTest, Normalize) {
+  StripAccents normalizer;
+  NormalizerResult expected_result =
+      NormalizerResult(u8"ea", {{0, 1}, {2, 3}});
+  assertNormalizerValues(
+      normalizer.Normalize(NormalizerResult(u8"e\u0301a")), expected_result);
+}
+
+TEST(ReplaceTest, CharLevel) {
+  Replace normalizer(" ", "\u2581");
+  ASSERT_TRUE(normalizer.IsCharLevel());
+  NormalizerResult expected_result =
+      NormalizerResult(u8"a\u2581b", {{0, 1}, {1, 2}, {2, 3}});
+  assertNormalizerValues(normalizer.Normalize(NormalizerResult(u8"a b")),
+                         expected_result);
+}
+
+TEST(ReplaceTest, Pattern) {
+  Replace normalizer("ab", "x");
+  ASSERT_FALSE(normalizer.IsCharLevel());
+  NormalizerResult expected_result =
+      NormalizerResult(u8"xcx", {{0, 2}, {2, 3}, {3, 5}});
+  assertNormalizerValues(normalizer.Normalize(NormalizerResult(u8"abcab")),
+                         expected_result);
+}
+
+TEST(PrependTest, Normalize) {
+  Prepend normalizer("\u2581");
+  NormalizerResult expected_result =
+      NormalizerResult(u8"\u2581hi", {{0, 1}, {0, 1}, {1, 2}});
+  assertNormalizerValues(normalizer.Normalize(NormalizerResult(u8"hi")),
+                         expected_result);
+  assertNormalizerValues(normalizer.Normalize(NormalizerResult(u8"")),
+                         NormalizerResult(u8"", {}));
+}
+
+TEST(NormalizerSequenceTest, FusedMatchesSequential) {
+  std::vector<std::shared_ptr<Normalizer>> steps = {
+      std::make_shared<Replace>(" ", "\u2581"),
+      std::make_shared<Prepend>(" "), std::make_shared<StripAccents>(),
+      std::make_shared<Lowercase>()};
+  Sequence sequential(steps);
+  std::shared_ptr<Normalizer> fused = fuseNormalizers(steps);
+  ASSERT_NE(std::dynamic_pointer_cast<DynamicFusedNormalizer>(fused), nullptr);
+  NormalizerResult input = NormalizerResult(u8"He\u0301llo Wo\u0308rld");
+  NormalizerResult expected_result = sequential.Normalize(input);
+  ASSERT_EQ(fused->NormalizeString(u8"He\u0301llo Wo\u0308rld"),
+            u8" hello\u2581world");
+  assertNormalizerValues(fused->Normalize(input), expected_result);
+}
+
+TEST(NormalizerSequenceTest, FusedFullLowercase) {
+  std::vector<std::vector<std::shared_ptr<Normalizer>>> chains = {
+      {std::make_shared<Lowercase>(), std::make_shared<StripAccents>()},
+      {std::make_shared<Prepend>(" "), std::make_shared<Lowercase>(),
+       std::make_shared<Replace>(" ", "\u2581")}};
+  for (const std::vector<std::shared_ptr<Normalizer>>& steps : chains) {
+    Sequence sequential(steps);
+    std::shared_ptr<Normalizer> fused = fuseNormalizers(steps);
+    NormalizerResult input =
+        NormalizerResult(u8"\u0130STANBUL \u039F\u0394\u039F\u03A3");
+    assertNormalizerValues(fused->Normalize(input),
+                           sequential.Normalize(input));
+  }
+}
+
+TEST(NormalizerSequenceTest, UnsupportedStep) {
+  EXPECT_THROW(fuseNormalizers({std::make_shared<Lowercase>(), nullptr}),
+               std::invalid_argument);
+}
+
+TEST(NormalizerSequenceTest, FusesInstantiatedChains) {
+  std::shared_ptr<Normalizer> fused =
+      fuseNormalizers({std::make_shared<Prepend>("\u2581"),
+                       std::make_shared<Replace>(" ", "\u2581")});
+  using PrependReplace = FusedNormalizer<Prepend, Replace>;
+  ASSERT_NE(std::dynamic_pointer_cast<PrependReplace>(fused), nullptr);
+  NormalizerResult expected_result = NormalizerResult(
+      u8"\u2581a\u2581b", {{0, 1}, {0, 1}, {1, 2}, {2, 3}});
+  assertNormalizerValues(fused->Normalize(NormalizerResult(u8"a b")),
+                         expected_result);
+}
+
+TEST(NormalizerSequenceTest, KeepsOtherSteps) {
+  std::shared_ptr<Normalizer> fused = fuseNormalizers(
+      {std::make_shared<BertNormalizer>(true, false, false, false),
+       std::make_shared<Lowercase>(), std::make_shared<StripAccents>(),
+       std::make_shared<Replace>("lo", "")});
+  ASSERT_NE(std::dynamic_pointer_cast<Sequence>(fused), nullptr);
+  ASSERT_EQ(fused->NormalizeString(u8"HE\u0301L\u200BLO\tWORLD"),
+            u8"hel world");
+}
+
 TEST(NormalizerHelpersTest, IsControl) {
   EXPECT_TRUE(isControl(U'\x00'));
   EXPECT_TRUE(isControl(U'\x1F'));
@@ -3,12 +3,16 @@
 
 #include <gtest/gtest.h>
 
+#include <memory_resource>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tokenizers/common.h"
 
+using tokenizers::EncodeOptions;
 using tokenizers::Encoding;
 using tokenizers::post_processors::PostProcessor;
 using tokenizers::post_processors::TemplateProcessing;
@@ -97,3 +101,61 @@ TEST(TemplateProcessingTest, Pair) {
   std::vector<Encoding> got_encodings = post_processor.ProcessEncodings(input);
   assertPostProcessorValues(got_encodings, expected_encodings);
 }
+
+TEST(TemplateProcessingTest, ProcessPair) {
+  TemplateProcessing post_processor(
+      {TemplateProcessor("SpecialToken", 0, "[CLS]"),
+       TemplateProcessor("Sequence", 0, "A"),
+       TemplateProcessor("SpecialToken", 0, "[SEP]")},
+      {
+          TemplateProcessor("SpecialToken", 0, "[CLS]"),
+          TemplateProcessor("Sequence", 0, "A"),
+          TemplateProcessor("SpecialToken", 0, "[SEP]"),
+          TemplateProcessor("Sequence", 1, "B"),
+          TemplateProcessor("SpecialToken", 1, "[SEP]"),
+      },
+      std::unordered_map<std::string, int>({{"[CLS]", 100}, {"[SEP]", 101}}));
+  std::vector<Encoding> input = {
+      Encoding({200, 201}, {0, 0}, {"hello", "world"}, {{0, 5}, {6, 11}},
+               {0, 1}, {0, 0}, {1, 1}),
+      Encoding({300, 301}, {1, 1}, {"martin", "garrix"}, {{0, 6}, {7, 13}},
+               {0, 1}, {0, 0}, {1, 1})};
+  std::pmr::monotonic_buffer_resource resource;
+  Encoding got_encoding = post_processor.Process(
+      std::move(input), EncodeOptions::kAll, &resource);
+  ASSERT_EQ(got_encoding.ids.get_allocator().resource(), &resource);
+  ASSERT_EQ(got_encoding.ids.capacity(), 7);
+  assertPostProcessorValues(
+      {got_encoding},
+      {Encoding({100, 200, 201, 101, 300, 301, 101}, {0, 0, 0, 0, 1, 1, 1},
+                {"[CLS]", "hello", "world", "[SEP]", "martin", "garrix",
+                 "[SEP]"},
+                {{0, 0}, {0, 5}, {6, 11}, {0, 0}, {0, 6}, {7, 13}, {0, 0}},
+                {std::nullopt, 0, 1, std::nullopt, 0, 1, std::nullopt},
+                {1, 0, 0, 1, 0, 0, 1}, {1, 1, 1, 1, 1, 1, 1})});
+  ASSERT_EQ(got_encoding.word_ids[2], 1);
+}
+
+TEST(TemplateProcessingTest, ProcessIdsOnly) {
+  TemplateProcessing post_processor(
+      {TemplateProcessor("SpecialToken", 0, "[CLS]"),
+       TemplateProcessor("Sequence", 0, "A"),
+       TemplateProcessor("SpecialToken", 0, "[SEP]")},
+      {},
+      std::unordered_map<std::string, int>({{"[CLS]", 100}, {"[SEP]", 101}}));
+  Encoding sequence;
+  sequence.ids = {200, 201};
+  sequence.type_ids = {0, 0};
+  sequence.attention_mask = {1, 1};
+  std::vector<Encoding> input;
+  input.emplace_back(std::move(sequence));
+  Encoding got_encoding = post_processor.Process(
+      std::move(input), EncodeOptions::kIdsOnly,
+      std::pmr::get_default_resource());
+  ASSERT_EQ(got_encoding.ids, std::pmr::vector<int>({100, 200, 201, 101}));
+  ASSERT_EQ(got_encoding.type_ids, std::pmr::vector<int>({0, 0, 0, 0}));
+  ASSERT_EQ(got_encoding.attention_mask, std::pmr::vector<int>({1, 1, 1, 1}));
+  ASSERT_TRUE(got_encoding.tokens.empty());
+  ASSERT_TRUE(got_encoding.offsets.empty());
+  ASSERT_TRUE(got_encoding.special_tokens_mask.empty());
+}
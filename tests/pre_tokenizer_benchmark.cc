@@ -1,7 +1,9 @@
 // Copyright 2025 Omkar Prabhu
 #include <benchmark/benchmark.h>
+#include <unicode/regex.h>
 #include <unicode/unistr.h>
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -9,9 +11,16 @@
 #include "tokenizers/pre_tokenizer.h"
 
 using tokenizers::pre_tokenizers::BertPreTokenizer;
+using tokenizers::pre_tokenizers::ByteLevel;
+using tokenizers::pre_tokenizers::Digits;
+using tokenizers::pre_tokenizers::fusePreTokenizers;
+using tokenizers::pre_tokenizers::Metaspace;
 using tokenizers::pre_tokenizers::PreTokenizer;
 using tokenizers::pre_tokenizers::PreTokenizerResult;
+using tokenizers::pre_tokenizers::Punctuation;
+using tokenizers::pre_tokenizers::Sequence;
 using tokenizers::pre_tokenizers::SplitDelimiterBehavior;
+using tokenizers::pre_tokenizers::WhitespaceSplit;
 
 static void BM_PreTokenizerSplitRemoved(benchmark::State& state) { // NOLINT
   PreTokenizerResult input = PreTokenizerResult(
@@ -100,6 +109,95 @@ static void BM_BertPreTokenizerAllOpsString(benchmark::State& state) { // NOLINT
   }
 }
 
+static const char* kByteLevelInput =
+    u8"Hello world! I'm learning GPT-2 based NLP with unaffordable costs in "
+    u8"São Paulo, 北京大学, and Python是一种编程语言. We've   got 12345 "
+    u8"tokens\n\n  to split, don't we?";
+
+static void BM_ByteLevelSplitGPT2(benchmark::State& state) { // NOLINT
+  icu::UnicodeString input = icu::UnicodeString::fromUTF8(kByteLevelInput);
+  for (auto _ : state) {
+    std::vector<std::pair<int, int>> output =
+        tokenizers::pre_tokenizers::splitGPT2(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_ByteLevelSplitGPT2Regex(benchmark::State& state) { // NOLINT
+  icu::UnicodeString input = icu::UnicodeString::fromUTF8(kByteLevelInput);
+  UErrorCode status = U_ZERO_ERROR;
+  icu::RegexPattern* pattern = icu::RegexPattern::compile(
+      icu::UnicodeString::fromUTF8(
+          R"('s|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+)"
+          R"(|\s+(?!\S)|\s+)"),
+      0, status);
+  icu::RegexMatcher* matcher = pattern->matcher(status);
+  for (auto _ : state) {
+    std::vector<std::pair<int, int>> output;
+    matcher->reset(input);
+    while (matcher->find(status)) {
+      output.emplace_back(matcher->start(status), matcher->end(status));
+    }
+    benchmark::DoNotOptimize(output);
+  }
+  delete matcher;
+  delete pattern;
+}
+
+static void BM_ByteLevelSplitLlama3(benchmark::State& state) { // NOLINT
+  icu::UnicodeString input = icu::UnicodeString::fromUTF8(kByteLevelInput);
+  for (auto _ : state) {
+    std::vector<std::pair<int, int>> output =
+        tokenizers::pre_tokenizers::splitLlama3(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_ByteLevelPreTokenizer(benchmark::State& state) { // NOLINT
+  ByteLevel pre_tokenizer(true, true);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(kByteLevelInput));
+  for (auto _ : state) {
+    PreTokenizerResult output = pre_tokenizer.PreTokenize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_MetaspacePreTokenizer(benchmark::State& state) { // NOLINT
+  Metaspace pre_tokenizer;
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(kByteLevelInput));
+  for (auto _ : state) {
+    PreTokenizerResult output = pre_tokenizer.PreTokenize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static const std::vector<std::shared_ptr<PreTokenizer>> kSequenceSteps = {
+    std::make_shared<WhitespaceSplit>(), std::make_shared<Punctuation>(),
+    std::make_shared<Digits>(true)};
+
+static void BM_PreTokenizerSequenceSteps(benchmark::State& state) { // NOLINT
+  Sequence pre_tokenizer(kSequenceSteps);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(kByteLevelInput));
+  for (auto _ : state) {
+    PreTokenizerResult output = pre_tokenizer.PreTokenize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_PreTokenizerSequenceFused(benchmark::State& state) { // NOLINT
+  std::shared_ptr<PreTokenizer> pre_tokenizer =
+      fusePreTokenizers(kSequenceSteps);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(kByteLevelInput));
+  for (auto _ : state) {
+    PreTokenizerResult output = pre_tokenizer->PreTokenize(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
 BENCHMARK(BM_PreTokenizerSplitRemoved)->ThreadPerCpu();
 BENCHMARK(BM_PreTokenizerSplitIsolated)->ThreadPerCpu();
 BENCHMARK(BM_PreTokenizerSplitMergedWithPrevious)->ThreadPerCpu();
@@ -108,3 +206,10 @@ BENCHMARK(BM_BertPreTokenizerWhitespaceChars)->ThreadPerCpu();
 BENCHMARK(BM_BertPreTokenizerChineseChars)->ThreadPerCpu();
 BENCHMARK(BM_BertPreTokenizerAllOps)->ThreadPerCpu();
 BENCHMARK(BM_BertPreTokenizerAllOpsString)->ThreadPerCpu();
+BENCHMARK(BM_ByteLevelSplitGPT2)->ThreadPerCpu();
+BENCHMARK(BM_ByteLevelSplitGPT2Regex)->ThreadPerCpu();
+BENCHMARK(BM_ByteLevelSplitLlama3)->ThreadPerCpu();
+BENCHMARK(BM_ByteLevelPreTokenizer)->ThreadPerCpu();
+BENCHMARK(BM_MetaspacePreTokenizer)->ThreadPerCpu();
+BENCHMARK(BM_PreTokenizerSequenceSteps)->ThreadPerCpu();
+BENCHMARK(BM_PreTokenizerSequenceFused)->ThreadPerCpu();
@@ -2,15 +2,28 @@
 #include "tokenizers/pre_tokenizer.h"
 
 #include <gtest/gtest.h>
+#include <unicode/regex.h>
 
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 using tokenizers::pre_tokenizers::BertPreTokenizer;
+using tokenizers::pre_tokenizers::ByteLevel;
+using tokenizers::pre_tokenizers::Digits;
+using tokenizers::pre_tokenizers::FusedSplit;
+using tokenizers::pre_tokenizers::fusePreTokenizers;
+using tokenizers::pre_tokenizers::Metaspace;
+using tokenizers::pre_tokenizers::PrependScheme;
 using tokenizers::pre_tokenizers::PreTokenizer;
 using tokenizers::pre_tokenizers::PreTokenizerResult;
+using tokenizers::pre_tokenizers::Punctuation;
+using tokenizers::pre_tokenizers::Sequence;
+using tokenizers::pre_tokenizers::Split;
 using tokenizers::pre_tokenizers::SplitDelimiterBehavior;
+using tokenizers::pre_tokenizers::WhitespaceSplit;
 
 void assertPreTokenizerValues(const PreTokenizerResult& got,
                               const PreTokenizerResult& expected) {
@@ -87,6 +100,22 @@ TEST(PreTokenizerTest, SplitMergedWithNext) {
   assertPreTokenizerValues(result, expected);
 }
 
+TEST(PreTokenizerTest, SplitContiguous) {
+  PreTokenizerResult input = PreTokenizerResult(
+      icu::UnicodeString::fromUTF8(u8"the-final--countdown"));
+  PreTokenizerResult result = tokenizers::pre_tokenizers::split(
+      input, [](UChar32 c) { return c == '-'; },
+      SplitDelimiterBehavior::kContiguous);
+  PreTokenizerResult expected =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"the"),
+                          icu::UnicodeString::fromUTF8(u8"-"),
+                          icu::UnicodeString::fromUTF8(u8"final"),
+                          icu::UnicodeString::fromUTF8(u8"--"),
+                          icu::UnicodeString::fromUTF8(u8"countdown")},
+                         {{0, 3}, {3, 4}, {4, 9}, {9, 11}, {11, 20}});
+  assertPreTokenizerValues(result, expected);
+}
+
 TEST(PreTokenizerTest, EmptyInput) {
   PreTokenizer pre_tokenizer;
   PreTokenizerResult input =
@@ -160,3 +189,276 @@ TEST(BertPreTokenizerTest, AllOptions) {
                           {33, 37}});
   assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
 }
+
+std::vector<std::pair<int, int>> findRegexMatches(
+    const std::string& pattern, const icu::UnicodeString& input) {
+  UErrorCode status = U_ZERO_ERROR;
+  icu::RegexMatcher matcher(icu::UnicodeString::fromUTF8(pattern), input, 0,
+                            status);
+  std::vector<std::pair<int, int>> matches;
+  while (matcher.find(status) && U_SUCCESS(status)) {
+    matches.emplace_back(matcher.start(status), matcher.end(status));
+  }
+  return matches;
+}
+
+const std::vector<std::string> kRegexSplitInputs = {
+    u8"Hello world's  test\n\n 123!! ok",
+    u8"I'M  DON'T  you'll\t\ttabs\r\n\r\nnext 'quoted' x'd",
+    u8"  leading and trailing  ",
+    u8"北京大学 café 1234567 ❤️ 😀!!\n",
+    u8"a\u00A0b \u2003c  ...  -- foo_bar(x)+=1;\n\tindented",
+    u8"",
+    u8" ",
+    u8"\n \n  x"};
+
+TEST(ByteLevelTest, SplitGPT2MatchesRegex) {
+  std::string pattern =
+      R"('s|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+)"
+      R"(|\s+(?!\S)|\s+)";
+  for (const std::string& input : kRegexSplitInputs) {
+    icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+    ASSERT_EQ(tokenizers::pre_tokenizers::splitGPT2(unicode_input),
+              findRegexMatches(pattern, unicode_input))
+        << input;
+  }
+}
+
+TEST(ByteLevelTest, SplitLlama3MatchesRegex) {
+  std::string pattern =
+      R"((?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,3})"
+      R"(| ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+)";
+  for (const std::string& input : kRegexSplitInputs) {
+    icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+    ASSERT_EQ(tokenizers::pre_tokenizers::splitLlama3(unicode_input),
+              findRegexMatches(pattern, unicode_input))
+        << input;
+  }
+}
+
+TEST(ByteLevelTest, AddPrefixSpace) {
+  ByteLevel pre_tokenizer(true, true);
+  PreTokenizerResult input = PreTokenizerResult(icu::UnicodeString::fromUTF8(
+      u8"Hello my friend, how is your day going?"));
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"ĠHello"),
+                          icu::UnicodeString::fromUTF8(u8"Ġmy"),
+                          icu::UnicodeString::fromUTF8(u8"Ġfriend"),
+                          icu::UnicodeString::fromUTF8(u8","),
+                          icu::UnicodeString::fromUTF8(u8"Ġhow"),
+                          icu::UnicodeString::fromUTF8(u8"Ġis"),
+                          icu::UnicodeString::fromUTF8(u8"Ġyour"),
+                          icu::UnicodeString::fromUTF8(u8"Ġday"),
+                          icu::UnicodeString::fromUTF8(u8"Ġgoing"),
+                          icu::UnicodeString::fromUTF8(u8"?")},
+                         {{0, 5},
+                          {5, 8},
+                          {8, 15},
+                          {15, 16},
+                          {16, 20},
+                          {20, 23},
+                          {23, 28},
+                          {28, 32},
+                          {32, 38},
+                          {38, 39}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(ByteLevelTest, NoRegexMultiByte) {
+  ByteLevel pre_tokenizer(false, false);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"é ok\n"));
+  PreTokenizerResult expected_result = PreTokenizerResult(
+      {icu::UnicodeString::fromUTF8(u8"Ã©ĠokĊ")}, {{0, 5}});
+  PreTokenizerResult got_result = pre_tokenizer.PreTokenize(input);
+  assertPreTokenizerValues(got_result, expected_result);
+  ASSERT_EQ(got_result.char_offsets[0].size(), 6);
+  ASSERT_EQ(got_result.char_offsets[0][1], std::make_pair(0, 1));
+}
+
+TEST(MetaspaceTest, PrependAlways) {
+  Metaspace pre_tokenizer;
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"Hey   friend!"));
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"▁Hey"),
+                          icu::UnicodeString::fromUTF8(u8"▁"),
+                          icu::UnicodeString::fromUTF8(u8"▁"),
+                          icu::UnicodeString::fromUTF8(u8"▁friend!")},
+                         {{0, 3}, {3, 4}, {4, 5}, {5, 13}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(MetaspaceTest, PrependFirst) {
+  Metaspace pre_tokenizer(u8"▁", PrependScheme::kFirst);
+  PreTokenizerResult input = PreTokenizerResult(
+      {icu::UnicodeString::fromUTF8(u8"Hey"),
+       icu::UnicodeString::fromUTF8(u8"friend")},
+      std::vector<std::vector<std::pair<int, int>>>{
+          {{0, 1}, {1, 2}, {2, 3}},
+          {{9, 10}, {10, 11}, {11, 12}, {12, 13}, {13, 14}, {14, 15}}});
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"▁Hey"),
+                          icu::UnicodeString::fromUTF8(u8"friend")},
+                         {{0, 3}, {9, 15}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(MetaspaceTest, NoSplit) {
+  Metaspace pre_tokenizer(u8"▁", PrependScheme::kNever, false);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"Hey friend!"));
+  PreTokenizerResult expected_result = PreTokenizerResult(
+      {icu::UnicodeString::fromUTF8(u8"Hey▁friend!")}, {{0, 11}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(WhitespaceSplitTest, PreTokenize) {
+  WhitespaceSplit pre_tokenizer;
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"Hey  friend!\n"));
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"Hey"),
+                          icu::UnicodeString::fromUTF8(u8"friend!")},
+                         {{0, 3}, {5, 12}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(PunctuationTest, Isolated) {
+  Punctuation pre_tokenizer;
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"Hey, friend!"));
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"Hey"),
+                          icu::UnicodeString::fromUTF8(u8","),
+                          icu::UnicodeString::fromUTF8(u8" friend"),
+                          icu::UnicodeString::fromUTF8(u8"!")},
+                         {{0, 3}, {3, 4}, {4, 11}, {11, 12}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(DigitsTest, Contiguous) {
+  Digits pre_tokenizer(false);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"Hey 123 friend"));
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"Hey "),
+                          icu::UnicodeString::fromUTF8(u8"123"),
+                          icu::UnicodeString::fromUTF8(u8" friend")},
+                         {{0, 4}, {4, 7}, {7, 14}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(DigitsTest, IndividualDigits) {
+  Digits pre_tokenizer(true);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"Hey 123 friend"));
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"Hey "),
+                          icu::UnicodeString::fromUTF8(u8"1"),
+                          icu::UnicodeString::fromUTF8(u8"2"),
+                          icu::UnicodeString::fromUTF8(u8"3"),
+                          icu::UnicodeString::fromUTF8(u8" friend")},
+                         {{0, 4}, {4, 5}, {5, 6}, {6, 7}, {7, 14}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected_result);
+}
+
+TEST(PreTokenizerSequenceTest, FusedMatchesSequential) {
+  for (bool individual_digits : {false, true}) {
+    std::vector<std::shared_ptr<PreTokenizer>> steps = {
+        std::make_shared<WhitespaceSplit>(), std::make_shared<Punctuation>(),
+        std::make_shared<Digits>(individual_digits)};
+    Sequence sequential(steps);
+    std::shared_ptr<PreTokenizer> fused = fusePreTokenizers(steps);
+    ASSERT_NE(std::dynamic_pointer_cast<FusedSplit>(fused), nullptr);
+    for (const std::string& input : kRegexSplitInputs) {
+      PreTokenizerResult pre_tokenized =
+          PreTokenizerResult(icu::UnicodeString::fromUTF8(input));
+      assertPreTokenizerValues(fused->PreTokenize(pre_tokenized),
+                               sequential.PreTokenize(pre_tokenized));
+    }
+  }
+}
+
+TEST(PreTokenizerSequenceTest, ContiguousStepsMatchSequential) {
+  std::vector<std::shared_ptr<PreTokenizer>> steps = {
+      std::make_shared<Punctuation>(SplitDelimiterBehavior::kContiguous),
+      std::make_shared<Digits>(false)};
+  Sequence sequential(steps);
+  std::shared_ptr<PreTokenizer> fused = fusePreTokenizers(steps);
+  for (const std::string& input : {u8"1!", u8"ab12!?3 c"}) {
+    PreTokenizerResult pre_tokenized =
+        PreTokenizerResult(icu::UnicodeString::fromUTF8(input));
+    assertPreTokenizerValues(fused->PreTokenize(pre_tokenized),
+                             sequential.PreTokenize(pre_tokenized));
+  }
+}
+
+TEST(PreTokenizerSequenceTest, UnsupportedStep) {
+  EXPECT_THROW(
+      fusePreTokenizers({std::make_shared<WhitespaceSplit>(), nullptr}),
+      std::invalid_argument);
+}
+
+TEST(PreTokenizerSequenceTest, KeepsOtherSteps) {
+  std::shared_ptr<PreTokenizer> fused =
+      fusePreTokenizers({std::make_shared<WhitespaceSplit>(),
+                         std::make_shared<Metaspace>(u8"▁"),
+                         std::make_shared<Digits>(true)});
+  ASSERT_NE(std::dynamic_pointer_cast<Sequence>(fused), nullptr);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"Hey 12"));
+  PreTokenizerResult expected_result =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"▁Hey"),
+                          icu::UnicodeString::fromUTF8(u8"▁"),
+                          icu::UnicodeString::fromUTF8(u8"1"),
+                          icu::UnicodeString::fromUTF8(u8"2")},
+                         {{0, 3}, {4, 4}, {4, 5}, {5, 6}});
+  assertPreTokenizerValues(fused->PreTokenize(input), expected_result);
+}
+
+TEST(SplitTest, GPT2Pattern) {
+  Split pre_tokenizer(
+      R"('s|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+)"
+      R"(|\s+(?!\S)|\s+)",
+      true, SplitDelimiterBehavior::kIsolated);
+  for (const std::string& input : kRegexSplitInputs) {
+    icu::UnicodeString unicode_input = icu::UnicodeString::fromUTF8(input);
+    PreTokenizerResult result =
+        pre_tokenizer.PreTokenize(PreTokenizerResult(unicode_input));
+    std::vector<std::pair<int, int>> ranges =
+        tokenizers::pre_tokenizers::splitGPT2(unicode_input);
+    ASSERT_EQ(result.pre_tokenized.size(), ranges.size()) << input;
+    for (int i = 0; i < ranges.size(); i++) {
+      ASSERT_EQ(result.pre_tokenized[i],
+                unicode_input.tempSubStringBetween(ranges[i].first,
+                                                   ranges[i].second));
+    }
+  }
+}
+
+TEST(SplitTest, StringMergedWithNext) {
+  Split pre_tokenizer("-", false, SplitDelimiterBehavior::kMergedWithNext);
+  PreTokenizerResult input = PreTokenizerResult(
+      icu::UnicodeString::fromUTF8(u8"the-final--countdown"));
+  PreTokenizerResult expected =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"the"),
+                          icu::UnicodeString::fromUTF8(u8"-final"),
+                          icu::UnicodeString::fromUTF8(u8"-"),
+                          icu::UnicodeString::fromUTF8(u8"-countdown")},
+                         {{0, 3}, {3, 9}, {9, 10}, {10, 20}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected);
+}
+
+TEST(SplitTest, RegexInvert) {
+  Split pre_tokenizer(R"(\w+)", true, SplitDelimiterBehavior::kIsolated,
+                      true);
+  PreTokenizerResult input =
+      PreTokenizerResult(icu::UnicodeString::fromUTF8(u8"añ  b"));
+  PreTokenizerResult expected =
+      PreTokenizerResult({icu::UnicodeString::fromUTF8(u8"añ"),
+                          icu::UnicodeString::fromUTF8(u8"  "),
+                          icu::UnicodeString::fromUTF8(u8"b")},
+                         {{0, 2}, {2, 4}, {4, 5}});
+  assertPreTokenizerValues(pre_tokenizer.PreTokenize(input), expected);
+}
@@ -0,0 +1,37 @@
+// Copyright 2025 Omkar Prabhu
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include "tokenizers/registry.h"
+#include "tokenizers/tokenizer.h"
+
+using tokenizers::Tokenizer;
+using tokenizers::TokenizerRegistry;
+
+static const char kBenchmarkConfigPath[] =
+    "../../scripts/tokenizers/bert-base-uncased.json";
+
+static void BM_TokenizerRegistryGet(benchmark::State& state) { // NOLINT
+  TokenizerRegistry registry;
+  registry.RegisterFile("bert", kBenchmarkConfigPath);
+  registry.Get("bert");
+  for (auto _ : state) {
+    std::shared_ptr<const Tokenizer> tokenizer = registry.Get("bert");
+    benchmark::DoNotOptimize(tokenizer);
+  }
+}
+
+static void BM_TokenizerMemoryUsage(benchmark::State& state) { // NOLINT
+  TokenizerRegistry registry;
+  registry.RegisterFile("bert", kBenchmarkConfigPath);
+  std::shared_ptr<const Tokenizer> tokenizer = registry.Get("bert");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tokenizer->MemoryUsage());
+  }
+  state.counters["bytes"] = tokenizer->MemoryUsage();
+}
+
+BENCHMARK(BM_TokenizerRegistryGet)->ThreadPerCpu();
+BENCHMARK(BM_TokenizerMemoryUsage);
@@ -0,0 +1,115 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/registry.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tokenizers/tokenizer.h"
+
+using tokenizers::Tokenizer;
+using tokenizers::TokenizerRegistry;
+using tokenizers::TokenizerRegistryEntry;
+
+static const char kConfigPath[] =
+    "../../scripts/tokenizers/bert-base-uncased.json";
+
+static std::string readConfig() {
+  std::ifstream file(kConfigPath);
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+TEST(TokenizerRegistryTest, DeduplicatesByContent) {
+  TokenizerRegistry registry;
+  int loads = 0;
+  std::string config = readConfig();
+  registry.Register("model-a", [&]() {
+    loads++;
+    return config;
+  });
+  registry.RegisterFile("model-b", kConfigPath);
+  ASSERT_EQ(loads, 0);
+  std::shared_ptr<const Tokenizer> a = registry.Get("model-a");
+  ASSERT_EQ(loads, 1);
+  std::shared_ptr<const Tokenizer> b = registry.Get("model-b");
+  ASSERT_EQ(a, b);
+  ASSERT_EQ(registry.Get("model-a"), a);
+  ASSERT_EQ(registry.Load(config), a);
+  ASSERT_EQ(loads, 1);
+  ASSERT_EQ(a->Encode("hello world").ids,
+            std::pmr::vector<int>({101, 7592, 2088, 102}));
+
+  std::vector<TokenizerRegistryEntry> entries = registry.Entries();
+  ASSERT_EQ(entries.size(), 1);
+  ASSERT_EQ(entries[0].names, std::vector<std::string>({"model-a", "model-b"}));
+  ASSERT_TRUE(entries[0].resident);
+  // sha256sum of the config file.
+  ASSERT_EQ(entries[0].digest,
+            "d241a60d5e8f04cc1b2b3e9ef7a4921b27bf526d9f6050ab90f9267a1f9e5c66");
+  ASSERT_EQ(entries[0].memory_usage, a->MemoryUsage());
+  ASSERT_EQ(registry.memory_usage(), a->MemoryUsage());
+  // bert-base-uncased holds a 30522 token vocab, and the reverse one only
+  // once it decodes.
+  ASSERT_GT(a->MemoryUsage(), 30522 * 32);
+
+  EXPECT_THROW(registry.Get("model-c"), std::out_of_range);
+}
+
+TEST(TokenizerRegistryTest, EvictsLeastRecentlyUsed) {
+  std::string config = readConfig();
+  size_t memory_usage = Tokenizer(config).MemoryUsage();
+  TokenizerRegistry registry(memory_usage * 2 + memory_usage / 2);
+  int loads = 0;
+  for (const std::string& name : {"a", "b", "c"}) {
+    // Trailing whitespace makes a distinct config for the same tokenizer.
+    registry.Register(name, [&, name]() {
+      loads++;
+      return config + std::string(name[0] - 'a', ' ');
+    });
+  }
+  registry.Get("a");
+  registry.Get("b");
+  registry.Get("a");
+  registry.Get("c");
+  ASSERT_EQ(loads, 3);
+  std::vector<TokenizerRegistryEntry> entries = registry.Entries();
+  ASSERT_EQ(entries.size(), 2);
+  ASSERT_EQ(entries[0].names, std::vector<std::string>({"c"}));
+  ASSERT_EQ(entries[1].names, std::vector<std::string>({"a"}));
+  ASSERT_LE(registry.memory_usage(), registry.memory_budget());
+
+  registry.Get("b");
+  ASSERT_EQ(loads, 4);
+
+  // An evicted tokenizer still in use is handed out again, not reloaded.
+  std::shared_ptr<const Tokenizer> c = registry.Get("c");
+  registry.Get("a");
+  registry.Get("b");
+  ASSERT_FALSE(registry.Entries().back().resident);
+  ASSERT_EQ(registry.Get("c"), c);
+  ASSERT_EQ(loads, 6);
+}
+
+TEST(TokenizerRegistryTest, ChargesDecodeTables) {
+  std::string config = readConfig();
+  TokenizerRegistry registry;
+  std::shared_ptr<const Tokenizer> a = registry.Load(config);
+  size_t loaded_usage = registry.memory_usage();
+  // The first decode builds the reverse vocab and the special tokens, which
+  // the next load charges.
+  ASSERT_EQ(a->BuiltTables(), 0);
+  a->Decode({7592, 2088});
+  ASSERT_EQ(a->BuiltTables(), 2);
+  ASSERT_GT(a->MemoryUsage(), loaded_usage);
+  std::shared_ptr<const Tokenizer> b = registry.Load(config + " ");
+  ASSERT_EQ(registry.memory_usage(), a->MemoryUsage() + b->MemoryUsage());
+  ASSERT_EQ(registry.Entries().back().memory_usage, a->MemoryUsage());
+}
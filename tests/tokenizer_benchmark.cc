@@ -2,8 +2,10 @@
 #include <benchmark/benchmark.h>
 #include <unicode/unistr.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -19,8 +21,17 @@
 #include "tokenizers/tokenizer.h"
 #include "tokenizers/utils.h"
 
+using tokenizers::CompactEncoding;
+using tokenizers::DecodedBatch;
+using tokenizers::EncodedBatch;
+using tokenizers::EncodeOptions;
 using tokenizers::Encoding;
+using tokenizers::OffsetType;
 using tokenizers::Tokenizer;
+using tokenizers::Truncation;
+using tokenizers::TruncationDirection;
+using tokenizers::TruncationStrategy;
+using tokenizers::WorkStealingExecutor;
 using tokenizers::models::WordPiece;
 using tokenizers::normalizers::BertNormalizer;
 using tokenizers::post_processors::TemplateProcessing;
@@ -290,6 +301,240 @@ static void BM_TokenizerEncodePairFromConfigNoSpecialTokens(
   }
 }
 
+static void BM_TokenizerEncodeSingleFromConfigMemoryResource(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with "
+      u8"unaffordable costs in "
+      u8"São Paulo, 北京大学, and Python是一种编程语言.";
+  for (auto _ : state) {
+    std::pmr::monotonic_buffer_resource resource;
+    Encoding output =
+        tokenizer.Encode(input, true, EncodeOptions::kAll, &resource);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_TokenizerEncodeSingleFromConfigIdsOnly(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with "
+      u8"unaffordable costs in "
+      u8"São Paulo, 北京大学, and Python是一种编程语言.";
+  for (auto _ : state) {
+    Encoding output = tokenizer.Encode(input, true, EncodeOptions::kIdsOnly);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+// Arg is the OffsetType, UTF-8 and code point offsets come out of the same
+// pass as the default UTF-16 ones.
+static void BM_TokenizerEncodeSingleFromConfigOffsetType(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  tokenizer.offset_type = static_cast<OffsetType>(state.range(0));
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with "
+      u8"unaffordable costs in "
+      u8"São Paulo, 北京大学, and Python是一种编程语言.";
+  for (auto _ : state) {
+    Encoding output = tokenizer.Encode(input, true);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_TokenizerCompactEncodingFromConfig(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with "
+      u8"unaffordable costs in "
+      u8"São Paulo, 北京大学, and Python是一种编程语言.";
+  Encoding encoding = tokenizer.Encode(input);
+  for (auto _ : state) {
+    CompactEncoding output(encoding);
+    benchmark::DoNotOptimize(output);
+  }
+  CompactEncoding compact(encoding);
+  state.counters["bytes_per_token"] =
+      static_cast<double>(encoding.MemoryUsage()) / encoding.ids.size();
+  state.counters["compact_bytes_per_token"] =
+      static_cast<double>(compact.MemoryUsage()) / encoding.ids.size();
+}
+
+static void BM_TokenizerEncodeTruncatedFromConfig(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  tokenizer.truncation = std::make_shared<Truncation>(
+      TruncationDirection::kRight, TruncationStrategy::kLongestFirst, 512, 0);
+  std::string input;
+  while (input.size() < (1 << 20)) {
+    input += u8"Hello world! I'm learning BERT-based NLP with "
+             u8"unaffordable costs in Sao Paulo.\n";
+  }
+  // kOverflowing needs the whole input encoded.
+  EncodeOptions options = state.range(0) == 1 ? EncodeOptions::kAll
+                                              : EncodeOptions::kAllFields;
+  for (auto _ : state) {
+    Encoding output = tokenizer.Encode(input, true, options);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+static void BM_TokenizerEncodeSingleFromConfigStats(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  tokenizer.EnableStats();
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with "
+      u8"unaffordable costs in "
+      u8"São Paulo, 北京大学, and Python是一种编程语言.";
+  for (auto _ : state) {
+    Encoding output = tokenizer.Encode(input);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
+// 64 documents of ~256 bytes, the first is `skew` times as long.
+static void BM_TokenizerEncodeBatchFromConfig(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  WorkStealingExecutor executor(state.range(0));
+  std::string sentence =
+      u8"Hello world! I'm learning BERT-based NLP with unaffordable costs. ";
+  std::vector<std::string> inputs(64);
+  int64_t bytes = 0;
+  for (int i = 0; i < inputs.size(); i++) {
+    int repeats = (i == 0 ? state.range(1) : 1) * 4;
+    for (int j = 0; j < repeats; j++) {
+      inputs[i] += sentence;
+    }
+    bytes += inputs[i].size();
+  }
+  for (auto _ : state) {
+    std::vector<Encoding> output =
+        tokenizer.EncodeBatch(inputs, true, EncodeOptions::kAll, &executor);
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+// Arg 0 counts the ids of the Encoding, Arg 1 calls CountTokens.
+static void BM_TokenizerCountTokensFromConfig(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with "
+      u8"unaffordable costs in "
+      u8"São Paulo, 北京大学, and Python是一种编程语言.";
+  for (auto _ : state) {
+    size_t count = state.range(0) == 0 ? tokenizer.Encode(input).ids.size()
+                                       : tokenizer.CountTokens(input);
+    benchmark::DoNotOptimize(count);
+  }
+}
+
+static void BM_TokenizerEncodeLongFromConfig(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  WorkStealingExecutor executor(state.range(0));
+  std::string input;
+  while (input.size() < (1 << 20)) {
+    input += u8"Hello world! I'm learning BERT-based NLP with "
+             u8"unaffordable costs in Sao Paulo.\n";
+  }
+  for (auto _ : state) {
+    Encoding output =
+        tokenizer.Encode(input, true, EncodeOptions::kAll,
+                         std::pmr::get_default_resource(),
+                         state.range(0) > 1 ? &executor : nullptr);
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+// Reports the share of padding tokens against padding the whole batch to
+// its longest encoding.
+static void BM_TokenizerEncodeBucketedFromConfig(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string sentence = u8"Hello world! I'm learning BERT-based NLP. ";
+  std::vector<std::string> inputs(64);
+  for (int i = 0; i < inputs.size(); i++) {
+    for (int j = 0; j <= (i * 37) % 50; j++) {
+      inputs[i] += sentence;
+    }
+  }
+  std::vector<EncodedBatch> batches;
+  for (auto _ : state) {
+    batches = tokenizer.EncodeBucketed(inputs, 16, 0.1);
+    benchmark::DoNotOptimize(batches);
+  }
+  int64_t tokens = 0;
+  int64_t padded_tokens = 0;
+  int64_t longest = 0;
+  for (const EncodedBatch& batch : batches) {
+    for (const Encoding& encoding : batch.encodings) {
+      tokens += std::count(encoding.attention_mask.begin(),
+                           encoding.attention_mask.end(), 1);
+      padded_tokens += encoding.ids.size();
+      longest = std::max<int64_t>(longest, encoding.ids.size());
+    }
+  }
+  state.counters["padding_ratio"] = 1.0 - double(tokens) / padded_tokens;
+  state.counters["batch_longest_padding_ratio"] =
+      1.0 - double(tokens) / (longest * inputs.size());
+}
+
+// Decodes 256 sequences, as a beam search step would.
+static void BM_TokenizerDecodeBatchFromConfig(
+    benchmark::State& state) { // NOLINT
+  std::string config = read_json_for_benchmark(
+      "../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  WorkStealingExecutor executor(state.range(0));
+  std::vector<int> sequence = {
+      101,   7592, 2088, 999,  1045, 1005, 1049,  4083, 14324, 1011,
+      2241,  17953, 2361, 2007, 14477, 4246, 8551,  3085, 5366,  1999,
+      7509,  9094, 1010, 1781, 1755,  1810, 1817,  1010, 1998,  18750,
+      100,   1740, 100,  100,  100,   100,  100,   1012, 102};
+  std::vector<std::vector<int>> ids(256, sequence);
+  for (auto _ : state) {
+    if (state.range(1) == 0) {
+      DecodedBatch output = tokenizer.DecodeBatch(ids, true, &executor);
+      benchmark::DoNotOptimize(output);
+    } else {
+      std::vector<std::string> output;
+      for (const std::vector<int>& sequence_ids : ids) {
+        output.emplace_back(tokenizer.Decode(sequence_ids, true));
+      }
+      benchmark::DoNotOptimize(output);
+    }
+  }
+}
+
 static void BM_TokenizerDecodeSingleFromConfigSkipSpecialTokens(
     benchmark::State& state) { // NOLINT
   std::string config = read_json_for_benchmark(
@@ -364,6 +609,29 @@ BENCHMARK(BM_TokenizerEncodeSingleFromConfigAddSpecialTokens)->ThreadPerCpu();
 BENCHMARK(BM_TokenizerEncodePairFromConfigAddSpecialTokens)->ThreadPerCpu();
 BENCHMARK(BM_TokenizerEncodeSingleFromConfigNoSpecialTokens)->ThreadPerCpu();
 BENCHMARK(BM_TokenizerEncodePairFromConfigNoSpecialTokens)->ThreadPerCpu();
+BENCHMARK(BM_TokenizerEncodeSingleFromConfigMemoryResource)->ThreadPerCpu();
+BENCHMARK(BM_TokenizerEncodeSingleFromConfigIdsOnly)->ThreadPerCpu();
+BENCHMARK(BM_TokenizerEncodeSingleFromConfigOffsetType)->Arg(0)->Arg(1)->Arg(2);
+BENCHMARK(BM_TokenizerEncodeSingleFromConfigStats)->ThreadPerCpu();
+BENCHMARK(BM_TokenizerCompactEncodingFromConfig)->ThreadPerCpu();
+BENCHMARK(BM_TokenizerEncodeTruncatedFromConfig)->Arg(0)->Arg(1);
+BENCHMARK(BM_TokenizerEncodeBatchFromConfig)
+    ->ArgNames({"threads", "skew"})
+    ->ArgsProduct({{1, 2, 4, 8}, {1, 64, 1024}})
+    ->UseRealTime();
+BENCHMARK(BM_TokenizerCountTokensFromConfig)->Arg(0)->Arg(1);
+BENCHMARK(BM_TokenizerEncodeLongFromConfig)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+BENCHMARK(BM_TokenizerEncodeBucketedFromConfig);
+BENCHMARK(BM_TokenizerDecodeBatchFromConfig)
+    ->ArgNames({"threads", "serial"})
+    ->ArgsProduct({{1, 4}, {0, 1}})
+    ->UseRealTime();
 BENCHMARK(BM_TokenizerDecodeSingleFromConfigSkipSpecialTokens)->ThreadPerCpu();
 BENCHMARK(BM_TokenizerDecodePairFromConfigSkipSpecialTokens)->ThreadPerCpu();
 BENCHMARK(BM_TokenizerDecodeSingleFromConfigIncludeSpecialTokens)
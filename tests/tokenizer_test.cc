@@ -3,9 +3,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <memory_resource>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -17,11 +20,25 @@
 #include "tokenizers/normalizer.h"
 #include "tokenizers/post_processor.h"
 #include "tokenizers/pre_tokenizer.h"
+#include "tokenizers/stats.h"
 #include "tokenizers/utils.h"
 
+using tokenizers::DecodedBatch;
+using tokenizers::EncodedBatch;
+using tokenizers::EncodeOptions;
 using tokenizers::Encoding;
+using tokenizers::MemoryUsageMap;
+using tokenizers::OffsetType;
+using tokenizers::Stage;
 using tokenizers::Tokenizer;
+using tokenizers::TokenizerStats;
+using tokenizers::Truncation;
+using tokenizers::TruncationDirection;
+using tokenizers::TruncationStrategy;
+using tokenizers::WorkStealingExecutor;
 using tokenizers::decoders::WordPieceDecoder;
+using tokenizers::models::BPE;
+using tokenizers::models::Unigram;
 using tokenizers::models::WordPiece;
 using tokenizers::normalizers::BertNormalizer;
 using tokenizers::post_processors::TemplateProcessing;
@@ -110,7 +127,7 @@ TEST(TokenizerTest, EncodeSingle) {
        {41, 45}, {46, 48},  {48, 58},   {59, 64},   {65, 67},   {68, 71},
        {72, 77}, {77, 78},  {79, 80},   {80, 81},   {81, 82},   {82, 83},
        {83, 84}, {85, 88},  {89, 95},   {95, 96},   {96, 97},   {97, 98},
-       {98, 99}, {99, 100}, {100, 101}, {101, 102}, {103, 104}, {104, 105},
+       {98, 99}, {99, 100}, {100, 101}, {101, 102}, {103, 104}, {105, 106},
        {0, 0}},
       {std::nullopt, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,           10, 11,
        12,           12, 13, 14, 15, 16, 17, 18, 19, 20, 21,          22, 23,
@@ -174,7 +191,7 @@ TEST(TokenizerTest, EncodePair) {
        {0, 2},   {3, 7},   {8, 10},  {10, 20}, {21, 26}, {27, 29}, {30, 33},
        {34, 39}, {39, 40}, {41, 42}, {42, 43}, {43, 44}, {44, 45}, {45, 46},
        {47, 50}, {51, 57}, {57, 58}, {58, 59}, {59, 60}, {60, 61}, {61, 62},
-       {62, 63}, {63, 64}, {65, 66}, {66, 67}, {0, 0}},
+       {62, 63}, {63, 64}, {65, 66}, {67, 68}, {0, 0}},
       {std::nullopt, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11,
        std::nullopt, 0,  1,  2,  2,  3,  4,  5,  6,  7,  8,  9,  10,
        11,           12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
@@ -308,6 +325,186 @@ TEST(TokenizerTest, InitFromConfig) {
   ASSERT_TRUE(decoder != nullptr);
 }
 
+TEST(TokenizerTest, InitBPEFromConfig) {
+  std::string config = R"({
+    "version": "1.0",
+    "added_tokens": [],
+    "normalizer": null,
+    "pre_tokenizer": null,
+    "post_processor": null,
+    "decoder": null,
+    "model": {
+      "type": "BPE",
+      "unk_token": "<unk>",
+      "vocab": {"<unk>": 0, "l": 1, "o": 2, "w": 3, "lo": 4, "low": 5},
+      "merges": ["l o", ["lo", "w"]]
+    }
+  })";
+  Tokenizer tokenizer(config);
+  auto model = std::dynamic_pointer_cast<BPE>(tokenizer.model);
+  ASSERT_TRUE(model != nullptr);
+  Encoding got_encoding = tokenizer.Encode(u8"low", false);
+  ASSERT_EQ(got_encoding.ids.size(), 1);
+  ASSERT_EQ(got_encoding.ids[0], 5);
+  ASSERT_EQ(got_encoding.tokens[0], "low");
+}
+
+TEST(TokenizerTest, EncodeBPEFromConfigAddedTokens) {
+  std::string config = R"({
+    "version": "1.0",
+    "added_tokens": [
+      {"id": 6, "content": "<|endoftext|>", "single_word": false,
+       "lstrip": false, "rstrip": false, "normalized": false, "special": true}
+    ],
+    "normalizer": null,
+    "pre_tokenizer": null,
+    "post_processor": null,
+    "decoder": null,
+    "model": {
+      "type": "BPE",
+      "unk_token": "<unk>",
+      "vocab": {"<unk>": 0, "l": 1, "o": 2, "w": 3, "lo": 4, "low": 5},
+      "merges": ["l o", ["lo", "w"]]
+    }
+  })";
+  Tokenizer tokenizer(config);
+  std::string input = u8"low<|endoftext|>lo";
+  Encoding got_encoding = tokenizer.Encode(input, false);
+  std::vector<int> got_ids(got_encoding.ids.begin(), got_encoding.ids.end());
+  ASSERT_EQ(got_ids, std::vector<int>({5, 6, 4}));
+  ASSERT_EQ(got_encoding.tokens[1], u8"<|endoftext|>");
+  ASSERT_EQ(got_encoding.offsets[1], std::make_pair(3, 16));
+  ASSERT_EQ(got_encoding.word_ids[2], 2);
+  ASSERT_EQ(tokenizer.CountTokens(input, false), 3);
+  ASSERT_EQ(tokenizer.Decode(got_ids, false), input);
+  ASSERT_EQ(tokenizer.Decode(got_ids, true), u8"lowlo");
+}
+
+TEST(TokenizerTest, EncodeByteLevelBPEFromConfig) {
+  std::string config = R"({
+    "version": "1.0",
+    "added_tokens": [],
+    "normalizer": null,
+    "pre_tokenizer": {
+      "type": "ByteLevel", "add_prefix_space": true, "use_regex": true
+    },
+    "post_processor": null,
+    "decoder": {"type": "ByteLevel"},
+    "model": {
+      "type": "BPE",
+      "unk_token": null,
+      "vocab": {"Ġ": 0, "l": 1, "o": 2, "w": 3, "Ã": 4, "©": 5, "Ġl": 6,
+                "Ġlo": 7, "Ġlow": 8, "Ã©": 9},
+      "merges": ["Ġ l", "Ġl o", "Ġlo w", "Ã ©"]
+    }
+  })";
+  Tokenizer tokenizer(config);
+  std::string input = u8"low lo é";
+  Encoding got_encoding = tokenizer.Encode(input, false);
+  std::vector<int> got_ids(got_encoding.ids.begin(), got_encoding.ids.end());
+  ASSERT_EQ(got_ids, std::vector<int>({8, 7, 0, 9}));
+  ASSERT_EQ(got_encoding.tokens[3], u8"Ã©");
+  ASSERT_EQ(got_encoding.offsets[0], std::make_pair(0, 3));
+  ASSERT_EQ(got_encoding.offsets[1], std::make_pair(3, 6));
+  ASSERT_EQ(got_encoding.offsets[3], std::make_pair(7, 8));
+  ASSERT_EQ(tokenizer.Decode(got_ids), u8" low lo é");
+}
+
+TEST(TokenizerTest, InitUnigramFromConfig) {
+  std::string config = R"({
+    "version": "1.0",
+    "added_tokens": [],
+    "normalizer": null,
+    "pre_tokenizer": null,
+    "post_processor": null,
+    "decoder": null,
+    "model": {
+      "type": "Unigram",
+      "unk_id": 0,
+      "vocab": [["<unk>", 0.0], ["lo", -1.0], ["w", -1.5], ["low", -4.0]],
+      "byte_fallback": false
+    }
+  })";
+  Tokenizer tokenizer(config);
+  auto model = std::dynamic_pointer_cast<Unigram>(tokenizer.model);
+  ASSERT_TRUE(model != nullptr);
+  Encoding got_encoding = tokenizer.Encode(u8"low", false);
+  ASSERT_EQ(got_encoding.ids.size(), 2);
+  ASSERT_EQ(got_encoding.ids[0], 1);
+  ASSERT_EQ(got_encoding.ids[1], 2);
+}
+
+TEST(TokenizerTest, InitMetaspaceFromConfig) {
+  std::string config = R"({
+    "version": "1.0",
+    "added_tokens": [],
+    "normalizer": null,
+    "pre_tokenizer": {
+      "type": "Metaspace", "replacement": "▁", "prepend_scheme": "always"
+    },
+    "post_processor": null,
+    "decoder": {
+      "type": "Metaspace", "replacement": "▁", "prepend_scheme": "always"
+    },
+    "model": {
+      "type": "Unigram",
+      "unk_id": 0,
+      "vocab": [["<unk>", 0.0], ["▁hello", -1.0], ["▁wor", -2.0],
+                ["ld", -2.0]]
+    }
+  })";
+  Tokenizer tokenizer(config);
+  Encoding got_encoding = tokenizer.Encode(u8"hello world", false);
+  ASSERT_EQ(got_encoding.ids.size(), 3);
+  ASSERT_EQ(got_encoding.ids[0], 1);
+  ASSERT_EQ(got_encoding.ids[1], 2);
+  ASSERT_EQ(got_encoding.ids[2], 3);
+  ASSERT_EQ(got_encoding.offsets[1], std::make_pair(5, 9));
+  ASSERT_EQ(tokenizer.Decode({1, 2, 3}), "hello world");
+}
+
+TEST(TokenizerTest, InitSequenceFromConfig) {
+  std::string config = R"({
+    "version": "1.0",
+    "added_tokens": [],
+    "normalizer": {
+      "type": "Sequence",
+      "normalizers": [
+        {"type": "NFKC"},
+        {"type": "Prepend", "prepend": "▁"},
+        {"type": "Replace", "pattern": {"String": " "}, "content": "▁"}
+      ]
+    },
+    "pre_tokenizer": {
+      "type": "Sequence",
+      "pretokenizers": [
+        {"type": "Split", "pattern": {"String": "▁"},
+         "behavior": "MergedWithNext", "invert": false},
+        {"type": "Digits", "individual_digits": true}
+      ]
+    },
+    "post_processor": null,
+    "decoder": {
+      "type": "Metaspace", "replacement": "▁", "prepend_scheme": "always"
+    },
+    "model": {
+      "type": "Unigram",
+      "unk_id": 0,
+      "vocab": [["<unk>", 0.0], ["▁hello", -1.0], ["▁wor", -2.0],
+                ["ld", -2.0], ["▁", -3.0], ["1", -3.0], ["2", -3.0]]
+    }
+  })";
+  Tokenizer tokenizer(config);
+  Encoding got_encoding = tokenizer.Encode(u8"hello world 12", false);
+  ASSERT_EQ(got_encoding.ids.size(), 6);
+  for (int i = 0; i < 6; i++) {
+    ASSERT_EQ(got_encoding.ids[i], i + 1);
+  }
+  ASSERT_EQ(got_encoding.offsets[1], std::make_pair(5, 9));
+  ASSERT_EQ(got_encoding.offsets[5], std::make_pair(13, 14));
+  ASSERT_EQ(tokenizer.Decode({1, 2, 3, 4, 5, 6}), "hello world 12");
+}
+
 TEST(TokenizerTest, EncodeSingleFromConfigAddSpecialTokens) {
   std::string config =
       read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
@@ -498,6 +695,240 @@ TEST(TokenizerTest, EncodePairFromConfigNoSpecialTokens) {
   assertTokenizerValues(got_encoding, expected_encoding);
 }
 
+TEST(TokenizerTest, EncodeSingleFromConfigMemoryResource) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with unaffordable costs in "
+      u8"São Paulo, 北京大学, and Python是一种编程语言.";
+  Encoding expected_encoding = tokenizer.Encode(input, true);
+  std::pmr::monotonic_buffer_resource resource;
+  Encoding got_encoding =
+      tokenizer.Encode(input, true, EncodeOptions::kAll, &resource);
+  ASSERT_EQ(got_encoding.ids.get_allocator().resource(), &resource);
+  ASSERT_EQ(got_encoding.tokens.get_allocator().resource(), &resource);
+  ASSERT_EQ(got_encoding.tokens[0].get_allocator().resource(), &resource);
+  ASSERT_EQ(got_encoding.offsets.get_allocator().resource(), &resource);
+  assertTokenizerValues(got_encoding, expected_encoding);
+}
+
+TEST(TokenizerTest, EncodeTruncatedFromConfigMemoryResource) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  tokenizer.truncation = std::make_shared<Truncation>(
+      TruncationDirection::kRight, TruncationStrategy::kLongestFirst, 16, 1);
+  std::pair<std::string, std::string> input(
+      u8"Hello world! I'm learning BERT-based NLP.",
+      u8"We have unaffordable costs in São Paulo.");
+  EncodeOptions options = EncodeOptions::kAll;
+  Encoding expected_encoding = tokenizer.Encode(input, true, options);
+  std::pmr::monotonic_buffer_resource resource;
+  // Any allocation from the default resource fails while encoding.
+  struct NullDefaultResource {
+    NullDefaultResource() {
+      previous =
+          std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    }
+    ~NullDefaultResource() { std::pmr::set_default_resource(previous); }
+    std::pmr::memory_resource* previous;
+  };
+  std::optional<NullDefaultResource> null_default_resource(std::in_place);
+  Encoding got_encoding = tokenizer.Encode(input, true, options, &resource);
+  null_default_resource.reset();
+  ASSERT_FALSE(got_encoding.overflowing.empty());
+  ASSERT_EQ(got_encoding.overflowing.get_allocator().resource(), &resource);
+  for (const Encoding& overflowing : got_encoding.overflowing) {
+    ASSERT_EQ(overflowing.resource(), &resource);
+    ASSERT_EQ(overflowing.offsets.get_allocator().resource(), &resource);
+  }
+  assertTokenizerValues(got_encoding, expected_encoding);
+}
+
+TEST(TokenizerTest, EncodeSingleFromConfigIdsOnly) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input =
+      u8"Hello world! I'm learning BERT-based NLP with unaffordable costs in "
+      u8"S\u00E3o Paulo, \u5317\u4EAC\u5927\u5B66, and Python.";
+  Encoding expected_encoding = tokenizer.Encode(input, true);
+  Encoding got_encoding =
+      tokenizer.Encode(input, true, EncodeOptions::kIdsOnly);
+  ASSERT_EQ(got_encoding.ids, expected_encoding.ids);
+  ASSERT_EQ(got_encoding.type_ids, expected_encoding.type_ids);
+  ASSERT_EQ(got_encoding.attention_mask, expected_encoding.attention_mask);
+  ASSERT_TRUE(got_encoding.tokens.empty());
+  ASSERT_TRUE(got_encoding.offsets.empty());
+  ASSERT_TRUE(got_encoding.word_ids.empty());
+  ASSERT_TRUE(got_encoding.special_tokens_mask.empty());
+}
+
+TEST(TokenizerTest, EncodeMetaspaceFromConfigIdsOnly) {
+  std::string metaspace =
+      R"({"type": "Metaspace", "replacement": "▁", "prepend_scheme": "first"})";
+  for (const std::string& pre_tokenizer :
+       {metaspace, R"({"type": "Sequence", "pretokenizers": [
+                        {"type": "Punctuation", "behavior": "Isolated"}, )" +
+                       metaspace + "]}"}) {
+    std::string config = R"({
+      "version": "1.0",
+      "added_tokens": [
+        {"id": 5, "content": "<s>", "single_word": false, "lstrip": false,
+         "rstrip": false, "normalized": false, "special": true}
+      ],
+      "normalizer": null,
+      "pre_tokenizer": )" + pre_tokenizer + R"(,
+      "post_processor": null,
+      "decoder": null,
+      "model": {
+        "type": "Unigram",
+        "unk_id": 0,
+        "vocab": [["<unk>", 0.0], ["▁a", -1.0], ["a", -1.0], ["▁b", -1.0],
+                  ["b", -1.0], ["<s>", 0.0], ["!", -1.0], ["▁!", -1.0]]
+      }
+    })";
+    Tokenizer tokenizer(config);
+    for (const std::string& input :
+         {u8"a<s>b", u8"<s>a b", u8"a b<s> b", u8"!a<s>b!"}) {
+      Encoding expected_encoding = tokenizer.Encode(input, false);
+      Encoding got_encoding =
+          tokenizer.Encode(input, false, EncodeOptions::kIdsOnly);
+      ASSERT_EQ(got_encoding.ids, expected_encoding.ids) << input;
+      ASSERT_EQ(tokenizer.CountTokens(input, false),
+                expected_encoding.ids.size())
+          << input;
+    }
+  }
+}
+
+TEST(TokenizerTest, EncodeBatchFromConfig) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string long_input;
+  while (long_input.size() < 5 * Tokenizer::kBatchChunkLength) {
+    long_input += u8"Hello world! I'm learning BERT-based NLP with "
+                  u8"unaffordable costs in S\u00E3o Paulo.\n";
+  }
+  std::vector<std::string> inputs = {u8"Hello world!", long_input, u8"",
+                                     u8"\u5317\u4EAC\u5927\u5B66"};
+  WorkStealingExecutor executor(3);
+  std::vector<Encoding> got_encodings =
+      tokenizer.EncodeBatch(inputs, true, EncodeOptions::kAll, &executor);
+  ASSERT_EQ(got_encodings.size(), inputs.size());
+  for (int i = 0; i < inputs.size(); i++) {
+    assertTokenizerValues(got_encodings[i], tokenizer.Encode(inputs[i]));
+  }
+}
+
+TEST(TokenizerTest, EncodeParallelFromConfig) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string long_input;
+  for (int i = 0; long_input.size() < 5 * Tokenizer::kBatchChunkLength; i++) {
+    long_input += u8"Hello [MASK] world! I'm learning BERT-based NLP in "
+                  u8"S\u00E3o Paulo \u5317\u4EAC " +
+                  std::to_string(i) + u8".\n";
+  }
+  WorkStealingExecutor executor(4);
+  for (OffsetType offset_type : {OffsetType::kUtf16, OffsetType::kUtf8}) {
+    tokenizer.offset_type = offset_type;
+    assertTokenizerValues(tokenizer.Encode(long_input, true,
+                                           EncodeOptions::kAll,
+                                           std::pmr::get_default_resource(),
+                                           &executor),
+                          tokenizer.Encode(long_input));
+  }
+}
+
+TEST(TokenizerTest, CountTokensFromConfig) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string long_input;
+  while (long_input.size() < 2 * Tokenizer::kBatchChunkLength) {
+    long_input += u8"Hello [MASK] world! I'm learning BERT-based NLP in "
+                  u8"S\u00E3o Paulo \u5317\u4EAC \U0001F600.\n";
+  }
+  for (const std::string& input :
+       {std::string(), std::string(u8"[CLS]"), std::string(u8"Hello world!"),
+        long_input}) {
+    for (bool add_special_tokens : {true, false}) {
+      ASSERT_EQ(tokenizer.CountTokens(input, add_special_tokens),
+                tokenizer.Encode(input, add_special_tokens).ids.size());
+    }
+  }
+}
+
+TEST(TokenizerTest, EncodeBucketedFromConfig) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::vector<std::string> inputs = {
+      u8"Hello world!", u8"I'm learning BERT-based NLP with unaffordable costs",
+      u8"Hello moon!", u8"I'm learning BERT-based NLP with affordable costs",
+      u8"Hi"};
+  std::vector<EncodedBatch> batches = tokenizer.EncodeBucketed(inputs, 2, 0.2);
+  std::vector<std::vector<int>> expected_indices = {{4, 0}, {2}, {3, 1}};
+  ASSERT_EQ(batches.size(), expected_indices.size());
+  for (int i = 0; i < batches.size(); i++) {
+    ASSERT_EQ(batches[i].indices, expected_indices[i]);
+    int longest = 0;
+    for (int index : batches[i].indices) {
+      longest = std::max<int>(longest,
+                              tokenizer.Encode(inputs[index]).ids.size());
+    }
+    for (int j = 0; j < batches[i].indices.size(); j++) {
+      const Encoding& got = batches[i].encodings[j];
+      Encoding expected = tokenizer.Encode(inputs[batches[i].indices[j]]);
+      ASSERT_EQ(got.ids.size(), longest);
+      ASSERT_EQ(std::vector<int>(got.ids.begin(),
+                                 got.ids.begin() + expected.ids.size()),
+                std::vector<int>(expected.ids.begin(), expected.ids.end()));
+      ASSERT_EQ(std::count(got.attention_mask.begin(),
+                           got.attention_mask.end(), 1),
+                expected.ids.size());
+    }
+  }
+}
+
+TEST(TokenizerTest, Stats) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input = u8"Hello world! Python是一种.";
+  tokenizer.Encode(input);
+  ASSERT_EQ(tokenizer.Stats().encode_calls, 0);
+
+  tokenizer.EnableStats();
+  Encoding encoding = tokenizer.Encode(input);
+  encoding = tokenizer.Encode(input);
+  TokenizerStats stats = tokenizer.Stats();
+  if (!tokenizers::kStatsCompiled) {
+    ASSERT_EQ(stats.encode_calls, 0);
+    return;
+  }
+  ASSERT_EQ(stats.encode_calls, 2);
+  ASSERT_EQ(stats.bytes_in, 2 * input.size());
+  ASSERT_EQ(stats.tokens_out, 2 * encoding.ids.size());
+  ASSERT_EQ(stats.unk_tokens, 2 * std::count(encoding.tokens.begin(),
+                                              encoding.tokens.end(), "[UNK]"));
+  ASSERT_GT(stats.unk_tokens, 0);
+  ASSERT_EQ(stats.stage(Stage::kNormalizer).calls, 2);
+  ASSERT_GT(stats.stage(Stage::kNormalizer).nanoseconds, 0);
+  ASSERT_EQ(stats.stage(Stage::kModel).tokens_out,
+            2 * (encoding.ids.size() - 2));
+  ASSERT_EQ(stats.stage(Stage::kPostProcessor).tokens_out,
+            2 * encoding.ids.size());
+  ASSERT_EQ(stats.stage(Stage::kPadding).calls, 0);
+
+  tokenizer.ResetStats();
+  ASSERT_EQ(tokenizer.Stats().encode_calls, 0);
+}
+
 TEST(TokenizerTest, DecodeSingleFromConfigSkipSpecialTokens) {
   std::string config =
       read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
@@ -563,3 +994,153 @@ TEST(TokenizerTest, DecodePairFromConfigIncludeSpecialTokens) {
       false);
   ASSERT_EQ(got_result, expected_result);
 }
+
+TEST(TokenizerTest, DecodeBatchFromConfig) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::vector<std::vector<int>> ids;
+  for (const std::string& input :
+       {std::string(u8"Hello world! I'm learning BERT-based NLP."),
+        std::string(), std::string(u8"We don't have S\u00E3o Paulo [MASK]."),
+        std::string(u8"\u5317\u4EAC\u5927\u5B66, and Python")}) {
+    Encoding encoding = tokenizer.Encode(input);
+    ids.emplace_back(encoding.ids.begin(), encoding.ids.end());
+  }
+  ids.emplace_back();
+  WorkStealingExecutor executor(3);
+  for (bool skip_special_tokens : {true, false}) {
+    DecodedBatch got_batch =
+        tokenizer.DecodeBatch(ids, skip_special_tokens, &executor);
+    std::vector<std::string> got_strings =
+        tokenizer.DecodeBatchStrings(ids, skip_special_tokens, &executor);
+    ASSERT_EQ(got_batch.size(), ids.size());
+    ASSERT_EQ(got_strings.size(), ids.size());
+    for (int i = 0; i < ids.size(); i++) {
+      std::string expected = tokenizer.Decode(ids[i], skip_special_tokens);
+      ASSERT_EQ(got_batch[i], expected);
+      ASSERT_EQ(got_strings[i], expected);
+    }
+  }
+  ASSERT_EQ(tokenizer.DecodeBatch({}).size(), 0);
+}
+
+TEST(TokenizerTest, DecodeTablesBuiltOnFirstDecode) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  Encoding encoding = tokenizer.Encode(u8"Hello world!");
+  size_t memory_usage = tokenizer.MemoryUsage();
+  MemoryUsageMap got_usage = tokenizer.MemoryUsageByStructure();
+  ASSERT_GT(got_usage.at("model.vocab"), 30522 * 32);
+  ASSERT_GT(got_usage.at("added_vocabulary.tokens"), 0);
+  ASSERT_EQ(got_usage.at("model.reverse_vocab"), 0);
+  ASSERT_EQ(got_usage.at("added_vocabulary.special_tokens"), 0);
+
+  ASSERT_EQ(tokenizer.Decode(std::vector<int>(encoding.ids.begin(),
+                                              encoding.ids.end())),
+            u8"hello world!");
+  got_usage = tokenizer.MemoryUsageByStructure();
+  ASSERT_GT(got_usage.at("model.reverse_vocab"), 30522 * 32);
+  ASSERT_GT(got_usage.at("added_vocabulary.special_tokens"), 0);
+  ASSERT_GT(tokenizer.MemoryUsage(), memory_usage + 30522 * 32);
+}
+
+TEST(TokenizerTest, EncodeTruncatedFromConfig) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string long_input;
+  for (int i = 0; long_input.size() < 5 * Tokenizer::kBatchChunkLength; i++) {
+    long_input += u8"Sentence " + std::to_string(i) +
+                  u8" is about S\u00E3o Paulo and \u5317\u4EAC.\n";
+  }
+  // kAll, with kOverflowing, encodes the whole input before truncating.
+  EncodeOptions without_word_ids =
+      EncodeOptions::kTypeIds | EncodeOptions::kTokens |
+      EncodeOptions::kOffsets | EncodeOptions::kSpecialTokensMask |
+      EncodeOptions::kAttentionMask;
+  for (TruncationDirection direction :
+       {TruncationDirection::kRight, TruncationDirection::kLeft}) {
+    tokenizer.truncation = std::make_shared<Truncation>(
+        direction, TruncationStrategy::kLongestFirst, 16, 0);
+    for (EncodeOptions options :
+         {EncodeOptions::kAllFields, without_word_ids}) {
+      Encoding got_encoding = tokenizer.Encode(long_input, true, options);
+      Encoding full_encoding = tokenizer.Encode(
+          long_input, true, options | EncodeOptions::kOverflowing);
+      ASSERT_EQ(got_encoding.ids.size(), 16);
+      ASSERT_EQ(got_encoding.ids.front(), 101);
+      ASSERT_EQ(got_encoding.ids.back(), 102);
+      ASSERT_TRUE(got_encoding.overflowing.empty());
+      ASSERT_FALSE(full_encoding.overflowing.empty());
+      ASSERT_EQ(full_encoding.overflowing[0].ids.front(), 101);
+      ASSERT_EQ(got_encoding.ids, full_encoding.ids);
+      ASSERT_EQ(got_encoding.tokens, full_encoding.tokens);
+      ASSERT_EQ(got_encoding.offsets, full_encoding.offsets);
+      ASSERT_EQ(got_encoding.word_ids, full_encoding.word_ids);
+    }
+  }
+
+  tokenizer.truncation = std::make_shared<Truncation>(
+      TruncationDirection::kRight, TruncationStrategy::kOnlySecond, 32, 0);
+  std::pair<std::string, std::string> pair_input = {
+      u8"Where is S\u00E3o Paulo?", long_input};
+  Encoding got_encoding =
+      tokenizer.Encode(pair_input, true, EncodeOptions::kAllFields);
+  ASSERT_EQ(got_encoding.ids.size(), 32);
+  assertTokenizerValues(got_encoding, tokenizer.Encode(pair_input));
+  EXPECT_THROW(tokenizer.Encode(long_input), std::invalid_argument);
+
+  tokenizer.truncation = std::make_shared<Truncation>(
+      TruncationDirection::kRight, TruncationStrategy::kLongestFirst, 32, 0);
+  std::vector<Encoding> got_encodings = tokenizer.EncodeBatch(
+      {u8"Hello world!", long_input}, true, EncodeOptions::kAllFields);
+  assertTokenizerValues(got_encodings[1], tokenizer.Encode(long_input));
+  ASSERT_EQ(got_encodings[1].ids.size(), 32);
+}
+
+TEST(TokenizerTest, EncodeOffsetTypesFromConfig) {
+  std::string config =
+      read_json_for_test("../../scripts/tokenizers/bert-base-uncased.json");
+  Tokenizer tokenizer = Tokenizer(config);
+  std::string input = u8"S\u00E3o Paulo \u5317\u4EAC \U0001F600 there";
+  std::pmr::vector<std::pmr::string> expected_tokens = {
+      "[CLS]", "sao",   "paulo", u8"\u5317", u8"\u4EAC",
+      "[UNK]", "there", "[SEP]"};
+  std::vector<std::pair<OffsetType, std::vector<std::pair<int, int>>>>
+      expected_offsets = {
+          {OffsetType::kUtf16,
+           {{0, 0}, {0, 3}, {4, 9}, {10, 11}, {11, 12}, {13, 15}, {16, 21},
+            {0, 0}}},
+          {OffsetType::kUtf8,
+           {{0, 0}, {0, 4}, {5, 10}, {11, 14}, {14, 17}, {18, 22}, {23, 28},
+            {0, 0}}},
+          {OffsetType::kCodePoints,
+           {{0, 0}, {0, 3}, {4, 9}, {10, 11}, {11, 12}, {13, 14}, {15, 20},
+            {0, 0}}},
+      };
+  for (const auto& [offset_type, offsets] : expected_offsets) {
+    tokenizer.offset_type = offset_type;
+    Encoding got_encoding = tokenizer.Encode(input);
+    std::vector<std::pair<int, int>> got_offsets(got_encoding.offsets.begin(),
+                                                 got_encoding.offsets.end());
+    ASSERT_EQ(got_encoding.tokens, expected_tokens);
+    ASSERT_EQ(got_offsets, offsets);
+  }
+
+  // Chunks of long documents continue from the offsets of the ones before.
+  std::string long_input;
+  for (int i = 0; long_input.size() < 3 * Tokenizer::kBatchChunkLength; i++) {
+    long_input += input + u8" " + std::to_string(i) + u8".\n";
+  }
+  tokenizer.offset_type = OffsetType::kUtf8;
+  Encoding got_encoding = tokenizer.Encode(long_input);
+  ASSERT_EQ(tokenizer.EncodeBatch({long_input})[0].offsets,
+            got_encoding.offsets);
+  std::pair<int, int> last_offsets = got_encoding.offsets.rbegin()[1];
+  ASSERT_EQ(last_offsets.second, long_input.size() - 1);
+  ASSERT_EQ(long_input.substr(last_offsets.first,
+                              last_offsets.second - last_offsets.first),
+            ".");
+}
@@ -0,0 +1,59 @@
+// Copyright 2025 Omkar Prabhu
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "tokenizers/executor.h"
+#include "tokenizers/trainer.h"
+
+using tokenizers::WorkStealingExecutor;
+using tokenizers::trainers::WordPieceTrainer;
+
+static std::vector<std::string> trainerCorpus() {
+  std::vector<std::string> corpus;
+  for (int i = 0; i < 20000; i++) {
+    corpus.push_back(u8"Hello world! I'm learning BERT-based NLP with "
+                     u8"unaffordable costs in São Paulo, item " +
+                     std::to_string(i * 7919 % 5000) + u8".");
+  }
+  return corpus;
+}
+
+static void BM_WordPieceTrainerFeed(benchmark::State& state) { // NOLINT
+  WorkStealingExecutor executor(state.range(0));
+  std::vector<std::string> corpus = trainerCorpus();
+  int64_t bytes = 0;
+  for (const std::string& line : corpus) {
+    bytes += line.size();
+  }
+  for (auto _ : state) {
+    WordPieceTrainer trainer;
+    trainer.Feed(corpus, &executor);
+    benchmark::DoNotOptimize(trainer.NumWords());
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+static void BM_WordPieceTrainerTrain(benchmark::State& state) { // NOLINT
+  WorkStealingExecutor executor(state.range(0));
+  WordPieceTrainer trainer(2000);
+  trainer.Feed(trainerCorpus(), &executor);
+  for (auto _ : state) {
+    std::vector<std::string> vocab = trainer.Train(&executor);
+    benchmark::DoNotOptimize(vocab);
+  }
+}
+
+BENCHMARK(BM_WordPieceTrainerFeed)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+BENCHMARK(BM_WordPieceTrainerTrain)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->UseRealTime();
@@ -0,0 +1,102 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/trainer.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tokenizers/common.h"
+#include "tokenizers/executor.h"
+#include "tokenizers/tokenizer.h"
+
+using tokenizers::Encoding;
+using tokenizers::Token;
+using tokenizers::Tokenizer;
+using tokenizers::WorkStealingExecutor;
+using tokenizers::trainers::WordPieceTrainer;
+
+TEST(WordPieceTrainerTest, Error) {
+  ASSERT_THROW(WordPieceTrainer(100, 0, {u8"[PAD]"}), std::invalid_argument);
+  WordPieceTrainer trainer;
+  ASSERT_THROW(trainer.FeedFile(u8"missing.txt"), std::invalid_argument);
+}
+
+TEST(WordPieceTrainerTest, Train) {
+  WordPieceTrainer trainer(12, 0, {u8"[UNK]"});
+  trainer.Feed({u8"Hug hug", u8"pug HUG pun"});
+  ASSERT_EQ(trainer.NumWords(), 3);
+  // (##u, ##g) occurs 4 times, then (h, ##ug) 3 times, and of the pairs
+  // that occur once (p, ##u) has the lowest ids.
+  std::vector<std::string> expected_vocab = {
+      u8"[UNK]", u8"g",   u8"h",    u8"n",   u8"p",  u8"u",
+      u8"##u",   u8"##g", u8"##n", u8"##ug", u8"hug", u8"pu"};
+  ASSERT_EQ(trainer.Train(), expected_vocab);
+
+  std::vector<Token> got_tokens =
+      trainer.MakeModel(expected_vocab)->TokenizeString(u8"pun");
+  ASSERT_EQ(got_tokens.size(), 2);
+  ASSERT_EQ(got_tokens[0].value, u8"pu");
+  ASSERT_EQ(got_tokens[0].id, 11);
+  ASSERT_EQ(got_tokens[1].value, u8"##n");
+  ASSERT_EQ(got_tokens[1].id, 8);
+}
+
+TEST(WordPieceTrainerTest, TrainMinFrequencyAndLimitAlphabet) {
+  WordPieceTrainer trainer(100, 4, {u8"[UNK]"}, 3);
+  trainer.Feed({u8"hug hug hug pug pun"});
+  // p and n are the least frequent characters and are dropped from the
+  // words, and (h, ##ug) occurs only 3 times.
+  std::vector<std::string> expected_vocab = {u8"[UNK]", u8"g",   u8"h",
+                                             u8"u",     u8"##u", u8"##g",
+                                             u8"##ug"};
+  ASSERT_EQ(trainer.Train(), expected_vocab);
+}
+
+TEST(WordPieceTrainerTest, TrainParallelMatchesSerial) {
+  std::vector<std::string> corpus;
+  for (int i = 0; i < 2000; i++) {
+    corpus.push_back(u8"Hello world! I'm learning BERT-based NLP with " +
+                     std::to_string(i * 7919 % 1000) +
+                     u8" unaffordable costs in São Paulo, "
+                     u8"北京大学.");
+  }
+  WorkStealingExecutor serial_executor(1);
+  WordPieceTrainer serial_trainer(200);
+  serial_trainer.Feed(corpus, &serial_executor);
+  std::vector<std::string> serial_vocab =
+      serial_trainer.Train(&serial_executor);
+  ASSERT_EQ(serial_vocab.size(), 200);
+
+  WorkStealingExecutor executor(4);
+  WordPieceTrainer trainer(200);
+  std::vector<std::string> first_half(corpus.begin(),
+                                      corpus.begin() + corpus.size() / 2);
+  std::vector<std::string> second_half(corpus.begin() + corpus.size() / 2,
+                                       corpus.end());
+  trainer.Feed(second_half, &executor);
+  trainer.Feed(first_half, &executor);
+  ASSERT_EQ(trainer.Train(&executor), serial_vocab);
+}
+
+TEST(WordPieceTrainerTest, ToJson) {
+  WordPieceTrainer trainer(40);
+  trainer.Feed({u8"hug hug hug pug pun \"bun\"", u8"hugs and puns"});
+  std::vector<std::string> vocab = trainer.Train();
+  Tokenizer tokenizer(trainer.ToJson(vocab));
+  Encoding got_encoding = tokenizer.Encode(
+      std::make_pair(std::string(u8"Hugs \"PUN\""), std::string(u8"bun")));
+  std::vector<std::string> got_tokens(got_encoding.tokens.begin(),
+                                      got_encoding.tokens.end());
+  std::vector<std::string> expected_tokens = {
+      u8"[CLS]", u8"hugs", u8"\"", u8"pun", u8"\"", u8"[SEP]",
+      u8"bun",   u8"[SEP]"};
+  ASSERT_EQ(got_tokens, expected_tokens);
+  ASSERT_EQ(got_encoding.ids[0], 2);
+  ASSERT_EQ(got_encoding.type_ids.back(), 1);
+  ASSERT_EQ(tokenizer.Decode(std::vector<int>(got_encoding.ids.begin(),
+                                              got_encoding.ids.end())),
+            u8"hugs \" pun \" bun");
+}
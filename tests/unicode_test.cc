@@ -0,0 +1,107 @@
+// Copyright 2025 Omkar Prabhu
+#include "tokenizers/unicode.h"
+
+#include <gtest/gtest.h>
+#include <unicode/normalizer2.h>
+#include <unicode/uchar.h>
+#include <unicode/unistr.h>
+#include <unicode/uversion.h>
+
+#include <cstring>
+
+#include "tokenizers/normalizer.h"
+
+using tokenizers::normalizers::NormalizerResult;
+
+namespace unicode = tokenizers::unicode;
+
+TEST(UnicodeTest, IsChineseChar) {
+  for (UChar32 c = 0; c <= UCHAR_MAX_VALUE; c++) {
+    UBlockCode block = ublock_getCode(c);
+    bool chinese = block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS ||
+                   block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_A ||
+                   block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_B ||
+                   block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_C ||
+                   block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_D ||
+                   block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_E ||
+                   block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_F ||
+                   block == UBLOCK_CJK_UNIFIED_IDEOGRAPHS_EXTENSION_G;
+    ASSERT_EQ(unicode::IsChineseChar(c), chinese) << c;
+  }
+}
+
+#ifdef TOKENIZERS_UNICODE_TABLES
+
+// Code points assigned after the Unicode version of the tables are left out,
+// ICU may be built with a newer one.
+static bool inTablesVersion(UChar32 c) {
+  UVersionInfo tables_version;
+  u_versionFromString(tables_version, unicode::tables::kUnicodeVersion);
+  UVersionInfo age;
+  u_charAge(c, age);
+  return std::memcmp(age, tables_version, sizeof(UVersionInfo)) <= 0;
+}
+
+TEST(UnicodeTest, TablesMatchIcuProperties) {
+  for (UChar32 c = 0; c <= UCHAR_MAX_VALUE; c++) {
+    if (!inTablesVersion(c))
+      continue;
+    ASSERT_EQ(unicode::CharType(c), u_charType(c)) << c;
+    ASSERT_EQ(unicode::IsUWhiteSpace(c), u_isUWhiteSpace(c)) << c;
+    ASSERT_EQ(unicode::IsWhitespace(c), u_isWhitespace(c)) << c;
+    ASSERT_EQ(unicode::IsPunct(c), u_ispunct(c)) << c;
+    ASSERT_EQ(unicode::IsAlnum(c), u_isalnum(c)) << c;
+    ASSERT_EQ(unicode::ToLower(c), u_tolower(c)) << c;
+    ASSERT_EQ(unicode::tables::CombiningClass(c), u_getCombiningClass(c))
+        << c;
+  }
+}
+
+TEST(UnicodeTest, TablesMatchIcuDecomposition) {
+  UErrorCode error_code = U_ZERO_ERROR;
+  const icu::Normalizer2* nfd = icu::Normalizer2::getNFDInstance(error_code);
+  ASSERT_TRUE(U_SUCCESS(error_code));
+  UChar32 decomposed[unicode::tables::kMaxDecomposition];
+  for (UChar32 c = 0; c <= UCHAR_MAX_VALUE; c++) {
+    if (U_IS_SURROGATE(c) || !inTablesVersion(c))
+      continue;
+    icu::UnicodeString expected = nfd->normalize(icu::UnicodeString(c),
+                                                 error_code);
+    int length = unicode::tables::Decompose(c, decomposed);
+    icu::UnicodeString got;
+    if (length == 0)
+      got.append(c);
+    for (int i = 0; i < length; i++) {
+      got.append(decomposed[i]);
+    }
+    ASSERT_EQ(got, expected) << c;
+  }
+}
+
+// Stripping accents decomposes and reorders across neighbouring code points,
+// so it runs over all of them at once, marks and Hangul included.
+TEST(UnicodeTest, TablesMatchIcuStripAccents) {
+  UErrorCode error_code = U_ZERO_ERROR;
+  const icu::Normalizer2* nfd = icu::Normalizer2::getNFDInstance(error_code);
+  icu::UnicodeString input;
+  for (UChar32 c = 0x20; c <= UCHAR_MAX_VALUE; c++) {
+    if (!U_IS_SURROGATE(c) && inTablesVersion(c))
+      input.append(c);
+  }
+  icu::UnicodeString decomposed = nfd->normalize(input, error_code);
+  ASSERT_TRUE(U_SUCCESS(error_code));
+  icu::UnicodeString expected;
+  for (int i = 0; i < decomposed.length();) {
+    UChar32 c = decomposed.char32At(i);
+    if (u_charType(c) != U_NON_SPACING_MARK)
+      expected.append(c);
+    i += U16_LENGTH(c);
+  }
+
+  NormalizerResult got(input);
+  tokenizers::normalizers::doStripAccents(&got);
+  ASSERT_EQ(got.normalized, expected);
+  ASSERT_EQ(got.offsets.size(), got.normalized.countChar32());
+}
+
+#endif
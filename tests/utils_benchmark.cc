@@ -187,6 +187,18 @@ static void BM_PaddingStrategyFixed(benchmark::State& state) { // NOLINT
   }
 }
 
+static void BM_BucketByLength(benchmark::State& state) { // NOLINT
+  std::vector<int> lengths(1024);
+  for (int i = 0; i < lengths.size(); i++) {
+    lengths[i] = 5 + (i * 7919) % 512;
+  }
+  for (auto _ : state) {
+    std::vector<std::vector<int>> output =
+        tokenizers::BucketByLength(lengths, 32, 0.1);
+    benchmark::DoNotOptimize(output);
+  }
+}
+
 BENCHMARK(BM_TruncateEncodingGreaterMaxLength)->ThreadPerCpu();
 BENCHMARK(BM_TruncateEncodingMaxLengthZero)->ThreadPerCpu();
 BENCHMARK(BM_TruncateEncodingTruncateLeft)->ThreadPerCpu();
@@ -200,3 +212,4 @@ BENCHMARK(BM_PadEncodingPadLeft)->ThreadPerCpu();
 BENCHMARK(BM_PadEncodingPadRight)->ThreadPerCpu();
 BENCHMARK(BM_PaddingStrategyBatchLongest)->ThreadPerCpu();
 BENCHMARK(BM_PaddingStrategyFixed)->ThreadPerCpu();
+BENCHMARK(BM_BucketByLength)->ThreadPerCpu();
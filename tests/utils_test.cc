@@ -279,6 +279,19 @@ TEST(PaddingTest, StrategyFixed) {
   assertUtilsValues(got, expected);
 }
 
+TEST(BucketByLengthTest, BoundsPadding) {
+  std::vector<int> lengths = {10, 100, 11, 12, 98, 10, 400, 9};
+  std::vector<std::vector<int>> expected = {{7, 0, 5, 2, 3}, {4, 1}, {6}};
+  ASSERT_EQ(tokenizers::BucketByLength(lengths, 8, 0.2), expected);
+}
+
+TEST(BucketByLengthTest, MaxBatchSize) {
+  std::vector<int> lengths = {5, 5, 5, 5, 5};
+  std::vector<std::vector<int>> expected = {{0, 1}, {2, 3}, {4}};
+  ASSERT_EQ(tokenizers::BucketByLength(lengths, 2, 0.0), expected);
+  ASSERT_TRUE(tokenizers::BucketByLength({}, 2, 0.0).empty());
+}
+
 TEST(FindMatchesTest, SplitsFound) {
   icu::UnicodeString input =
       icu::UnicodeString::fromUTF8("Hello, world! [MASK] never said Hello");